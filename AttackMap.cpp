@@ -0,0 +1,126 @@
+#include "AttackMap.h"
+#include "MoveGen.h"
+
+void AttackMap::clear()
+{
+    for (uint8_t sq = 0; sq < 64; sq++)
+    {
+        counts[WHITE][sq] = 0;
+        counts[BLACK][sq] = 0;
+    }
+    for (uint8_t rank = 0; rank < 8; rank++)
+    {
+        bits[WHITE][rank] = 0;
+        bits[BLACK][rank] = 0;
+    }
+}
+
+void AttackMap::rebuild(const BoardBackend &board)
+{
+    clear();
+    for (uint8_t color = WHITE; color <= BLACK; color++)
+    {
+        BoardBackend::PieceIterator it = board.pieces((PieceColor)color);
+        Square sq;
+        while (it.next(sq))
+        {
+            pieceAttacks(board, sq, board.pieceAt(sq), 1);
+        }
+    }
+}
+
+void AttackMap::pieceAdded(const BoardBackend &board, Square sq)
+{
+    // The new piece cuts the rays passing through its square, then adds its own
+    raysThrough(board, sq, -1);
+    pieceAttacks(board, sq, board.pieceAt(sq), 1);
+}
+
+void AttackMap::pieceRemoved(const BoardBackend &board, Square sq, PieceCode piece)
+{
+    pieceAttacks(board, sq, piece, -1);
+    raysThrough(board, sq, 1);
+}
+
+void AttackMap::change(PieceColor by, Square sq, int8_t delta)
+{
+    counts[by][sq] += delta;
+    if (counts[by][sq])
+        bits[by][sq >> 3] |= 1 << (sq & 7);
+    else
+        bits[by][sq >> 3] &= ~(1 << (sq & 7));
+}
+
+// Adds (delta = 1) or withdraws (delta = -1) the attacks of piece standing on sq
+void AttackMap::pieceAttacks(const BoardBackend &board, Square sq, PieceCode piece, int8_t delta)
+{
+    PieceColor color = pieceColor(piece);
+    PieceType type = pieceType(piece);
+    uint8_t x = toX88(sq);
+
+    if (type == PAWN)
+    {
+        uint8_t ahead = x + 16 * pawnDirection(color);
+        if (!((ahead - 1) & 0x88))
+            change(color, fromX88(ahead - 1), delta);
+        if (!((ahead + 1) & 0x88))
+            change(color, fromX88(ahead + 1), delta);
+        return;
+    }
+
+    if (type == KNIGHT || type == KING)
+    {
+        const int8_t *offsets = type == KNIGHT ? knightOffsets88 : kingOffsets88;
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            uint8_t t = x + (int8_t)pgm_read_byte(&offsets[i]);
+            if (!(t & 0x88))
+                change(color, fromX88(t), delta);
+        }
+        return;
+    }
+
+    uint8_t first = type == BISHOP ? 4 : 0;
+    uint8_t last = type == ROOK ? 4 : 8;
+    for (uint8_t i = first; i < last; i++)
+    {
+        int8_t step = (int8_t)pgm_read_byte(&kingOffsets88[i]);
+        for (uint8_t t = x + step; !(t & 0x88); t += step)
+        {
+            change(color, fromX88(t), delta);
+            if (board.pieceAt(fromX88(t)) != NO_PIECE)
+                break;
+        }
+    }
+}
+
+// Extends (delta = 1) or cuts (delta = -1) every slider ray that reaches sq
+// and would continue past it
+void AttackMap::raysThrough(const BoardBackend &board, Square sq, int8_t delta)
+{
+    uint8_t x = toX88(sq);
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        int8_t step = (int8_t)pgm_read_byte(&kingOffsets88[i]);
+        uint8_t t = x + step;
+        while (!(t & 0x88) && board.pieceAt(fromX88(t)) == NO_PIECE)
+        {
+            t += step;
+        }
+        if (t & 0x88)
+            continue;
+
+        // Offsets 0-3 are straight lines, 4-7 diagonals
+        PieceCode slider = board.pieceAt(fromX88(t));
+        PieceType type = pieceType(slider);
+        if (type != QUEEN && type != (i < 4 ? ROOK : BISHOP))
+            continue;
+
+        for (t = x - step; !(t & 0x88); t -= step)
+        {
+            change(pieceColor(slider), fromX88(t), delta);
+            if (board.pieceAt(fromX88(t)) != NO_PIECE)
+                break;
+        }
+    }
+}
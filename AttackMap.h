@@ -0,0 +1,79 @@
+#ifndef ATTACKMAP_H
+#define ATTACKMAP_H
+
+#include <Arduino.h>
+#include "BoardBackend.h"
+
+// Per-colour attacker counts for every square, updated incrementally as
+// pieces are placed and removed. Only the moved piece's own attacks and the
+// slider rays running through the changed square are touched, so
+// "is this square attacked" becomes a single array read.
+//
+// Costs 144 bytes of SRAM. Define SMARTCHESS_NO_ATTACK_MAPS to drop it;
+// ChessBoard then falls back to BoardBackend::isAttacked().
+#ifndef SMARTCHESS_NO_ATTACK_MAPS
+#define SMARTCHESS_ATTACK_MAPS 1
+#else
+#define SMARTCHESS_ATTACK_MAPS 0
+#endif
+
+class AttackMap
+{
+public:
+  void clear();
+  void rebuild(const BoardBackend &board);
+
+  // Call right after board.put(sq, ...) / board.remove(sq)
+  void pieceAdded(const BoardBackend &board, Square sq);
+  void pieceRemoved(const BoardBackend &board, Square sq, PieceCode piece);
+
+  bool isAttacked(Square sq, PieceColor by) const { return sq < NO_SQUARE && counts[by][sq] != 0; }
+  uint8_t attackers(Square sq, PieceColor by) const { return counts[by][sq]; }
+  // Attacked squares of one rank, bit n = file n (for the threat overlay)
+  uint8_t attackedRank(PieceColor by, uint8_t rank) const { return bits[by][rank]; }
+
+private:
+  uint8_t counts[2][64];
+  uint8_t bits[2][8];
+
+  void change(PieceColor by, Square sq, int8_t delta);
+  void pieceAttacks(const BoardBackend &board, Square sq, PieceCode piece, int8_t delta);
+  void raysThrough(const BoardBackend &board, Square sq, int8_t delta);
+};
+
+// Board edits that keep an AttackMap in step with the backend. Has the
+// pieceAt/put/remove/move subset of the backend interface, so applyMove()
+// can run on it.
+class TrackedBoard
+{
+public:
+  TrackedBoard(BoardBackend &board, AttackMap &attacks) : board(board), attacks(attacks) {}
+
+  PieceCode pieceAt(Square sq) const { return board.pieceAt(sq); }
+  bool put(Square sq, PieceCode piece)
+  {
+    if (!board.put(sq, piece))
+      return false;
+    attacks.pieceAdded(board, sq);
+    return true;
+  }
+  void remove(Square sq)
+  {
+    PieceCode piece = board.pieceAt(sq);
+    board.remove(sq);
+    attacks.pieceRemoved(board, sq, piece);
+  }
+  // Lift and drop: the rays through both squares must see the in-between state
+  void move(Square from, Square to)
+  {
+    PieceCode piece = board.pieceAt(from);
+    remove(from);
+    put(to, piece);
+  }
+
+private:
+  BoardBackend &board;
+  AttackMap &attacks;
+};
+
+#endif
@@ -0,0 +1,153 @@
+#include "BoardBackend.h"
+
+#if !defined(__AVR__)
+
+// Directions: N, NE, E, SE, S, SW, W, NW. The first half of each pair of
+// opposite rays grows towards higher square indices.
+static const int rayRowStep[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+static const int rayColStep[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+static const bool rayAscending[8] = {true, true, true, false, false, false, false, true};
+
+static uint64_t rays[8][64];
+static uint64_t knightAttacks[64];
+static uint64_t kingAttacks[64];
+static uint64_t pawnAttacks[2][64]; // squares a pawn of that colour attacks
+
+static uint64_t squareBit(int row, int col)
+{
+    return (row >= 0 && row < 8 && col >= 0 && col < 8) ? 1ULL << (row * 8 + col) : 0;
+}
+
+static struct BitboardTables
+{
+    BitboardTables()
+    {
+        static const int knightSteps[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+        for (int sq = 0; sq < 64; sq++)
+        {
+            int row = sq >> 3, col = sq & 7;
+            knightAttacks[sq] = 0;
+            kingAttacks[sq] = 0;
+            for (int i = 0; i < 8; i++)
+            {
+                knightAttacks[sq] |= squareBit(row + knightSteps[i][0], col + knightSteps[i][1]);
+                kingAttacks[sq] |= squareBit(row + rayRowStep[i], col + rayColStep[i]);
+
+                rays[i][sq] = 0;
+                for (int r = row + rayRowStep[i], c = col + rayColStep[i]; squareBit(r, c); r += rayRowStep[i], c += rayColStep[i])
+                {
+                    rays[i][sq] |= squareBit(r, c);
+                }
+            }
+            pawnAttacks[WHITE][sq] = squareBit(row + 1, col - 1) | squareBit(row + 1, col + 1);
+            pawnAttacks[BLACK][sq] = squareBit(row - 1, col - 1) | squareBit(row - 1, col + 1);
+        }
+    }
+} bitboardTables;
+
+static uint64_t rayAttacks(int dir, Square sq, uint64_t occupied)
+{
+    uint64_t attacks = rays[dir][sq];
+    uint64_t blockers = attacks & occupied;
+    if (blockers)
+    {
+        Square first = rayAscending[dir] ? __builtin_ctzll(blockers) : 63 - __builtin_clzll(blockers);
+        attacks ^= rays[dir][first];
+    }
+    return attacks;
+}
+
+static uint64_t bishopAttacks(Square sq, uint64_t occupied)
+{
+    return rayAttacks(1, sq, occupied) | rayAttacks(3, sq, occupied) |
+           rayAttacks(5, sq, occupied) | rayAttacks(7, sq, occupied);
+}
+
+static uint64_t rookAttacks(Square sq, uint64_t occupied)
+{
+    return rayAttacks(0, sq, occupied) | rayAttacks(2, sq, occupied) |
+           rayAttacks(4, sq, occupied) | rayAttacks(6, sq, occupied);
+}
+
+void BitboardBackend::clear()
+{
+    byColor[WHITE] = byColor[BLACK] = 0;
+    for (int t = 0; t < 6; t++)
+    {
+        byType[t] = 0;
+    }
+    material = 0;
+    hash = 0;
+}
+
+PieceCode BitboardBackend::pieceAt(Square sq) const
+{
+    uint64_t bit = 1ULL << sq;
+    PieceColor color = (byColor[BLACK] & bit) ? BLACK : WHITE;
+    if (!(byColor[color] & bit))
+        return NO_PIECE;
+    for (int t = 0; t < 6; t++)
+    {
+        if (byType[t] & bit)
+            return makePiece((PieceType)t, color);
+    }
+    return NO_PIECE;
+}
+
+bool BitboardBackend::put(Square sq, PieceCode piece)
+{
+    // Same limit as the mailbox, so both backends accept the same edits
+    if (pieceCount(pieceColor(piece)) >= MAX_PIECES_PER_SIDE || !materialHasRoom(material, piece))
+        return false;
+    uint64_t bit = 1ULL << sq;
+    byColor[pieceColor(piece)] |= bit;
+    byType[pieceType(piece)] |= bit;
+    material += materialDelta(piece, sq);
+    hash ^= hashPiece(piece, sq);
+    return true;
+}
+
+void BitboardBackend::remove(Square sq)
+{
+    PieceCode piece = pieceAt(sq);
+    uint64_t bit = 1ULL << sq;
+    byColor[pieceColor(piece)] &= ~bit;
+    byType[pieceType(piece)] &= ~bit;
+    material -= materialDelta(piece, sq);
+    hash ^= hashPiece(piece, sq);
+}
+
+void BitboardBackend::move(Square from, Square to)
+{
+    PieceCode piece = pieceAt(from);
+    uint64_t bits = (1ULL << from) | (1ULL << to);
+    byColor[pieceColor(piece)] ^= bits;
+    byType[pieceType(piece)] ^= bits;
+    hash ^= hashPiece(piece, from) ^ hashPiece(piece, to);
+}
+
+Square BitboardBackend::kingSquare(PieceColor color) const
+{
+    uint64_t king = byType[KING] & byColor[color];
+    return king ? (Square)__builtin_ctzll(king) : NO_SQUARE;
+}
+
+bool BitboardBackend::isAttacked(Square sq, PieceColor by) const
+{
+    if (sq >= NO_SQUARE)
+        return false;
+
+    uint64_t them = byColor[by];
+    if ((pawnAttacks[opponent(by)][sq] & byType[PAWN] & them) ||
+        (knightAttacks[sq] & byType[KNIGHT] & them) ||
+        (kingAttacks[sq] & byType[KING] & them))
+        return true;
+
+    uint64_t occupied = byColor[WHITE] | byColor[BLACK];
+    uint64_t diagonal = (byType[BISHOP] | byType[QUEEN]) & them;
+    uint64_t straight = (byType[ROOK] | byType[QUEEN]) & them;
+    return (diagonal && (bishopAttacks(sq, occupied) & diagonal)) ||
+           (straight && (rookAttacks(sq, occupied) & straight));
+}
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef BOARDBACKEND_H
+#define BOARDBACKEND_H
+
+#include <Arduino.h>
+#include "ChessTypes.h"
+#include "Material.h"
+#include "Hash.h"
+
+// Square storage behind ChessBoard and the move generator. Two
+// implementations share one interface and are picked at compile time:
+//
+//   MailboxBackend  - one byte per square (piece code + slot in its colour's
+//                     piece list) plus the lists themselves. Used on AVR,
+//                     where 64-bit arithmetic is slow and SRAM is tight.
+//   BitboardBackend - one 64-bit set per colour and piece type. Used on the
+//                     host, where attack tests become a few mask operations.
+//
+// Interface (both backends):
+//   void clear();
+//   PieceCode pieceAt(Square sq) const;
+//   bool put(Square sq, PieceCode piece);    // sq must be empty; false (and
+//                                            // no change) if the colour has
+//                                            // MAX_PIECES_PER_SIDE already, or
+//                                            // MATERIAL_MAX_COUNT of the type
+//   void remove(Square sq);                  // sq must be occupied
+//   void move(Square from, Square to);       // to must be empty
+//   PieceIterator pieces(PieceColor color) const;  // live pieces only
+//   Square kingSquare(PieceColor color) const;     // O(1), NO_SQUARE if none
+//   uint8_t pieceCount(PieceColor color) const;
+//   bool isAttacked(Square sq, PieceColor by) const;
+//   MaterialKey materialKey() const;              // updated by put/remove
+//   HashKey pieceHash() const;                    // updated by put/remove/move
+//
+// Define SMARTCHESS_MAILBOX_BACKEND to use the AVR backend on the host.
+
+#ifndef BOARD_BACKEND_SRAM_BUDGET
+#define BOARD_BACKEND_SRAM_BUDGET 112 // bytes
+#endif
+
+#define MAX_PIECES_PER_SIDE 16
+
+class MailboxBackend
+{
+public:
+  class PieceIterator
+  {
+  public:
+    PieceIterator(const Square *first, const Square *last) : cur(first), end(last) {}
+    bool next(Square &sq)
+    {
+      if (cur == end)
+        return false;
+      sq = *cur++;
+      return true;
+    }
+
+  private:
+    const Square *cur;
+    const Square *end;
+  };
+
+  void clear();
+  PieceCode pieceAt(Square sq) const { return cells[sq] & 0x0F; }
+  bool put(Square sq, PieceCode piece);
+  void remove(Square sq);
+  void move(Square from, Square to);
+  PieceIterator pieces(PieceColor color) const { return PieceIterator(list[color], list[color] + count[color]); }
+  Square kingSquare(PieceColor color) const;
+  uint8_t pieceCount(PieceColor color) const { return count[color]; }
+  bool isAttacked(Square sq, PieceColor by) const;
+  MaterialKey materialKey() const { return material; }
+  HashKey pieceHash() const { return hash; }
+
+private:
+  uint8_t cells[64];                   // piece code in the low nibble, list slot in the high nibble
+  Square list[2][MAX_PIECES_PER_SIDE]; // squares of each side's pieces, king (if any) in slot 0
+  uint8_t count[2];
+  MaterialKey material;
+  HashKey hash;
+
+  uint8_t slotOf(Square sq) const { return cells[sq] >> 4; }
+  void setSlot(PieceColor color, uint8_t slot, Square sq);
+  template <PieceColor By>
+  bool attackedBy(Square sq) const;
+};
+
+#if !defined(__AVR__)
+class BitboardBackend
+{
+public:
+  class PieceIterator
+  {
+  public:
+    explicit PieceIterator(uint64_t set) : bits(set) {}
+    bool next(Square &sq)
+    {
+      if (!bits)
+        return false;
+      sq = (Square)__builtin_ctzll(bits);
+      bits &= bits - 1;
+      return true;
+    }
+
+  private:
+    uint64_t bits;
+  };
+
+  void clear();
+  PieceCode pieceAt(Square sq) const;
+  bool put(Square sq, PieceCode piece);
+  void remove(Square sq);
+  void move(Square from, Square to);
+  PieceIterator pieces(PieceColor color) const { return PieceIterator(byColor[color]); }
+  Square kingSquare(PieceColor color) const;
+  uint8_t pieceCount(PieceColor color) const { return (uint8_t)__builtin_popcountll(byColor[color]); }
+  bool isAttacked(Square sq, PieceColor by) const;
+  MaterialKey materialKey() const { return material; }
+  HashKey pieceHash() const { return hash; }
+
+  uint64_t occupied() const { return byColor[WHITE] | byColor[BLACK]; }
+  uint64_t colorSet(PieceColor color) const { return byColor[color]; }
+  uint64_t typeSet(PieceType type) const { return byType[type]; }
+
+private:
+  uint64_t byColor[2];
+  uint64_t byType[6];
+  MaterialKey material;
+  HashKey hash;
+};
+#endif
+
+#if defined(__AVR__) || defined(SMARTCHESS_MAILBOX_BACKEND)
+typedef MailboxBackend BoardBackend;
+#else
+typedef BitboardBackend BoardBackend;
+#endif
+
+#if defined(__AVR__)
+static_assert(sizeof(BoardBackend) <= BOARD_BACKEND_SRAM_BUDGET, "board backend exceeds its SRAM budget");
+#endif
+
+#endif
@@ -5,63 +5,227 @@
 #include "Bishop.h"
 #include "Knight.h"
 #include "Pawn.h"
+#include "MoveGen.h"
+#include "AttackMap.h"
+#include "Perf.h"
 #include <Arduino.h>
 
-ChessBoard::ChessBoard()
+// Squares only hold PieceCodes. getPiece() hands out one shared object per
+// piece kind for the type/colour/canMove API, so no piece lives on the heap.
+static Pawn whitePawn(WHITE);
+static Rook whiteRook(WHITE);
+static Knight whiteKnight(WHITE);
+static Bishop whiteBishop(WHITE);
+static Queen whiteQueen(WHITE);
+static King whiteKing(WHITE);
+static Pawn blackPawn(BLACK);
+static Rook blackRook(BLACK);
+static Knight blackKnight(BLACK);
+static Bishop blackBishop(BLACK);
+static Queen blackQueen(BLACK);
+static King blackKing(BLACK);
+
+static Piece *const pieceObjects[16] = {
+    nullptr, &whitePawn, &whiteRook, &whiteKnight, &whiteBishop, &whiteQueen, &whiteKing, nullptr,
+    nullptr, &blackPawn, &blackRook, &blackKnight, &blackBishop, &blackQueen, &blackKing, nullptr};
+
+// Whether the piece could ever go from -> to on an empty board: the shape
+// check of Piece::canMove(), read from the delta table
+static bool fitsPattern(PieceCode piece, Square from, Square to)
 {
-    for (int r = 0; r < 8; r++)
+    PieceType type = pieceType(piece);
+    PieceColor color = pieceColor(piece);
+    if (type == PAWN)
     {
-        for (int c = 0; c < 8; c++)
-        {
-            board[r][c] = nullptr;
-        }
+        int8_t forward = ((int8_t)(to >> 3) - (int8_t)(from >> 3)) * pawnDirection(color);
+        bool sameFile = (from & 7) == (to & 7);
+        if (sameFile && (forward == 1 || (forward == 2 && (from >> 3) == 1 + 5 * color)))
+            return true;
     }
-    currentTurn = WHITE;
-    gameState = GAME_ACTIVE;
-    moveCount = 0;
-    halfMoveClock = 0;
-    positionCount = 0;
-    lastMove.piece = nullptr;
+    // Castling: two files sideways from the king's home square
+    if (type == KING && from == 4 + 56 * color && (to == from + 2 || to == from - 2))
+        return true;
+    return (deltaAttackers88(deltaIndex88(from, to)) & attackBit(type, color)) != 0;
 }
 
-int ChessBoard::rowToIndex(int row) { return row - 1; }
-int ChessBoard::colToIndex(char col) { return col - 'A'; }
-char ChessBoard::indexToCol(int index) { return 'A' + index; }
-int ChessBoard::indexToRow(int index) { return index + 1; }
+// Letter used by printBoard (lowercase = black)
+static char pieceLetter(PieceCode piece)
+{
+    static const char letters[6] = {'P', 'R', 'N', 'B', 'Q', 'K'};
+    char letter = letters[pieceType(piece)];
+    return pieceColor(piece) == BLACK ? letter + 32 : letter;
+}
 
-Piece *ChessBoard::getPiece(int row, char col)
+ChessBoard::ChessBoard() : store(nullptr)
 {
-    return board[rowToIndex(row)][colToIndex(col)];
+    clearBoard();
+}
+
+Piece *ChessBoard::getPiece(Square sq)
+{
+    return pieceObjects[pos.board.pieceAt(sq)];
+}
+
+bool ChessBoard::placePiece(Piece *piece, Square sq)
+{
+    PieceCode code = makePiece(piece->getType(), piece->getColor());
+    if (piece != pieceObjects[code])
+    {
+        delete piece;
+    }
+    return placePiece(pieceType(code), pieceColor(code), sq);
+}
+
+// False if a piece of color can't go on sq: the side is full, and sq
+// doesn't hold one of its pieces to make way
+bool ChessBoard::hasRoomFor(PieceCode piece, Square sq)
+{
+    // Replacing a piece of the same colour (or type) frees its place first
+    PieceCode there = pos.board.pieceAt(sq);
+    PieceColor color = pieceColor(piece);
+    if (pos.board.pieceCount(color) >= MAX_PIECES_PER_SIDE && (there == NO_PIECE || pieceColor(there) != color))
+    {
+        Serial.println("Too many pieces of that colour!");
+        return false;
+    }
+    if (!materialHasRoom(pos.board.materialKey(), piece) && there != piece)
+    {
+        Serial.println("Too many pieces of that type!");
+        return false;
+    }
+    return true;
 }
 
-void ChessBoard::placePiece(Piece *piece, int row, char col)
+bool ChessBoard::placePiece(PieceType type, PieceColor color, Square sq)
 {
-    board[rowToIndex(row)][colToIndex(col)] = piece;
+    if (!hasRoomFor(makePiece(type, color), sq))
+        return false;
+    storeSynced = false;
+    if (pos.board.pieceAt(sq) != NO_PIECE)
+    {
+        clearSquare(sq);
+    }
+    putSquare(sq, makePiece(type, color));
+
+    // A hand-placed king and rook on their home squares may castle, as in a fresh game
+    uint8_t rights = 0;
+    if (pos.board.pieceAt(4) == makePiece(KING, WHITE))
+    {
+        if (pos.board.pieceAt(7) == makePiece(ROOK, WHITE))
+            rights |= CASTLE_WHITE_KINGSIDE;
+        if (pos.board.pieceAt(0) == makePiece(ROOK, WHITE))
+            rights |= CASTLE_WHITE_QUEENSIDE;
+    }
+    if (pos.board.pieceAt(60) == makePiece(KING, BLACK))
+    {
+        if (pos.board.pieceAt(63) == makePiece(ROOK, BLACK))
+            rights |= CASTLE_BLACK_KINGSIDE;
+        if (pos.board.pieceAt(56) == makePiece(ROOK, BLACK))
+            rights |= CASTLE_BLACK_QUEENSIDE;
+    }
+    pos.castlingRights |= rights & castlingRightsLost(sq);
+    return true;
 }
 
-void ChessBoard::removePiece(int row, char col)
+void ChessBoard::removePiece(Square sq)
 {
-    Piece *p = getPiece(row, col);
-    if (p != nullptr)
+    PieceCode p = pos.board.pieceAt(sq);
+    if (p != NO_PIECE)
     {
         Serial.print("Removing piece: ");
-        p->printInfo();
-        delete p;
-        board[rowToIndex(row)][colToIndex(col)] = nullptr;
+        pieceObjects[p]->printInfo();
+        clearSquare(sq);
+        pos.castlingRights &= ~castlingRightsLost(sq);
+        storeSynced = false;
     }
 }
-void ChessBoard::captureAndPlace(Piece *piece, int row, char col)
+bool ChessBoard::captureAndPlace(Piece *piece, Square sq)
 {
-    if (getPiece(row, col) != nullptr)
+    if (!hasRoomFor(makePiece(piece->getType(), piece->getColor()), sq))
+    {
+        if (piece != pieceObjects[makePiece(piece->getType(), piece->getColor())])
+            delete piece;
+        return false;
+    }
+    if (getPiece(sq) != nullptr)
     {
-        removePiece(row, col);
+        removePiece(sq);
     }
-    placePiece(piece, row, col);
+    return placePiece(piece, sq);
+}
+
+// Every square edit goes through these so the attack map stays in step
+// with the position. A piece the backend has no room for changes nothing.
+bool ChessBoard::putSquare(Square sq, PieceCode piece)
+{
+    if (!pos.board.put(sq, piece))
+        return false;
+    dirtySquares |= 1ULL << sq;
+#if SMARTCHESS_ATTACK_MAPS
+    attacks.pieceAdded(pos.board, sq);
+#endif
+    return true;
+}
+
+void ChessBoard::clearSquare(Square sq)
+{
+    dirtySquares |= 1ULL << sq;
+#if SMARTCHESS_ATTACK_MAPS
+    TrackedBoard(pos.board, attacks).remove(sq);
+#else
+    pos.board.remove(sq);
+#endif
+}
+
+PieceCode ChessBoard::playMove(Move move)
+{
+    dirtySquares |= moveSquares(move);
+#if SMARTCHESS_ATTACK_MAPS
+    TrackedBoard tracked(pos.board, attacks);
+    return pos.makeMove(tracked, move);
+#else
+    return pos.makeMove(move);
+#endif
+}
+
+bool ChessBoard::squareAttacked(Square sq, PieceColor attackerColor)
+{
+    PERF_SCOPE(PERF_IS_SQUARE_ATTACKED);
+#if SMARTCHESS_ATTACK_MAPS
+    return attacks.isAttacked(sq, attackerColor);
+#else
+    return pos.board.isAttacked(sq, attackerColor);
+#endif
+}
+
+// Turn a from/to pair into a Move, recognising the special moves
+Move ChessBoard::buildMove(Square from, Square to, PromotionType promotionChoice)
+{
+    PieceCode piece = pos.board.pieceAt(from);
+    int colDiff = (to & 7) - (from & 7);
+
+    if (pieceType(piece) == PAWN)
+    {
+        if ((to >> 3) == 7 || (to >> 3) == 0)
+            return makeMove(from, to, MOVE_PROMOTION, promotionChoice);
+        if (to == pos.epSquare && colDiff != 0 && pos.board.pieceAt(to) == NO_PIECE)
+            return makeMove(from, to, MOVE_EN_PASSANT);
+    }
+
+    if (pieceType(piece) == KING && abs(colDiff) == 2)
+    {
+        Square rookSq = colDiff > 0 ? from + 3 : from - 4;
+        if (pos.board.pieceAt(rookSq) == makePiece(ROOK, pieceColor(piece)))
+            return makeMove(from, to, MOVE_CASTLING);
+    }
+
+    return makeMove(from, to);
 }
 
 // Move piece with promotion choice (for pawns)
-bool ChessBoard::movePiece(int fromRow, char fromCol, int toRow, char toCol, PromotionType promotionChoice)
+bool ChessBoard::movePiece(Square from, Square to, PromotionType promotionChoice)
 {
+    PERF_SCOPE(PERF_MOVE_PIECE);
     // Check if game is over
     if (gameState != GAME_ACTIVE)
     {
@@ -69,562 +233,294 @@ bool ChessBoard::movePiece(int fromRow, char fromCol, int toRow, char toCol, Pro
         return false;
     }
 
-    Piece *piece = getPiece(fromRow, fromCol);
-    if (!piece)
+    PieceCode piece = pos.board.pieceAt(from);
+    if (piece == NO_PIECE)
     {
         Serial.println("No piece to move!");
         return false;
     }
 
     // Check if it's the correct player's turn
-    if (piece->getColor() != currentTurn)
+    if (pieceColor(piece) != pos.sideToMove)
     {
         Serial.println("Not your turn!");
         return false;
     }
 
     // Check if the piece can move (pattern-wise)
-    if (!piece->canMove(fromRow, fromCol, toRow, toCol))
+    if (!fitsPattern(piece, from, to))
     {
         Serial.println("Illegal move for this piece!");
         return false;
     }
 
     // Check if trying to capture own piece (not allowed)
-    Piece *targetPiece = getPiece(toRow, toCol);
-    if (targetPiece != nullptr && targetPiece->getColor() == piece->getColor())
+    PieceCode targetPiece = pos.board.pieceAt(to);
+    if (targetPiece != NO_PIECE && pieceColor(targetPiece) == pieceColor(piece))
     {
         Serial.println("Cannot capture your own piece!");
         return false;
     }
 
     // Check if path is clear (for pieces that need it)
-    if (!isPathClear(fromRow, fromCol, toRow, toCol))
+    if (!isPathClear(from, to))
     {
         Serial.println("Path is blocked!");
         return false;
     }
 
-    // Check if move is legal (doesn't leave own king in check)
-    if (!isMoveLegal(fromRow, fromCol, toRow, toCol))
-    {
-        Serial.println("Move would leave king in check!");
-        return false;
-    }
-
-    // If in check, verify this move gets out of check
-    if (isInCheck(currentTurn))
+    // Castling - additional validation
+    int8_t colDiff = (int8_t)(to & 7) - (int8_t)(from & 7);
+    if (pieceType(piece) == KING && (colDiff == 2 || colDiff == -2))
     {
-        if (wouldMoveLeaveKingInCheck(fromRow, fromCol, toRow, toCol, currentTurn))
+        // Cannot castle if in check
+        if (isInCheck(pos.sideToMove))
         {
-            // This means the move would still leave us in check, so it's illegal
-            Serial.println("Must get out of check!");
+            Serial.println("Cannot castle while in check!");
             return false;
         }
-    }
-
-    // Store move info for history (before the move)
-    Piece *capturedPiece = getPiece(toRow, toCol);
 
-    // --- Special moves ---
-
-    // King
-    bool kingMoved = false;
-    bool rookMoved = false;
-    char rookCol = 'A';
-    if (piece->getTypeName()[0] == 'K')
-    {
-        King *k = (King *)piece;
-        kingMoved = k->hasMoved;
+        Square rookSq = colDiff > 0 ? from + 3 : from - 4;
+        PieceCode rookPiece = pos.board.pieceAt(rookSq);
+        if (rookPiece == NO_PIECE || pieceType(rookPiece) != ROOK)
+        {
+            Serial.println("No rook to castle with!");
+            return false;
+        }
 
-        // Castling - additional validation
-        if (abs(toCol - fromCol) == 2)
+        // Check if rook is same color as king
+        if (pieceColor(rookPiece) != pieceColor(piece))
         {
-            // Cannot castle if in check
-            if (isInCheck(currentTurn))
-            {
-                Serial.println("Cannot castle while in check!");
-                return false;
-            }
+            Serial.println("Cannot castle with opponent's rook!");
+            return false;
+        }
 
-            rookCol = (toCol > fromCol) ? 'H' : 'A';
-            Piece *rookPiece = getPiece(fromRow, rookCol);
-            if (!rookPiece || rookPiece->getTypeName()[0] != 'R')
-            {
-                Serial.println("No rook to castle with!");
-                return false;
-            }
+        // Check if king and rook haven't moved
+        if (!hasCastlingRight(pos.sideToMove, colDiff > 0))
+        {
+            Serial.println("Cannot castle - king or rook has moved!");
+            return false;
+        }
 
-            // Check if rook is same color as king
-            if (rookPiece->getColor() != k->getColor())
+        // Check if squares between king and rook are clear
+        int8_t step = colDiff > 0 ? 1 : -1;
+        for (Square sq = from + step; sq != rookSq; sq += step)
+        {
+            if (pos.board.pieceAt(sq) != NO_PIECE)
             {
-                Serial.println("Cannot castle with opponent's rook!");
+                Serial.println("Cannot castle - path is blocked!");
                 return false;
             }
+        }
 
-            Rook *r = (Rook *)rookPiece;
-
-            // Check if king and rook haven't moved
-            if (k->hasMoved || r->hasMoved)
+        // Check if squares the king moves through are attacked
+        for (Square sq = from; sq != to + step; sq += step)
+        {
+            if (squareAttacked(sq, opponent(pos.sideToMove)))
             {
-                Serial.println("Cannot castle - king or rook has moved!");
+                Serial.println("Cannot castle through check!");
                 return false;
             }
-
-            rookMoved = r->hasMoved;
-
-            // Check if squares between king and rook are clear
-            char step = (toCol > fromCol) ? 1 : -1;
-            for (char c = fromCol + step; c != rookCol; c += step)
-            {
-                if (getPiece(fromRow, c) != nullptr)
-                {
-                    Serial.println("Cannot castle - path is blocked!");
-                    return false;
-                }
-            }
-
-            // Check if squares the king moves through are attacked
-            for (char c = fromCol; c != toCol + step; c += step)
-            {
-                if (isSquareAttacked(fromRow, c, (currentTurn == WHITE) ? BLACK : WHITE))
-                {
-                    Serial.println("Cannot castle through check!");
-                    return false;
-                }
-            }
-
-            char newRookCol = (toCol > fromCol) ? 'F' : 'D';
-            placePiece(r, fromRow, newRookCol);
-            removePiece(fromRow, rookCol);
-
-            r->hasMoved = true;
         }
-
-        k->hasMoved = true;
     }
 
-    // Rook
-    if (piece->getTypeName()[0] == 'R')
+    // Check if move is legal (doesn't leave own king in check)
+    if (!isMoveLegal(from, to))
     {
-        Rook *r = (Rook *)piece;
-        r->hasMoved = true;
+        Serial.println("Move would leave king in check!");
+        return false;
     }
 
-    // Pawn
-    bool pawnMoved = false;
-    if (piece->getTypeName()[0] == 'P')
+    // Hand edits since the last logged position: the log restarts from here
+    if (store && !storeSynced)
     {
-        Pawn *pawn = (Pawn *)piece;
-        int dir = (pawn->getColor() == WHITE) ? 1 : -1;
-        pawnMoved = true;
-
-        // En passant
-        if (abs(toCol - fromCol) == 1 && toRow - fromRow == dir && getPiece(toRow, toCol) == nullptr)
-        {
-            if (lastMove.piece && lastMove.piece->getTypeName()[0] == 'P')
-            {
-                // Check if last move was by opponent's pawn (different color)
-                if (lastMove.piece->getColor() != pawn->getColor() &&
-                    abs(lastMove.toRow - lastMove.fromRow) == 2 &&
-                    lastMove.toRow == fromRow &&
-                    lastMove.toCol == toCol)
-                {
-                    removePiece(lastMove.toRow, lastMove.toCol);
-                }
-            }
-        }
-
-        // Update last move for en passant (only if pawn advanced two squares)
-        if (abs(toRow - fromRow) == 2)
-        {
-            lastMove.piece = pawn;
-            lastMove.fromRow = fromRow;
-            lastMove.fromCol = fromCol;
-            lastMove.toRow = toRow;
-            lastMove.toCol = toCol;
-        }
-        else
-        {
-            // Clear en passant opportunity if pawn didn't advance two squares
-            lastMove.piece = nullptr;
-        }
-
-        // Reset half-move clock on pawn move
-        halfMoveClock = 0;
+        syncStore();
     }
-    else
-    {
-        // Non-pawn move: clear en passant opportunity
-        lastMove.piece = nullptr;
 
-        if (capturedPiece)
-        {
-            // Reset half-move clock on capture
-            halfMoveClock = 0;
-        }
-        else
-        {
-            // Increment half-move clock
-            halfMoveClock++;
-        }
+    // --- Move the piece (captures, en passant, castling rook, promotion) ---
+    // Plays the move and updates turn, clocks, castling rights and en passant
+    Move move = buildMove(from, to, promotionChoice);
+    bool check = ::givesCheck(pos.board, move);
+    PieceCode capturedPiece = playMove(move);
+    if (capturedPiece != NO_PIECE)
+    {
+        Serial.print("Removing piece: ");
+        pieceObjects[capturedPiece]->printInfo();
     }
 
-    // --- Move the piece ---
-    captureAndPlace(piece, toRow, toCol);
-    board[rowToIndex(fromRow)][colToIndex(fromCol)] = nullptr;
-
-    // --- Pawn promotion with choice ---
-    if (piece->getTypeName()[0] == 'P')
+    if (moveFlag(move) == MOVE_PROMOTION)
     {
-        int finalRow = (piece->getColor() == WHITE) ? 8 : 1;
-        if (toRow == finalRow)
-        {
-            promotePawn(toRow, toCol, promotionChoice, piece->getColor());
-        }
+        Serial.print("Pawn promoted to ");
+        Serial.print(pieceObjects[pos.board.pieceAt(to)]->getTypeName());
+        Serial.println();
     }
 
     // Add to move history
-    addToHistory(fromRow, fromCol, toRow, toCol);
-
-    // Switch turn
-    currentTurn = (currentTurn == WHITE) ? BLACK : WHITE;
+    addToHistory(move);
+    if (store)
+    {
+        store->appendMove(move, pos);
+    }
 
     // Store board state for repetition detection (after turn switch)
     storeBoardState();
 
     // Update game state
-    updateGameState();
+    updateGameState(check);
 
     return true;
 }
 
-// Move piece (default version, pawns promote to queen)
-bool ChessBoard::movePiece(int fromRow, char fromCol, int toRow, char toCol)
+bool ChessBoard::movePiece(Move move)
 {
-    return movePiece(fromRow, fromCol, toRow, toCol, PROMOTE_QUEEN);
+    return movePiece(moveFrom(move), moveTo(move), movePromotion(move));
 }
 
 void ChessBoard::printBoard()
 {
-    for (int r = 8; r >= 1; r--)
+    for (int8_t rank = 7; rank >= 0; rank--)
     {
-        Serial.print(r);
+        Serial.print(rank + 1);
         Serial.print(" ");
-        for (char c = 'A'; c <= 'H'; c++)
+        for (Square sq = rank * 8; sq < rank * 8 + 8; sq++)
         {
-            Piece *p = getPiece(r, c);
-            if (p == nullptr)
+            PieceCode p = pos.board.pieceAt(sq);
+            if (p == NO_PIECE)
                 Serial.print(". ");
             else
             {
-                char pieceChar = '?'; // Initialize to avoid warnings
-                switch (p->getType())
-                {
-                case PAWN:
-                    pieceChar = 'P';
-                    break;
-                case ROOK:
-                    pieceChar = 'R';
-                    break;
-                case KNIGHT:
-                    pieceChar = 'N';
-                    break;
-                case BISHOP:
-                    pieceChar = 'B';
-                    break;
-                case QUEEN:
-                    pieceChar = 'Q';
-                    break;
-                case KING:
-                    pieceChar = 'K';
-                    break;
-                }
-
-                // Optional: visual distinction for Black pieces in console
-                if (p->getColor() == BLACK)
-                {
-                    pieceChar = tolower(pieceChar);
-                }
-
-                Serial.print(pieceChar);
+                Serial.print(pieceLetter(p));
                 Serial.print(" ");
             }
         }
-        // REMOVED THE ERROR LINE HERE
         Serial.println();
     }
     Serial.println("  A B C D E F G H");
 }
 
-bool ChessBoard::isSquareAttacked(int row, char col, PieceColor attackerColor)
+bool ChessBoard::isSquareAttacked(Square sq, PieceColor attackerColor)
 {
-    for (int r = 1; r <= 8; r++)
+    return squareAttacked(sq, attackerColor);
+}
+
+uint8_t ChessBoard::getAttackerCount(Square sq, PieceColor attackerColor)
+{
+#if SMARTCHESS_ATTACK_MAPS
+    return attacks.attackers(sq, attackerColor);
+#else
+    return pos.board.isAttacked(sq, attackerColor) ? 1 : 0;
+#endif
+}
+
+uint8_t ChessBoard::getThreatRank(int row, PieceColor attackerColor)
+{
+#if SMARTCHESS_ATTACK_MAPS
+    return attacks.attackedRank(attackerColor, row - 1);
+#else
+    uint8_t rank = 0;
+    for (uint8_t file = 0; file < 8; file++)
     {
-        for (char c = 'A'; c <= 'H'; c++)
-        {
-            Piece *p = getPiece(r, c);
-            if (p != nullptr && p->getColor() == attackerColor)
-            {
-                // SPECIAL HANDLING FOR PAWNS
-                if (p->getTypeName()[0] == 'P')
-                {
-                    int dir = (p->getColor() == WHITE) ? 1 : -1;
-                    int rowDiff = row - r;
-                    int colDiff = abs(col - c);
-
-                    // Pawns only attack diagonally forward (row diff must match direction, col diff must be 1)
-                    if (rowDiff == dir && colDiff == 1)
-                    {
-                        return true;
-                    }
-                    // Ignore forward movement logic for attacks!
-                }
-                // LOGIC FOR ALL OTHER PIECES
-                else if (p->canMove(r, c, row, col))
-                {
-                    if (isPathClear(r, c, row, col))
-                    {
-                        return true;
-                    }
-                }
-            }
-        }
+        if (pos.board.isAttacked((row - 1) * 8 + file, attackerColor))
+            rank |= 1 << file;
     }
-    return false;
+    return rank;
+#endif
 }
 
 // Helper method to check if path between two squares is clear
-bool ChessBoard::isPathClear(int fromRow, char fromCol, int toRow, char toCol)
+bool ChessBoard::isPathClear(Square from, Square to)
 {
+    PERF_SCOPE(PERF_IS_PATH_CLEAR);
     // Knights don't need path checking
-    Piece *piece = getPiece(fromRow, fromCol);
-    if (piece && piece->getTypeName()[0] == 'N')
-    {
-        return true;
-    }
-
-    // Kings moving one square don't need path checking
-    int rowDiff = abs(toRow - fromRow);
-    int colDiff = abs(toCol - fromCol);
-    if (rowDiff <= 1 && colDiff <= 1)
+    PieceCode piece = pos.board.pieceAt(from);
+    if (piece != NO_PIECE && pieceType(piece) == KNIGHT)
     {
         return true;
     }
 
     // Pawns need special handling
-    if (piece && piece->getTypeName()[0] == 'P')
+    if (piece != NO_PIECE && pieceType(piece) == PAWN)
     {
+        PieceCode targetPiece = pos.board.pieceAt(to);
         // For diagonal captures, check if target square has enemy piece
-        if (colDiff != 0)
+        if ((from & 7) != (to & 7))
         {
-            Piece *targetPiece = getPiece(toRow, toCol);
-            // If target square is empty, check for en passant
-            if (targetPiece == nullptr)
-            {
-                // Check en passant condition
-                int dir = (piece->getColor() == WHITE) ? 1 : -1;
-                // En passant: diagonal move one square forward into empty square
-                if (abs(toCol - fromCol) == 1 && toRow - fromRow == dir)
-                {
-                    // Check if last move was by opponent's pawn that moved two squares
-                    if (lastMove.piece && lastMove.piece->getTypeName()[0] == 'P')
-                    {
-                        if (lastMove.piece->getColor() != piece->getColor() &&
-                            abs(lastMove.toRow - lastMove.fromRow) == 2 &&
-                            lastMove.toRow == fromRow &&
-                            lastMove.toCol == toCol)
-                        {
-                            return true; // En passant is valid
-                        }
-                    }
-                }
-                return false; // Empty diagonal target without en passant is invalid
-            }
-            return targetPiece != nullptr && targetPiece->getColor() != piece->getColor();
-        }
-        // For forward moves, check if path is clear and destination is empty
-        if (getPiece(toRow, toCol) != nullptr)
-        {
-            return false; // Destination must be empty for forward moves
+            // If target square is empty, only an en passant capture is possible
+            if (targetPiece == NO_PIECE)
+                return to == pos.epSquare && (deltaAttackers88(deltaIndex88(from, to)) & attackBit(PAWN, pieceColor(piece)));
+            return pieceColor(targetPiece) != pieceColor(piece);
         }
-        int dir = (toRow > fromRow) ? 1 : -1;
-        for (int r = fromRow + dir; r != toRow; r += dir)
+        // Forward moves need an empty destination (and path, below)
+        if (targetPiece != NO_PIECE)
         {
-            if (getPiece(r, fromCol) != nullptr)
-            {
-                return false;
-            }
+            return false;
         }
-        return true;
     }
 
-    // For other pieces, check all squares in between
-    int rowStep = (toRow > fromRow) ? 1 : (toRow < fromRow) ? -1
-                                                            : 0;
-    int colStep = (toCol > fromCol) ? 1 : (toCol < fromCol) ? -1
-                                                            : 0;
-
-    int r = fromRow + rowStep;
-    char c = fromCol + colStep;
-
-    while (r != toRow || c != toCol)
+    // Everything else: the squares strictly between must be empty
+    int8_t step = deltaStep88(deltaIndex88(from, to));
+    if (step == 0)
     {
-        if (getPiece(r, c) != nullptr)
+        return true;
+    }
+    for (Square sq = from + step; sq != to; sq += step)
+    {
+        if (pos.board.pieceAt(sq) != NO_PIECE)
         {
             return false;
         }
-        r += rowStep;
-        c += colStep;
     }
-
     return true;
 }
 
 // Find the king of the specified color
-bool ChessBoard::findKing(PieceColor color, int &row, char &col)
+Square ChessBoard::kingSquare(PieceColor color)
 {
-    for (int r = 1; r <= 8; r++)
-    {
-        for (char c = 'A'; c <= 'H'; c++)
-        {
-            Piece *p = getPiece(r, c);
-            if (p != nullptr && p->getTypeName()[0] == 'K' && p->getColor() == color)
-            {
-                row = r;
-                col = c;
-                return true;
-            }
-        }
-    }
-    return false;
+    return pos.board.kingSquare(color);
 }
 
 // Check if a color's king is in check
 bool ChessBoard::isInCheck(PieceColor color)
 {
-    int kingRow;
-    char kingCol;
-    if (!findKing(color, kingRow, kingCol))
-    {
-        return false; // No king found (shouldn't happen in normal game)
-    }
-
-    PieceColor attackerColor = (color == WHITE) ? BLACK : WHITE;
-    return isSquareAttacked(kingRow, kingCol, attackerColor);
+    // No king (hand-made setups): NO_SQUARE is never attacked
+    return squareAttacked(pos.board.kingSquare(color), opponent(color));
 }
 
-// Check if a move would leave the king in check
-bool ChessBoard::wouldMoveLeaveKingInCheck(int fromRow, char fromCol, int toRow, char toCol, PieceColor color)
-{
-    // Make a temporary move
-    Piece *piece = getPiece(fromRow, fromCol);
-    Piece *capturedPiece = getPiece(toRow, toCol);
-
-    // Check if this is an en passant capture
-    bool isEnPassant = false;
-    Piece *enPassantCapturedPawn = nullptr;
-
-    if (piece && piece->getTypeName()[0] == 'P')
-    {
-        Pawn *pawn = (Pawn *)piece;
-        int dir = (pawn->getColor() == WHITE) ? 1 : -1;
-
-        // En passant: pawn moves diagonally one square forward into empty square
-        if (abs(toCol - fromCol) == 1 &&
-            toRow - fromRow == dir &&
-            getPiece(toRow, toCol) == nullptr)
-        {
-            // Check if there's an en passant-eligible pawn at (fromRow, toCol)
-            if (lastMove.piece && lastMove.piece->getTypeName()[0] == 'P')
-            {
-                if (lastMove.piece->getColor() != pawn->getColor() &&
-                    abs(lastMove.toRow - lastMove.fromRow) == 2 &&
-                    lastMove.toRow == fromRow &&
-                    lastMove.toCol == toCol)
-                {
-                    isEnPassant = true;
-                    enPassantCapturedPawn = getPiece(fromRow, toCol);
-                }
-            }
-        }
-    }
-
-    // Execute the move temporarily
-    board[rowToIndex(toRow)][colToIndex(toCol)] = piece;
-    board[rowToIndex(fromRow)][colToIndex(fromCol)] = nullptr;
-
-    // If en passant, also clear the captured pawn's square
-    if (isEnPassant && enPassantCapturedPawn)
-    {
-        board[rowToIndex(fromRow)][colToIndex(toCol)] = nullptr;
-    }
-
-    // Check if king is in check
-    bool inCheck = isInCheck(color);
-
-    // Undo the move
-    board[rowToIndex(fromRow)][colToIndex(fromCol)] = piece;
-    board[rowToIndex(toRow)][colToIndex(toCol)] = capturedPiece;
-
-    // If en passant, restore the captured pawn
-    if (isEnPassant && enPassantCapturedPawn)
-    {
-        board[rowToIndex(fromRow)][colToIndex(toCol)] = enPassantCapturedPawn;
-    }
-
-    return inCheck;
-}
 
 // Check if a move is legal (doesn't leave own king in check)
-bool ChessBoard::isMoveLegal(int fromRow, char fromCol, int toRow, char toCol)
+bool ChessBoard::isMoveLegal(Square from, Square to)
 {
-    Piece *piece = getPiece(fromRow, fromCol);
-    if (!piece)
+    PERF_SCOPE(PERF_IS_MOVE_LEGAL);
+    PieceCode piece = pos.board.pieceAt(from);
+    if (piece == NO_PIECE)
         return false;
 
-    // Check if the move would leave our own king in check
-    return !wouldMoveLeaveKingInCheck(fromRow, fromCol, toRow, toCol, piece->getColor());
+    // Play the move on a scratch copy of the squares
+    return !leavesKingInCheck(pos.board, buildMove(from, to, PROMOTE_QUEEN), pieceColor(piece));
 }
 
 // Check if a color has any valid moves
 bool ChessBoard::hasAnyValidMove(PieceColor color)
 {
-    for (int r = 1; r <= 8; r++)
+    PERF_SCOPE(PERF_HAS_ANY_VALID_MOVE);
+    if (color == pos.sideToMove)
     {
-        for (char c = 'A'; c <= 'H'; c++)
-        {
-            Piece *p = getPiece(r, c);
-            if (p != nullptr && p->getColor() == color)
-            {
-                // Try all possible destination squares
-                for (int toRow = 1; toRow <= 8; toRow++)
-                {
-                    for (char toCol = 'A'; toCol <= 'H'; toCol++)
-                    {
-                        if (p->canMove(r, c, toRow, toCol) &&
-                            isPathClear(r, c, toRow, toCol) &&
-                            isMoveLegal(r, c, toRow, toCol))
-                        {
-                            // Check if in check - if so, verify this move gets out
-                            if (isInCheck(color))
-                            {
-                                if (!wouldMoveLeaveKingInCheck(r, c, toRow, toCol, color))
-                                {
-                                    return true;
-                                }
-                            }
-                            else
-                            {
-                                return true;
-                            }
-                        }
-                    }
-                }
-            }
-        }
+        return pos.hasLegalMove();
     }
-    return false;
+
+    // The other side, as if it were its turn (en passant is only open to the side to move)
+    Position other = pos;
+    other.sideToMove = color;
+    other.epSquare = NO_SQUARE;
+    return other.hasLegalMove();
+}
+
+// Check if a (pseudo-legal) move would check the opponent, without playing it
+bool ChessBoard::givesCheck(Square from, Square to, PromotionType promotionChoice)
+{
+    if (pos.board.pieceAt(from) == NO_PIECE)
+        return false;
+    return ::givesCheck(pos.board, buildMove(from, to, promotionChoice));
 }
 
 // Check if it's checkmate
@@ -639,136 +535,38 @@ bool ChessBoard::isStalemate(PieceColor color)
     return !isInCheck(color) && !hasAnyValidMove(color);
 }
 
-// Store current board state in history
+// Store current position key in history
 void ChessBoard::storeBoardState()
 {
-    // Shift history if full (remove oldest) - keep only last 6 positions
-    if (positionCount >= 6)
+    // Shift history if full (remove oldest)
+    if (positionCount >= POSITION_HISTORY_SIZE)
     {
-        for (int i = 0; i < 5; i++)
+        for (int i = 0; i < POSITION_HISTORY_SIZE - 1; i++)
         {
             positionHistory[i] = positionHistory[i + 1];
         }
-        positionCount = 5; // Will be incremented to 6 after adding new state
+        positionCount = POSITION_HISTORY_SIZE - 1; // Will be incremented after adding new key
     }
 
-    // Add the new state
-    BoardState &state = positionHistory[positionCount];
-    state.turn = currentTurn;
-
-    // Encode board state: ' ' = empty, piece type char = piece
-    // For pieces, use lowercase for black, uppercase for white
-    int idx = 0;
-    for (int r = 1; r <= 8; r++)
-    {
-        for (char c = 'A'; c <= 'H'; c++)
-        {
-            Piece *p = getPiece(r, c);
-            if (p == nullptr)
-            {
-                state.state[idx] = ' ';
-            }
-            else
-            {
-                char pieceChar;
-
-                switch (p->getType())
-                {
-                case PAWN:
-                    pieceChar = 'P';
-                    break;
-                case ROOK:
-                    pieceChar = 'R';
-                    break;
-                case KNIGHT:
-                    pieceChar = 'N';
-                    break; // Use 'N' for Knight
-                case BISHOP:
-                    pieceChar = 'B';
-                    break;
-                case QUEEN:
-                    pieceChar = 'Q';
-                    break;
-                case KING:
-                    pieceChar = 'K';
-                    break;
-                }
-
-                if (p->getColor() == BLACK)
-                {
-                    state.state[idx] = pieceChar + 32; // Lowercase
-                }
-                else
-                {
-                    state.state[idx] = pieceChar; // Uppercase
-                }
-            }
-            idx++;
-        }
-    }
+    // The key covers pieces, side to move, castling rights and en passant
+    positionHistory[positionCount] = pos.key();
     positionCount++;
 }
 
-// Compare two board states
-bool ChessBoard::compareBoardStates(const BoardState &state1, const BoardState &state2)
-{
-    // Must be same turn
-    if (state1.turn != state2.turn)
-        return false;
-
-    // Compare all squares
-    for (int i = 0; i < 64; i++)
-    {
-        if (state1.state[i] != state2.state[i])
-            return false;
-    }
-
-    return true;
-}
-
 // Count how many times the current position has occurred
 int ChessBoard::countMoveRepetitions()
 {
     if (positionCount < 2)
         return 1; // Current position is first occurrence
 
-    // Create current board state
-    BoardState currentState;
-    currentState.turn = currentTurn;
-
-    int idx = 0;
-    for (int r = 1; r <= 8; r++)
-    {
-        for (char c = 'A'; c <= 'H'; c++)
-        {
-            Piece *p = getPiece(r, c);
-            if (p == nullptr)
-            {
-                currentState.state[idx] = ' ';
-            }
-            else
-            {
-                char pieceChar = p->getTypeName()[0];
-                if (p->getColor() == BLACK)
-                {
-                    currentState.state[idx] = pieceChar + 32;
-                }
-                else
-                {
-                    currentState.state[idx] = pieceChar;
-                }
-            }
-            idx++;
-        }
-    }
-
     // Count how many times this position occurred
-    // Note: storeBoardState already appended the current state to positionHistory,
+    // Note: storeBoardState already appended the current key to positionHistory,
     // so we start count at 0 and compare against all stored entries
+    HashKey current = pos.key();
     int count = 0;
     for (int i = 0; i < positionCount; i++)
     {
-        if (compareBoardStates(currentState, positionHistory[i]))
+        if (positionHistory[i] == current)
         {
             count++;
         }
@@ -779,9 +577,15 @@ int ChessBoard::countMoveRepetitions()
 
 // Check if game is a draw
 bool ChessBoard::isDraw()
+{
+    return isDrawByRule() || isStalemate(pos.sideToMove);
+}
+
+// Draws that don't depend on the side to move having a legal move
+bool ChessBoard::isDrawByRule()
 {
     // 50-move rule
-    if (halfMoveClock >= 100)
+    if (pos.halfMoveClock >= 100)
     {
         return true;
     }
@@ -791,140 +595,9 @@ bool ChessBoard::isDraw()
         return true;
     }
 
-    // Stalemate
-    if (isStalemate(currentTurn))
-    {
-        return true;
-    }
-
-    // Insufficient material check
-    // A game is drawn if neither side has sufficient material to force checkmate
-    int whitePawns = 0, blackPawns = 0;
-    int whiteRooks = 0, blackRooks = 0;
-    int whiteKnights = 0, blackKnights = 0;
-    int whiteBishops = 0, blackBishops = 0;
-    int whiteQueens = 0, blackQueens = 0;
-    bool whiteHasLightBishop = false, whiteHasDarkBishop = false;
-    bool blackHasLightBishop = false, blackHasDarkBishop = false;
-
-    for (int r = 1; r <= 8; r++)
-    {
-        for (char c = 'A'; c <= 'H'; c++)
-        {
-            Piece *p = getPiece(r, c);
-            if (p != nullptr)
-            {
-                char type = p->getTypeName()[0];
-                // Determine if square is light or dark
-                // A1 is dark, so even sum = dark, odd sum = light
-                // A=1, B=2, etc., rows 1-8
-                int colVal = c - 'A' + 1;
-                bool isLightSquare = ((r + colVal) % 2 == 1);
-
-                if (p->getColor() == WHITE)
-                {
-                    if (type == 'P')
-                        whitePawns++;
-                    else if (type == 'R')
-                        whiteRooks++;
-                    else if (type == 'N')
-                        whiteKnights++;
-                    else if (type == 'B')
-                    {
-                        whiteBishops++;
-                        if (isLightSquare)
-                            whiteHasLightBishop = true;
-                        else
-                            whiteHasDarkBishop = true;
-                    }
-                    else if (type == 'Q')
-                        whiteQueens++;
-                }
-                else
-                {
-                    if (type == 'P')
-                        blackPawns++;
-                    else if (type == 'R')
-                        blackRooks++;
-                    else if (type == 'N')
-                        blackKnights++;
-                    else if (type == 'B')
-                    {
-                        blackBishops++;
-                        if (isLightSquare)
-                            blackHasLightBishop = true;
-                        else
-                            blackHasDarkBishop = true;
-                    }
-                    else if (type == 'Q')
-                        blackQueens++;
-                }
-            }
-        }
-    }
-
-    // If either side has pawns, rooks, or queens, there is sufficient material
-    if (whitePawns > 0 || blackPawns > 0 ||
-        whiteRooks > 0 || blackRooks > 0 ||
-        whiteQueens > 0 || blackQueens > 0)
-    {
-        return false;
-    }
-
-    // Count total minor pieces (knights + bishops) for each side
-    int whiteMinorPieces = whiteKnights + whiteBishops;
-    int blackMinorPieces = blackKnights + blackBishops;
-
-    // King vs King - insufficient material
-    if (whiteMinorPieces == 0 && blackMinorPieces == 0)
-    {
-        return true;
-    }
-
-    // King + one minor piece vs King - insufficient material
-    if ((whiteMinorPieces == 0 && blackMinorPieces == 1) ||
-        (whiteMinorPieces == 1 && blackMinorPieces == 0))
-    {
-        return true;
-    }
-
-    // King + two knights vs King - insufficient material (2 knights cannot force mate)
-    if ((whiteMinorPieces == 0 && blackKnights == 2 && blackBishops == 0) ||
-        (blackMinorPieces == 0 && whiteKnights == 2 && whiteBishops == 0))
-    {
-        return true;
-    }
-
-    // King + bishop vs King + bishop - insufficient material only if same-color bishops
-    if (whiteMinorPieces == 1 && blackMinorPieces == 1 &&
-        whiteBishops == 1 && blackBishops == 1 && whiteKnights == 0 && blackKnights == 0)
-    {
-        // Check if both bishops are on same color squares
-        bool whiteOnLight = whiteHasLightBishop;
-        bool blackOnLight = blackHasLightBishop;
-        if (whiteOnLight == blackOnLight)
-        {
-            return true; // Same-color bishops cannot force mate
-        }
-        // Opposite-color bishops can force mate, so not insufficient material
-    }
-
-    // King + knight vs King + knight - insufficient material
-    if (whiteMinorPieces == 1 && blackMinorPieces == 1 &&
-        whiteKnights == 1 && blackKnights == 1 && whiteBishops == 0 && blackBishops == 0)
-    {
-        return true;
-    }
-
-    // King + bishop vs King + knight - insufficient material
-    if ((whiteMinorPieces == 1 && blackMinorPieces == 1) &&
-        ((whiteBishops == 1 && blackKnights == 1) || (whiteKnights == 1 && blackBishops == 1)))
-    {
-        return true;
-    }
-
-    // All other combinations have sufficient material
-    return false;
+    // Insufficient material: neither side can force checkmate. Decided from
+    // the incrementally kept material key, without looking at the squares.
+    return isInsufficientMaterial(pos.board.materialKey());
 }
 
 // Get current game state
@@ -933,22 +606,22 @@ GameState ChessBoard::getGameState()
     return gameState;
 }
 
-// Update game state based on current position
-void ChessBoard::updateGameState()
+// Update game state after a move. inCheck tells whether the side now to move
+// is in check, as found by givesCheck() before the move was played; the side
+// that just moved can never be in check.
+void ChessBoard::updateGameState(bool inCheck)
 {
-    if (isCheckmate(WHITE))
-    {
-        gameState = GAME_CHECKMATE_WHITE;
-    }
-    else if (isCheckmate(BLACK))
+    PERF_SCOPE(PERF_UPDATE_GAME_STATE);
+    bool canMove = hasAnyValidMove(pos.sideToMove);
+    if (!canMove && inCheck)
     {
-        gameState = GAME_CHECKMATE_BLACK;
+        gameState = (pos.sideToMove == WHITE) ? GAME_CHECKMATE_WHITE : GAME_CHECKMATE_BLACK;
     }
-    else if (isStalemate(currentTurn))
+    else if (!canMove)
     {
         gameState = GAME_STALEMATE;
     }
-    else if (isDraw())
+    else if (isDrawByRule())
     {
         gameState = GAME_DRAW;
     }
@@ -961,136 +634,178 @@ void ChessBoard::updateGameState()
 // Get current turn
 PieceColor ChessBoard::getCurrentTurn()
 {
-    return currentTurn;
+    return pos.sideToMove;
 }
 
 // Set current turn
 void ChessBoard::setCurrentTurn(PieceColor color)
 {
-    currentTurn = color;
+    pos.sideToMove = color;
+    storeSynced = false;
+}
+
+const BoardBackend &ChessBoard::getBackend()
+{
+    return pos.board;
+}
+
+bool ChessBoard::hasCastlingRight(PieceColor color, bool kingSide)
+{
+    return (pos.castlingRights & castlingRight(color, kingSide)) != 0;
 }
 
 // Add move to history (stores last 3 moves from each side = 6 total)
-void ChessBoard::addToHistory(int fromRow, char fromCol, int toRow, char toCol)
+void ChessBoard::addToHistory(Move move)
 {
-    // If we have 6 moves, shift array left to make room for new move
-    if (moveCount >= 6)
+    // If the history is full, shift left to make room for the new move
+    if (moveCount >= MOVE_HISTORY_SIZE)
     {
         // Shift all moves left by one position (remove oldest)
-        for (int i = 0; i < 5; i++)
+        for (int i = 0; i < MOVE_HISTORY_SIZE - 1; i++)
         {
             moveHistory[i] = moveHistory[i + 1];
         }
-        moveCount = 5; // Will be incremented to 6 after adding new move
+        moveCount = MOVE_HISTORY_SIZE - 1; // Will be incremented after adding the new move
     }
 
     // Add new move at the end
-    moveHistory[moveCount].fromRow = fromRow;
-    moveHistory[moveCount].fromCol = fromCol;
-    moveHistory[moveCount].toRow = toRow;
-    moveHistory[moveCount].toCol = toCol;
+    moveHistory[moveCount] = move;
     moveCount++;
 }
 
 // Clear the board and reset game state
 void ChessBoard::clearBoard()
 {
-    // Delete all pieces on the board
-    for (int r = 1; r <= 8; r++)
-    {
-        for (char c = 'A'; c <= 'H'; c++)
-        {
-            Piece *p = getPiece(r, c);
-            if (p != nullptr)
-            {
-                delete p;
-                board[rowToIndex(r)][colToIndex(c)] = nullptr;
-            }
-        }
-    }
+    pos.clear();
+#if SMARTCHESS_ATTACK_MAPS
+    attacks.clear();
+#endif
 
     // Reset game state
-    currentTurn = WHITE;
     gameState = GAME_ACTIVE;
     moveCount = 0;
-    halfMoveClock = 0;
     positionCount = 0;
-    lastMove.piece = nullptr;
+    storeSynced = false;
+    dirtySquares = ~0ULL;
 }
 
 void ChessBoard::initializeStandardGame()
 {
     clearBoard();
+    pos.setStartPosition();
+#if SMARTCHESS_ATTACK_MAPS
+    attacks.rebuild(pos.board);
+#endif
+
+    storeBoardState();
+    syncStore();
+    Serial.println("Standard chess game initialized!");
+}
+
+const Position &ChessBoard::getPosition()
+{
+    return pos;
+}
+
+// Continue from a snapshot (e.g. one taken with getPosition()). The move and
+// repetition histories restart from this position.
+void ChessBoard::setPosition(const Position &position)
+{
+    pos = position;
+    dirtySquares = ~0ULL;
+#if SMARTCHESS_ATTACK_MAPS
+    attacks.rebuild(pos.board);
+#endif
+    moveCount = 0;
+    positionCount = 0;
+    storeBoardState();
+    syncStore();
+    updateGameState(pos.inCheck());
+}
 
-    // White Pieces
-    placePiece(new Rook(WHITE), 1, 'A');
-    placePiece(new Knight(WHITE), 1, 'B');
-    placePiece(new Bishop(WHITE), 1, 'C');
-    placePiece(new Queen(WHITE), 1, 'D');
-    placePiece(new King(WHITE), 1, 'E');
-    placePiece(new Bishop(WHITE), 1, 'F');
-    placePiece(new Knight(WHITE), 1, 'G');
-    placePiece(new Rook(WHITE), 1, 'H');
-
-    // White Pawns
-    for (char c = 'A'; c <= 'H'; c++)
+Move ChessBoard::getLastMove()
+{
+    return moveCount ? moveHistory[moveCount - 1] : NO_MOVE;
+}
+
+uint64_t ChessBoard::takeDirtySquares()
+{
+    uint64_t squares = dirtySquares;
+    dirtySquares = 0;
+    return squares;
+}
+
+void ChessBoard::attachStore(GameStore *gameStore)
+{
+    store = gameStore;
+    storeSynced = false; // the next move (or new game) writes a fresh header
+}
+
+// Start the stored log afresh from the current position
+void ChessBoard::syncStore()
+{
+    if (store)
     {
-        placePiece(new Pawn(WHITE), 2, c);
+        store->startGame(pos);
+        storeSynced = true;
     }
+}
 
-    // Black Pieces
-    placePiece(new Rook(BLACK), 8, 'A');
-    placePiece(new Knight(BLACK), 8, 'B');
-    placePiece(new Bishop(BLACK), 8, 'C');
-    placePiece(new Queen(BLACK), 8, 'D');
-    placePiece(new King(BLACK), 8, 'E');
-    placePiece(new Bishop(BLACK), 8, 'F');
-    placePiece(new Knight(BLACK), 8, 'G');
-    placePiece(new Rook(BLACK), 8, 'H');
-
-    // Black Pawns
-    for (char c = 'A'; c <= 'H'; c++)
+// Continue the game kept in gameStore. The logged moves were validated when
+// they were first played, so they are replayed with a bare makeMove(); that
+// also rebuilds the repetition history. The store stays attached.
+bool ChessBoard::resume(GameStore &gameStore)
+{
+    Position start;
+    if (!gameStore.load(start))
     {
-        placePiece(new Pawn(BLACK), 7, c);
+        return false;
     }
 
+    clearBoard();
+    pos = start;
     storeBoardState();
-    Serial.println("Standard chess game initialized!");
+    uint16_t count = gameStore.moveCount();
+    uint16_t replayed = 0;
+    for (; replayed < count; replayed++)
+    {
+        // A damaged log ends at the first move that doesn't fit
+        Move move = gameStore.moveAt(replayed);
+        if (!isPseudoLegal(pos.board, pos.sideToMove, pos.castlingRights, pos.epSquare, move))
+        {
+            break;
+        }
+        pos.makeMove(move);
+        addToHistory(move);
+        storeBoardState();
+    }
+#if SMARTCHESS_ATTACK_MAPS
+    attacks.rebuild(pos.board);
+#endif
+
+    store = &gameStore;
+    storeSynced = replayed == count;
+    updateGameState(pos.inCheck());
+    return true;
 }
 
-void ChessBoard::promotePawn(int row, char col, PromotionType promoteChoice, PieceColor color)
+void ChessBoard::promotePawn(Square sq, PromotionType promoteChoice, PieceColor color)
 {
-    Piece *pawn = getPiece(row, col);
-    if (!pawn || pawn->getTypeName()[0] != 'P')
+    PieceCode pawn = pos.board.pieceAt(sq);
+    if (pawn == NO_PIECE || pieceType(pawn) != PAWN)
     {
         Serial.println("No pawn to promote on this square!");
         return;
     }
+    if (!hasRoomFor(makePiece(promotionPieceType(promoteChoice), color), sq))
+        return;
 
-    removePiece(row, col);
-
-    Piece *newPiece = nullptr;
-    switch (promoteChoice)
-    {
-    case PROMOTE_QUEEN:
-        newPiece = new Queen(color);
-        break;
-    case PROMOTE_ROOK:
-        newPiece = new Rook(color);
-        break;
-    case PROMOTE_BISHOP:
-        newPiece = new Bishop(color);
-        break;
-    case PROMOTE_KNIGHT:
-        newPiece = new Knight(color);
-        break;
-    }
+    removePiece(sq);
 
-    if (newPiece)
-    {
-        placePiece(newPiece, row, col);
-        Serial.print("Pawn promoted to ");
-        Serial.print(newPiece->getTypeName());
-        Serial.println();
-    }
-}
\ No newline at end of file
+    PieceCode newPiece = makePiece(promotionPieceType(promoteChoice), color);
+    putSquare(sq, newPiece);
+    storeSynced = false;
+    Serial.print("Pawn promoted to ");
+    Serial.print(pieceObjects[newPiece]->getTypeName());
+    Serial.println();
+}
@@ -3,6 +3,11 @@
 
 #include <Arduino.h>
 #include "Piece.h"
+#include "ChessTypes.h"
+#include "BoardBackend.h"
+#include "Position.h"
+#include "AttackMap.h"
+#include "GameStore.h"
 
 enum GameState
 {
@@ -13,41 +18,15 @@ enum GameState
   GAME_DRAW
 };
 
-enum PromotionType
-{
-  PROMOTE_QUEEN,
-  PROMOTE_ROOK,
-  PROMOTE_BISHOP,
-  PROMOTE_KNIGHT
-};
-
-struct LastMove
-{
-  Piece *piece;
-  int fromRow;
-  char fromCol;
-  int toRow;
-  char toCol;
-};
-
-struct MoveHistory
-{
-  int fromRow;
-  char fromCol;
-  int toRow;
-  char toCol;
-  PieceType capturedType;
-  PieceColor capturedColor;
-  bool kingMoved;
-  bool rookMoved;
-  char rookCol;
-};
+#define POSITION_HISTORY_SIZE 12
+#define MOVE_HISTORY_SIZE 6
 
+// Squares are dense indices (Square, 0 = A1 .. 63 = H8) throughout. Every
+// call also has a (row, column) form taking row 1-8 and column 'A'-'H', as
+// used by the sketch; those are inline adapters onto the Square versions.
 class ChessBoard
 {
 
-  LastMove lastMove;
-
 public:
   ChessBoard();
 
@@ -55,60 +34,139 @@ public:
   void initializeStandardGame(); // Sets up standard chess starting position
   void clearBoard();             // Clears the board and resets game state
 
-  void placePiece(Piece *piece, int row, char col);
-  void removePiece(int row, char col);
-  bool movePiece(int fromRow, char fromCol, int toRow, char toCol);
-  bool movePiece(int fromRow, char fromCol, int toRow, char toCol, PromotionType promotionChoice); // With promotion choice
-  void captureAndPlace(Piece *piece, int row, char col);
-  bool isSquareAttacked(int row, char col, PieceColor attackerColor);
-
-  Piece *getPiece(int row, char col);
+  // The board takes ownership of piece (it is freed right away: squares only
+  // store compact piece codes). False, and the board unchanged, if that
+  // side already has MAX_PIECES_PER_SIDE pieces.
+  bool placePiece(Piece *piece, Square sq);
+  bool placePiece(PieceType type, PieceColor color, Square sq);
+  void removePiece(Square sq);
+  bool movePiece(Square from, Square to, PromotionType promotionChoice = PROMOTE_QUEEN);
+  bool movePiece(Move move); // e.g. one from generateMoves(); flags are recomputed
+  bool captureAndPlace(Piece *piece, Square sq);
+  bool isSquareAttacked(Square sq, PieceColor attackerColor); // O(1) with attack maps
+  uint8_t getAttackerCount(Square sq, PieceColor attackerColor);
+  uint8_t getThreatRank(int row, PieceColor attackerColor); // Bit n set: column 'A' + n attacked
+
+  // Returns a shared, read-only object describing the piece on the square
+  Piece *getPiece(Square sq);
   void printBoard();
-  void promotePawn(int row, char col, PromotionType promoteChoice, PieceColor color);
+  void promotePawn(Square sq, PromotionType promoteChoice, PieceColor color);
 
   // Game state methods
   bool isInCheck(PieceColor color);
   bool isCheckmate(PieceColor color);
   bool isStalemate(PieceColor color);
   bool isDraw();
+  bool givesCheck(Square from, Square to, PromotionType promotionChoice = PROMOTE_QUEEN); // Before the move is made
   GameState getGameState();
   PieceColor getCurrentTurn();
   void setCurrentTurn(PieceColor color);
+  bool hasCastlingRight(PieceColor color, bool kingSide);
+  const BoardBackend &getBackend(); // Square storage, for per-colour piece iteration
+  const Position &getPosition();    // Plain-value snapshot: copy it to analyse without touching the game
+  void setPosition(const Position &position);
+  Move getLastMove(); // with its flags; NO_MOVE if none since the game or position was set
+
+  // Squares whose contents changed since the last call, bit sq set: the
+  // moves' from and to squares, pawns taken en passant, castling rooks and
+  // hand edits; all 64 after clearBoard(), setPosition() or resume(). Lets a
+  // display redraw only those (see LedFrame.h).
+  uint64_t takeDirtySquares();
+
+  // Persistence: with a store attached every accepted move is logged, and
+  // resume() picks the stored game up again after a power cut
+  void attachStore(GameStore *gameStore);
+  bool resume(GameStore &gameStore); // false if nothing is stored; true for a finished game too
 
   // Helper methods
-  bool findKing(PieceColor color, int &row, char &col);
-  bool isPathClear(int fromRow, char fromCol, int toRow, char toCol);
-  bool isMoveLegal(int fromRow, char fromCol, int toRow, char toCol);
+  Square kingSquare(PieceColor color); // NO_SQUARE if that side has no king
+  bool isPathClear(Square from, Square to);
+  bool isMoveLegal(Square from, Square to);
   bool hasAnyValidMove(PieceColor color);
   int countMoveRepetitions();
 
+  // (row, column) adapters
+  bool placePiece(Piece *piece, int row, char col) { return placePiece(piece, makeSquare(row, col)); }
+  bool placePiece(PieceType type, PieceColor color, int row, char col)
+  {
+    return placePiece(type, color, makeSquare(row, col));
+  }
+  void removePiece(int row, char col) { removePiece(makeSquare(row, col)); }
+  bool movePiece(int fromRow, char fromCol, int toRow, char toCol)
+  {
+    return movePiece(makeSquare(fromRow, fromCol), makeSquare(toRow, toCol));
+  }
+  bool movePiece(int fromRow, char fromCol, int toRow, char toCol, PromotionType promotionChoice) // With promotion choice
+  {
+    return movePiece(makeSquare(fromRow, fromCol), makeSquare(toRow, toCol), promotionChoice);
+  }
+  bool captureAndPlace(Piece *piece, int row, char col) { return captureAndPlace(piece, makeSquare(row, col)); }
+  bool isSquareAttacked(int row, char col, PieceColor attackerColor)
+  {
+    return isSquareAttacked(makeSquare(row, col), attackerColor);
+  }
+  uint8_t getAttackerCount(int row, char col, PieceColor attackerColor)
+  {
+    return getAttackerCount(makeSquare(row, col), attackerColor);
+  }
+  Piece *getPiece(int row, char col) { return getPiece(makeSquare(row, col)); }
+  void promotePawn(int row, char col, PromotionType promoteChoice, PieceColor color)
+  {
+    promotePawn(makeSquare(row, col), promoteChoice, color);
+  }
+  bool givesCheck(int fromRow, char fromCol, int toRow, char toCol, PromotionType promotionChoice = PROMOTE_QUEEN)
+  {
+    return givesCheck(makeSquare(fromRow, fromCol), makeSquare(toRow, toCol), promotionChoice);
+  }
+  bool findKing(PieceColor color, int &row, char &col);
+  bool isPathClear(int fromRow, char fromCol, int toRow, char toCol)
+  {
+    return isPathClear(makeSquare(fromRow, fromCol), makeSquare(toRow, toCol));
+  }
+  bool isMoveLegal(int fromRow, char fromCol, int toRow, char toCol)
+  {
+    return isMoveLegal(makeSquare(fromRow, fromCol), makeSquare(toRow, toCol));
+  }
+
 private:
-  Piece *board[8][8];
-  PieceColor currentTurn;
+  Position pos; // Squares, turn, castling rights, en passant and clocks
+#if SMARTCHESS_ATTACK_MAPS
+  AttackMap attacks;
+#endif
   GameState gameState;
-  MoveHistory moveHistory[6]; // Store last 3 moves from each side (6 total)
-  int moveCount;              // Current number of moves stored (max 6)
-  int halfMoveClock;          // For 50-move rule
+  Move moveHistory[MOVE_HISTORY_SIZE]; // Last 3 moves from each side
+  int moveCount;                       // Current number of moves stored
 
-  // Board state storage for repetition detection
-  // Store compact representation of board state (piece positions)
-  struct BoardState
-  {
-    char state[64];  // 8x8 board, each char represents a piece: ' '=empty, 'P'=pawn, etc.
-    PieceColor turn; // Whose turn it was
-  };
-  BoardState positionHistory[6]; // Store last 6 positions (for threefold repetition check)
+  // Keys of the last positions, for threefold repetition detection. 12
+  // entries see a position recur three times 4 plies apart.
+  HashKey positionHistory[POSITION_HISTORY_SIZE];
   int positionCount;
 
-  int rowToIndex(int row);
-  int colToIndex(char col);
-  char indexToCol(int index);
-  int indexToRow(int index);
-  void addToHistory(int fromRow, char fromCol, int toRow, char toCol);
-  void storeBoardState(); // Store current position for repetition detection
-  bool compareBoardStates(const BoardState &state1, const BoardState &state2);
-  void updateGameState();
-  bool wouldMoveLeaveKingInCheck(int fromRow, char fromCol, int toRow, char toCol, PieceColor color);
+  GameStore *store; // null if the game isn't persisted
+  bool storeSynced; // false after hand edits: the log no longer leads to pos
+  uint64_t dirtySquares; // changed since takeDirtySquares()
+
+  bool hasRoomFor(PieceCode piece, Square sq);
+  bool putSquare(Square sq, PieceCode piece);
+  void clearSquare(Square sq);
+  PieceCode playMove(Move move);
+  bool squareAttacked(Square sq, PieceColor attackerColor);
+  Move buildMove(Square from, Square to, PromotionType promotionChoice);
+  void addToHistory(Move move);
+  void storeBoardState(); // Store current position key for repetition detection
+  void updateGameState(bool inCheck);
+  bool isDrawByRule();
+  void syncStore();
 };
 
+inline bool ChessBoard::findKing(PieceColor color, int &row, char &col)
+{
+  Square sq = kingSquare(color);
+  if (sq == NO_SQUARE)
+    return false;
+  row = squareRow(sq);
+  col = squareCol(sq);
+  return true;
+}
+
 #endif
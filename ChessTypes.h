@@ -0,0 +1,95 @@
+#ifndef CHESSTYPES_H
+#define CHESSTYPES_H
+
+#include <Arduino.h>
+#include "Piece.h"
+
+// Dense square index: 0 = A1, 7 = H1, 56 = A8, 63 = H8
+typedef uint8_t Square;
+#define NO_SQUARE 64
+
+inline Square makeSquare(int row, char col) { return (Square)((row - 1) * 8 + (col - 'A')); }
+inline int squareRow(Square sq) { return (sq >> 3) + 1; }
+inline char squareCol(Square sq) { return 'A' + (sq & 7); }
+
+// Compact piece code as stored on the board: 0 = empty, PieceType + 1 in
+// the low three bits, colour in bit 3. Always fits in a nibble.
+typedef uint8_t PieceCode;
+#define NO_PIECE 0
+
+inline PieceCode makePiece(PieceType type, PieceColor color) { return (PieceCode)((color << 3) | (type + 1)); }
+inline PieceType pieceType(PieceCode piece) { return (PieceType)((piece & 7) - 1); }
+inline PieceColor pieceColor(PieceCode piece) { return (PieceColor)(piece >> 3); }
+inline PieceColor opponent(PieceColor color) { return (PieceColor)(color ^ 1); }
+inline int8_t pawnDirection(PieceColor color) { return 1 - 2 * color; } // +1 rank for white, -1 for black
+
+enum PromotionType
+{
+  PROMOTE_QUEEN,
+  PROMOTE_ROOK,
+  PROMOTE_BISHOP,
+  PROMOTE_KNIGHT
+};
+
+inline PieceType promotionPieceType(PromotionType promotion)
+{
+  return promotion == PROMOTE_ROOK     ? ROOK
+         : promotion == PROMOTE_BISHOP ? BISHOP
+         : promotion == PROMOTE_KNIGHT ? KNIGHT
+                                       : QUEEN;
+}
+
+enum CastlingRight
+{
+  CASTLE_WHITE_KINGSIDE = 1,
+  CASTLE_WHITE_QUEENSIDE = 2,
+  CASTLE_BLACK_KINGSIDE = 4,
+  CASTLE_BLACK_QUEENSIDE = 8
+};
+
+inline uint8_t castlingRight(PieceColor color, bool kingSide)
+{
+  return (kingSide ? CASTLE_WHITE_KINGSIDE : CASTLE_WHITE_QUEENSIDE) << (2 * color);
+}
+
+// Everything that differs between the two sides, as compile-time constants.
+// Code templated on the side to move reads these instead of testing the
+// colour at run time; the generic entry points pick the instantiation once.
+template <PieceColor Us>
+struct Side
+{
+  static constexpr PieceColor them = Us == WHITE ? BLACK : WHITE;
+  static constexpr int8_t up = Us == WHITE ? 8 : -8;       // one rank forward, dense index
+  static constexpr int8_t up88 = Us == WHITE ? 16 : -16;   // the same in 0x88
+  static constexpr uint8_t pawnRank = Us == WHITE ? 1 : 6; // pawns' home rank (0-based)
+  static constexpr uint8_t lastRank = Us == WHITE ? 7 : 0; // pawns promote on reaching it
+  static constexpr uint8_t seventhRank = Us == WHITE ? 6 : 1;
+  static constexpr Square kingHome = Us == WHITE ? 4 : 60;
+  static constexpr uint8_t kingSide = Us == WHITE ? CASTLE_WHITE_KINGSIDE : CASTLE_BLACK_KINGSIDE;
+  static constexpr uint8_t queenSide = Us == WHITE ? CASTLE_WHITE_QUEENSIDE : CASTLE_BLACK_QUEENSIDE;
+  static constexpr uint8_t pawnAttackBit = Us == WHITE ? 0x01 : 0x40; // see Geometry.h
+};
+
+// Move packed into 16 bits: from (bits 0-5), to (6-11), promotion (12-13),
+// flag (14-15)
+typedef uint16_t Move;
+#define NO_MOVE 0
+
+enum MoveFlag
+{
+  MOVE_NORMAL,
+  MOVE_PROMOTION,
+  MOVE_EN_PASSANT,
+  MOVE_CASTLING
+};
+
+inline Move makeMove(Square from, Square to, MoveFlag flag = MOVE_NORMAL, PromotionType promotion = PROMOTE_QUEEN)
+{
+  return (Move)(from | (to << 6) | (promotion << 12) | (flag << 14));
+}
+inline Square moveFrom(Move m) { return m & 63; }
+inline Square moveTo(Move m) { return (m >> 6) & 63; }
+inline PromotionType movePromotion(Move m) { return (PromotionType)((m >> 12) & 3); }
+inline MoveFlag moveFlag(Move m) { return (MoveFlag)(m >> 14); }
+
+#endif
@@ -0,0 +1,378 @@
+#include "Endgame.h"
+#include "ChessBoard.h"
+#include <Arduino.h>
+
+// Ordering used to decide which side is "stronger" and to sort pieces
+// (indexed by PieceType: PAWN, ROOK, KNIGHT, BISHOP, QUEEN, KING)
+static const uint8_t pieceStrength[6] = {1, 4, 2, 3, 5, 6};
+
+// Index of the a1-d1-d4 triangle squares for pawnless tables, 0xFF elsewhere
+static const uint8_t triangleIndex[64] PROGMEM = {
+    0, 1, 2, 3, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 4, 5, 6, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 7, 8, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 9, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+static uint32_t readLE32(const uint8_t *buf)
+{
+    return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+static uint8_t transposeSquare(uint8_t sq)
+{
+    return ((sq & 7) << 3) | (sq >> 3);
+}
+
+// Insert piece index i into list (strongest first)
+static void insertByStrength(uint8_t *list, uint8_t &n, const uint8_t *pieces, uint8_t i)
+{
+    uint8_t pos = n;
+    while (pos > 0 && pieceStrength[egtbPieceType(pieces[list[pos - 1]])] < pieceStrength[egtbPieceType(pieces[i])])
+    {
+        list[pos] = list[pos - 1];
+        pos--;
+    }
+    list[pos] = i;
+    n++;
+}
+
+// Identical pieces are interchangeable; keep them ordered by square
+static void sortIdenticalPieces(EgtbPosition &pos)
+{
+    for (uint8_t i = 3; i < pos.count; i++)
+    {
+        for (uint8_t j = i; j > 2 && pos.pieces[j] == pos.pieces[j - 1] && pos.squares[j] < pos.squares[j - 1]; j--)
+        {
+            uint8_t tmp = pos.squares[j];
+            pos.squares[j] = pos.squares[j - 1];
+            pos.squares[j - 1] = tmp;
+        }
+    }
+}
+
+bool egtbHasPawns(const EgtbPosition &pos)
+{
+    for (uint8_t i = 2; i < pos.count; i++)
+    {
+        if (egtbPieceType(pos.pieces[i]) == PAWN)
+            return true;
+    }
+    return false;
+}
+
+bool egtbCanonicalize(const uint8_t *pieces, const uint8_t *squares, uint8_t count,
+                      PieceColor sideToMove, EgtbPosition &out)
+{
+    if (count < 2 || count > EGTB_MAX_PIECES)
+        return false;
+
+    // Split by colour, strongest piece first
+    int8_t king[2] = {-1, -1};
+    uint8_t side[2][EGTB_MAX_PIECES];
+    uint8_t sideCount[2] = {0, 0};
+    for (uint8_t i = 0; i < count; i++)
+    {
+        PieceColor color = egtbPieceColor(pieces[i]);
+        if (egtbPieceType(pieces[i]) == KING)
+        {
+            if (king[color] >= 0)
+                return false;
+            king[color] = i;
+        }
+        else
+        {
+            insertByStrength(side[color], sideCount[color], pieces, i);
+        }
+    }
+    if (king[WHITE] < 0 || king[BLACK] < 0)
+        return false;
+
+    // Black is stored as white if it has more material
+    bool flip = false;
+    for (uint8_t k = 0;; k++)
+    {
+        if (k >= sideCount[WHITE] || k >= sideCount[BLACK])
+        {
+            flip = sideCount[BLACK] > sideCount[WHITE];
+            break;
+        }
+        uint8_t ws = pieceStrength[egtbPieceType(pieces[side[WHITE][k]])];
+        uint8_t bs = pieceStrength[egtbPieceType(pieces[side[BLACK][k]])];
+        if (ws != bs)
+        {
+            flip = bs > ws;
+            break;
+        }
+    }
+
+    PieceColor strong = flip ? BLACK : WHITE;
+    PieceColor weak = flip ? WHITE : BLACK;
+    uint8_t mirror = flip ? 56 : 0;
+
+    out.count = count;
+    out.sideToMove = flip ? (sideToMove == WHITE ? BLACK : WHITE) : sideToMove;
+    out.pieces[0] = egtbPiece(KING, WHITE);
+    out.squares[0] = squares[king[strong]] ^ mirror;
+    out.pieces[1] = egtbPiece(KING, BLACK);
+    out.squares[1] = squares[king[weak]] ^ mirror;
+    uint8_t n = 2;
+    for (uint8_t k = 0; k < sideCount[strong]; k++, n++)
+    {
+        out.pieces[n] = egtbPiece(egtbPieceType(pieces[side[strong][k]]), WHITE);
+        out.squares[n] = squares[side[strong][k]] ^ mirror;
+    }
+    for (uint8_t k = 0; k < sideCount[weak]; k++, n++)
+    {
+        out.pieces[n] = egtbPiece(egtbPieceType(pieces[side[weak][k]]), BLACK);
+        out.squares[n] = squares[side[weak][k]] ^ mirror;
+    }
+
+    // Board symmetry: white king on files A-D, and for pawnless endings
+    // inside the a1-d1-d4 triangle
+    bool pawns = egtbHasPawns(out);
+    uint8_t transform = 0;
+    if ((out.squares[0] & 7) >= 4)
+        transform |= 7;
+    if (!pawns && (out.squares[0] >> 3) >= 4)
+        transform |= 56;
+    for (uint8_t i = 0; i < count; i++)
+        out.squares[i] ^= transform;
+
+    if (!pawns && (out.squares[0] >> 3) > (out.squares[0] & 7))
+    {
+        for (uint8_t i = 0; i < count; i++)
+            out.squares[i] = transposeSquare(out.squares[i]);
+    }
+    sortIdenticalPieces(out);
+
+    // King on the diagonal: the transposed position is equally canonical,
+    // keep whichever indexes lower so every position has one entry
+    if (!pawns && (out.squares[0] >> 3) == (out.squares[0] & 7))
+    {
+        EgtbPosition alt = out;
+        for (uint8_t i = 0; i < count; i++)
+            alt.squares[i] = transposeSquare(alt.squares[i]);
+        sortIdenticalPieces(alt);
+        if (egtbIndex(alt) < egtbIndex(out))
+            out = alt;
+    }
+    return true;
+}
+
+uint32_t egtbIndex(const EgtbPosition &pos)
+{
+    uint8_t king = pos.squares[0];
+    uint32_t index = egtbHasPawns(pos) ? (uint32_t)((king >> 3) * 4 + (king & 7))
+                                       : (uint32_t)pgm_read_byte(&triangleIndex[king]);
+    for (uint8_t i = 1; i < pos.count; i++)
+    {
+        index = (index << 6) | pos.squares[i];
+    }
+    return index;
+}
+
+uint32_t egtbEntryCount(uint8_t count, bool pawns)
+{
+    return (uint32_t)(pawns ? 32 : 10) << (6 * (count - 1));
+}
+
+bool egtbIsTrivialDraw(const EgtbPosition &pos)
+{
+    if (pos.count == 2)
+        return true;
+    if (pos.count == 3)
+    {
+        PieceType type = egtbPieceType(pos.pieces[2]);
+        return type == BISHOP || type == KNIGHT;
+    }
+    return false;
+}
+
+EndgameTables::EndgameTables()
+{
+    reader = nullptr;
+    tableCount = 0;
+}
+
+bool EndgameTables::begin(EgtbReadFn readFn, uint32_t imageOffset)
+{
+    reader = readFn;
+    tableCount = 0;
+
+    uint8_t dir[8];
+    if (!reader || !reader(imageOffset, dir, 8) || readLE32(dir) != EGTB_IMAGE_MAGIC)
+    {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < dir[4]; i++)
+    {
+        uint8_t buf[4];
+        if (!reader(imageOffset + 8 + 4 * (uint32_t)i, buf, 4))
+            return false;
+        if (!addTable(imageOffset + readLE32(buf)))
+            return false;
+    }
+    return true;
+}
+
+bool EndgameTables::addTable(uint32_t offset)
+{
+    if (!reader || tableCount >= EGTB_MAX_TABLES)
+        return false;
+
+    uint8_t header[EGTB_HEADER_SIZE];
+    if (!reader(offset, header, EGTB_HEADER_SIZE))
+        return false;
+    if (readLE32(header) != EGTB_TABLE_MAGIC || header[4] != EGTB_VERSION ||
+        header[5] < 3 || header[5] > EGTB_MAX_PIECES || header[6] > 16)
+    {
+        Serial.println("Invalid endgame table header!");
+        return false;
+    }
+
+    Table &t = tables[tableCount++];
+    t.offset = offset;
+    t.count = header[5];
+    t.dtmBits = header[6];
+    t.material = 0;
+    for (uint8_t i = 0; i < EGTB_MAX_PIECES; i++)
+    {
+        t.pieces[i] = header[8 + i];
+        if (i < t.count)
+            t.material += materialDelta(makePiece(egtbPieceType(t.pieces[i]), egtbPieceColor(t.pieces[i])), 0);
+    }
+    t.material &= MATERIAL_COUNT_MASK;
+    t.entries = readLE32(header + 12);
+    return true;
+}
+
+EndgameTables::Table *EndgameTables::findTable(const EgtbPosition &pos)
+{
+    for (uint8_t t = 0; t < tableCount; t++)
+    {
+        if (tables[t].count != pos.count)
+            continue;
+        bool match = true;
+        for (uint8_t i = 0; i < pos.count && match; i++)
+        {
+            match = tables[t].pieces[i] == pos.pieces[i];
+        }
+        if (match)
+            return &tables[t];
+    }
+    return nullptr;
+}
+
+static uint8_t materialPieceCount(MaterialKey material)
+{
+    material &= MATERIAL_COUNT_MASK;
+    uint8_t count = 0;
+    for (; material; material >>= 4)
+    {
+        count += material & 0x0F;
+    }
+    return count;
+}
+
+// Dispatch on material: either colour may hold the stronger side
+bool EndgameTables::hasTableFor(MaterialKey material)
+{
+    material &= MATERIAL_COUNT_MASK;
+    MaterialKey mirrored = mirrorMaterial(material);
+    for (uint8_t t = 0; t < tableCount; t++)
+    {
+        if (tables[t].material == material || tables[t].material == mirrored)
+            return true;
+    }
+    return false;
+}
+
+bool EndgameTables::readBits(uint32_t base, uint32_t bitOffset, uint8_t width, uint16_t &value)
+{
+    uint8_t buf[3] = {0, 0, 0};
+    uint8_t shift = bitOffset & 7;
+    uint8_t len = (shift + width + 7) / 8;
+    if (!reader(base + (bitOffset >> 3), buf, len))
+        return false;
+    uint32_t raw = (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | ((uint32_t)buf[2] << 16);
+    value = (uint16_t)((raw >> shift) & ((1UL << width) - 1));
+    return true;
+}
+
+bool EndgameTables::probe(const uint8_t *pieces, const uint8_t *squares, uint8_t count,
+                          PieceColor sideToMove, EgtbResult &result)
+{
+    EgtbPosition pos;
+    if (!egtbCanonicalize(pieces, squares, count, sideToMove, pos))
+        return false;
+
+    result.dtm = 0;
+    if (egtbIsTrivialDraw(pos))
+    {
+        result.wdl = EGTB_DRAW;
+        return true;
+    }
+
+    Table *t = findTable(pos);
+    if (!t)
+        return false;
+
+    // Both lookups are a single seek into the image
+    uint32_t entry = (uint32_t)pos.sideToMove * t->entries + egtbIndex(pos);
+    uint32_t wdlBase = t->offset + EGTB_HEADER_SIZE;
+    uint16_t wdl;
+    if (!readBits(wdlBase, entry * 2, 2, wdl))
+        return false;
+    result.wdl = (EgtbWdl)wdl;
+
+    if ((result.wdl == EGTB_WIN || result.wdl == EGTB_LOSS) && t->dtmBits == 0)
+        result.dtm = EGTB_DTM_UNKNOWN;
+    else if (result.wdl == EGTB_WIN || result.wdl == EGTB_LOSS)
+    {
+        uint32_t dtmBase = wdlBase + (2 * t->entries + 3) / 4;
+        if (!readBits(dtmBase, entry * t->dtmBits, t->dtmBits, result.dtm))
+            return false;
+    }
+    return true;
+}
+
+bool EndgameTables::probe(const Position &position, EgtbResult &result)
+{
+    uint8_t pieces[EGTB_MAX_PIECES];
+    uint8_t squares[EGTB_MAX_PIECES];
+    uint8_t count = 0;
+
+    // KK, KBK and KNK are answered without a table (see egtbIsTrivialDraw);
+    // anything else needs a table for its material
+    const BoardBackend &backend = position.board;
+    MaterialKey material = backend.materialKey();
+    if (!hasTableFor(material) && !(isInsufficientMaterial(material) && materialPieceCount(material) <= 3))
+        return false;
+
+    for (uint8_t color = WHITE; color <= BLACK; color++)
+    {
+        BoardBackend::PieceIterator it = backend.pieces((PieceColor)color);
+        Square sq;
+        while (it.next(sq))
+        {
+            if (count == EGTB_MAX_PIECES)
+                return false;
+            PieceCode p = backend.pieceAt(sq);
+            pieces[count] = egtbPiece(pieceType(p), pieceColor(p));
+            squares[count] = sq;
+            count++;
+        }
+    }
+
+    return probe(pieces, squares, count, position.sideToMove, result);
+}
+
+bool EndgameTables::probe(ChessBoard &board, EgtbResult &result)
+{
+    return probe(board.getPosition(), result);
+}
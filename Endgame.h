@@ -0,0 +1,117 @@
+#ifndef ENDGAME_H
+#define ENDGAME_H
+
+#include <Arduino.h>
+#include "Piece.h"
+#include "Material.h"
+#include "Position.h"
+
+class ChessBoard;
+
+// Endgame tables for 3- and 4-man endings (KQK, KRK, KPK, KQKR, ...).
+// The tables are produced on the host by host/egtb_gen.cpp and flashed into
+// external flash as a single image; the board only reads a few bytes per probe.
+//
+// Image layout (all integers little-endian):
+//   directory: "SCEG" magic, table count, 3 pad bytes, count x uint32 offsets
+//   table:     16-byte header, then 2-bit WDL entries, then bit-packed DTM
+// Each table stores one entry per canonical position and side to move; the
+// side with more material is always stored as white.
+
+#define EGTB_MAX_PIECES 4
+#define EGTB_IMAGE_MAGIC 0x47454353UL // "SCEG"
+#define EGTB_TABLE_MAGIC 0x42544353UL // "SCTB"
+#define EGTB_VERSION 1
+#define EGTB_HEADER_SIZE 16
+#define EGTB_NO_PIECE 0xFF
+#define EGTB_DTM_UNKNOWN 0xFFFF // a win or loss read from a WDL-only table
+
+#ifndef EGTB_MAX_TABLES
+#define EGTB_MAX_TABLES 8
+#endif
+
+enum EgtbWdl
+{
+  EGTB_DRAW = 0,
+  EGTB_WIN = 1,    // side to move wins
+  EGTB_LOSS = 2,   // side to move gets mated
+  EGTB_ILLEGAL = 3 // not a reachable/canonical position
+};
+
+struct EgtbResult
+{
+  EgtbWdl wdl;
+  uint16_t dtm; // distance to mate in plies (0 for draws, EGTB_DTM_UNKNOWN without DTM)
+};
+
+// Reads len bytes of the table image starting at offset (external flash,
+// SD card, or a file on the host). Returns false on I/O error.
+typedef bool (*EgtbReadFn)(uint32_t offset, uint8_t *buf, uint8_t len);
+
+// Table piece code: PieceType in the low 3 bits, colour in bit 3
+inline uint8_t egtbPiece(PieceType type, PieceColor color) { return (uint8_t)((color << 3) | type); }
+inline PieceType egtbPieceType(uint8_t code) { return (PieceType)(code & 7); }
+inline PieceColor egtbPieceColor(uint8_t code) { return (PieceColor)(code >> 3); }
+
+// A position reduced to the canonical form used for indexing: kings first
+// (stronger side's king, then the other one), then the stronger side's
+// pieces and the weaker side's pieces, with board symmetry applied.
+struct EgtbPosition
+{
+  uint8_t count;
+  uint8_t pieces[EGTB_MAX_PIECES];
+  uint8_t squares[EGTB_MAX_PIECES]; // 0 = A1, 7 = H1, 63 = H8
+  PieceColor sideToMove;
+};
+
+// Canonicalizes an arbitrary position. Returns false if it has no kings or
+// more than EGTB_MAX_PIECES pieces.
+bool egtbCanonicalize(const uint8_t *pieces, const uint8_t *squares, uint8_t count,
+                      PieceColor sideToMove, EgtbPosition &out);
+bool egtbHasPawns(const EgtbPosition &pos);
+uint32_t egtbIndex(const EgtbPosition &pos);
+uint32_t egtbEntryCount(uint8_t count, bool pawns);
+// True when neither side can ever mate (KK, KBK, KNK): no table is needed.
+bool egtbIsTrivialDraw(const EgtbPosition &pos);
+
+class EndgameTables
+{
+public:
+  EndgameTables();
+
+  // Reads the image directory at imageOffset and registers every table in it.
+  bool begin(EgtbReadFn reader, uint32_t imageOffset = 0);
+  // Registers a single table whose header starts at offset.
+  bool addTable(uint32_t offset);
+  uint8_t getTableCount() { return tableCount; }
+
+  bool probe(const uint8_t *pieces, const uint8_t *squares, uint8_t count,
+             PieceColor sideToMove, EgtbResult &result);
+  // Probes a position (ignores castling/en passant rights). Positions
+  // without a matching table are rejected from the material key alone, so
+  // a search can call this at every node.
+  bool probe(const Position &position, EgtbResult &result);
+  // Probes the current position of a game
+  bool probe(ChessBoard &board, EgtbResult &result);
+
+private:
+  struct Table
+  {
+    uint32_t offset;
+    uint32_t entries;
+    uint8_t pieces[EGTB_MAX_PIECES];
+    uint8_t count;
+    uint8_t dtmBits;
+    MaterialKey material; // piece counts of the stored (stronger = white) side
+  };
+
+  EgtbReadFn reader;
+  Table tables[EGTB_MAX_TABLES];
+  uint8_t tableCount;
+
+  Table *findTable(const EgtbPosition &pos);
+  bool hasTableFor(MaterialKey material);
+  bool readBits(uint32_t base, uint32_t bitOffset, uint8_t width, uint16_t &value);
+};
+
+#endif
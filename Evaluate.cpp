@@ -0,0 +1,119 @@
+#include "Evaluate.h"
+
+// White's point of view, rank 8 first as the board is printed: a white
+// piece on sq reads entry sq ^ 56, a black one entry sq.
+static const int8_t pawnTable[64] PROGMEM = {
+    0, 0, 0, 0, 0, 0, 0, 0,
+    50, 50, 50, 50, 50, 50, 50, 50,
+    10, 10, 20, 30, 30, 20, 10, 10,
+    5, 5, 10, 25, 25, 10, 5, 5,
+    0, 0, 0, 20, 20, 0, 0, 0,
+    5, -5, -10, 0, 0, -10, -5, 5,
+    5, 10, 10, -20, -20, 10, 10, 5,
+    0, 0, 0, 0, 0, 0, 0, 0};
+
+static const int8_t knightTable[64] PROGMEM = {
+    -50, -40, -30, -30, -30, -30, -40, -50,
+    -40, -20, 0, 0, 0, 0, -20, -40,
+    -30, 0, 10, 15, 15, 10, 0, -30,
+    -30, 5, 15, 20, 20, 15, 5, -30,
+    -30, 0, 15, 20, 20, 15, 0, -30,
+    -30, 5, 10, 15, 15, 10, 5, -30,
+    -40, -20, 0, 5, 5, 0, -20, -40,
+    -50, -40, -30, -30, -30, -30, -40, -50};
+
+static const int8_t bishopTable[64] PROGMEM = {
+    -20, -10, -10, -10, -10, -10, -10, -20,
+    -10, 0, 0, 0, 0, 0, 0, -10,
+    -10, 0, 5, 10, 10, 5, 0, -10,
+    -10, 5, 5, 10, 10, 5, 5, -10,
+    -10, 0, 10, 10, 10, 10, 0, -10,
+    -10, 10, 10, 10, 10, 10, 10, -10,
+    -10, 5, 0, 0, 0, 0, 5, -10,
+    -20, -10, -10, -10, -10, -10, -10, -20};
+
+static const int8_t rookTable[64] PROGMEM = {
+    0, 0, 0, 0, 0, 0, 0, 0,
+    5, 10, 10, 10, 10, 10, 10, 5,
+    -5, 0, 0, 0, 0, 0, 0, -5,
+    -5, 0, 0, 0, 0, 0, 0, -5,
+    -5, 0, 0, 0, 0, 0, 0, -5,
+    -5, 0, 0, 0, 0, 0, 0, -5,
+    -5, 0, 0, 0, 0, 0, 0, -5,
+    0, 0, 0, 5, 5, 0, 0, 0};
+
+static const int8_t queenTable[64] PROGMEM = {
+    -20, -10, -10, -5, -5, -10, -10, -20,
+    -10, 0, 0, 0, 0, 0, 0, -10,
+    -10, 0, 5, 5, 5, 5, 0, -10,
+    -5, 0, 5, 5, 5, 5, 0, -5,
+    0, 0, 5, 5, 5, 5, 0, -5,
+    -10, 5, 5, 5, 5, 5, 0, -10,
+    -10, 0, 5, 0, 0, 0, 0, -10,
+    -20, -10, -10, -5, -5, -10, -10, -20};
+
+static const int8_t kingTable[64] PROGMEM = {
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -20, -30, -30, -40, -40, -30, -30, -20,
+    -10, -20, -20, -20, -20, -20, -20, -10,
+    20, 20, 0, 0, 0, 0, 20, 20,
+    20, 30, 10, 0, 0, 10, 30, 20};
+
+static const int8_t kingEndgameTable[64] PROGMEM = {
+    -50, -40, -30, -20, -20, -30, -40, -50,
+    -30, -20, -10, 0, 0, -10, -20, -30,
+    -30, -10, 20, 30, 30, 20, -10, -30,
+    -30, -10, 30, 40, 40, 30, -10, -30,
+    -30, -10, 30, 40, 40, 30, -10, -30,
+    -30, -10, 20, 30, 30, 20, -10, -30,
+    -30, -30, 0, 0, 0, 0, -30, -30,
+    -50, -30, -30, -30, -30, -30, -30, -50};
+
+// In PieceType order
+static const int8_t *const squareTables[6] = {pawnTable, rookTable, knightTable, bishopTable, queenTable, kingTable};
+static const int16_t pieceValues[6] PROGMEM = {PAWN_VALUE, ROOK_VALUE, KNIGHT_VALUE, BISHOP_VALUE, QUEEN_VALUE, 0};
+
+// Below this much non-pawn material (both sides together) the kings come out
+#define ENDGAME_MATERIAL 1300
+
+int16_t pieceValue(PieceType type)
+{
+    return (int16_t)pgm_read_word(&pieceValues[type]);
+}
+
+int16_t evaluate(const Position &position)
+{
+    const BoardBackend &board = position.board;
+    MaterialKey material = board.materialKey();
+    if (isInsufficientMaterial(material))
+        return 0;
+
+    int16_t pieces = 0;
+    for (uint8_t color = WHITE; color <= BLACK; color++)
+    {
+        for (uint8_t type = ROOK; type <= QUEEN; type++)
+        {
+            pieces += materialCount(material, (PieceColor)color, (PieceType)type) * pieceValue((PieceType)type);
+        }
+    }
+    const int8_t *kingSquares = pieces <= ENDGAME_MATERIAL ? kingEndgameTable : kingTable;
+
+    int16_t score[2] = {0, 0};
+    for (uint8_t color = WHITE; color <= BLACK; color++)
+    {
+        BoardBackend::PieceIterator it = board.pieces((PieceColor)color);
+        Square sq;
+        while (it.next(sq))
+        {
+            PieceType type = pieceType(board.pieceAt(sq));
+            const int8_t *table = type == KING ? kingSquares : squareTables[type];
+            uint8_t entry = color == WHITE ? sq ^ 56 : sq;
+            score[color] += pieceValue(type) + (int8_t)pgm_read_byte(&table[entry]);
+        }
+    }
+    int16_t white = score[WHITE] - score[BLACK];
+    return position.sideToMove == WHITE ? white : -white;
+}
@@ -0,0 +1,21 @@
+#ifndef EVALUATE_H
+#define EVALUATE_H
+
+#include <Arduino.h>
+#include "Position.h"
+
+// Static evaluation for the board's searches: material plus one
+// piece-square table per piece type (the king switches to an endgame table
+// once little material is left). Centipawns, from the side to move's point
+// of view. Tables live in flash, 448 bytes.
+
+#define PAWN_VALUE 100
+#define KNIGHT_VALUE 320
+#define BISHOP_VALUE 330
+#define ROOK_VALUE 500
+#define QUEEN_VALUE 900
+
+int16_t pieceValue(PieceType type); // king: 0
+int16_t evaluate(const Position &position);
+
+#endif
@@ -0,0 +1,323 @@
+#include "GameStore.h"
+
+#include <string.h>
+#if defined(__AVR__)
+#include <avr/eeprom.h>
+#else
+#include <stdio.h>
+#endif
+
+#define STORE_MAGIC 0x5343 // "SC"
+#define STORE_VERSION 2    // 2: fixed-offset header with the ring size
+#define EMPTY_SLOT 0xFFFF  // erased EEPROM; never a valid move (castling from 63 to 63)
+
+#define HEADER_BYTES GAME_STORE_HEADER_BYTES
+#define CHECK_OFFSET (HEADER_BYTES - 1)
+#define LOG_ADDRESS (GAME_STORE_BASE + 2 * HEADER_BYTES)
+
+struct StoreHeader
+{
+  uint16_t magic;
+  uint8_t version;
+  uint8_t sequence; // increases with every header written, wrapping
+  uint16_t logStart;
+  uint16_t logSlots;
+  PackedPosition start;
+};
+
+static void put16(uint8_t *bytes, uint16_t value)
+{
+    bytes[0] = (uint8_t)value;
+    bytes[1] = (uint8_t)(value >> 8);
+}
+
+static uint16_t get16(const uint8_t *bytes)
+{
+    return bytes[0] | ((uint16_t)bytes[1] << 8);
+}
+
+static uint8_t headerCheck(const uint8_t *bytes)
+{
+    uint8_t sum = 0;
+    for (uint8_t i = 0; i < CHECK_OFFSET; i++)
+    {
+        sum += bytes[i];
+    }
+    return ~sum;
+}
+
+// The layout in GameStore.h
+static void encodeHeader(const StoreHeader &header, uint8_t *bytes)
+{
+    put16(bytes, header.magic);
+    bytes[2] = header.version;
+    bytes[3] = header.sequence;
+    put16(bytes + 4, header.logStart);
+    put16(bytes + 6, header.logSlots);
+    memcpy(bytes + 8, header.start.squares, 32);
+    bytes[40] = header.start.sideAndRights;
+    bytes[41] = header.start.epSquare;
+    put16(bytes + 42, header.start.halfMoveClock);
+    put16(bytes + 44, header.start.fullMoveNumber);
+    bytes[CHECK_OFFSET] = headerCheck(bytes);
+}
+
+// False if the bytes aren't a header (blank, torn or another version)
+static bool decodeHeader(const uint8_t *bytes, StoreHeader &header)
+{
+    header.magic = get16(bytes);
+    header.version = bytes[2];
+    header.sequence = bytes[3];
+    header.logStart = get16(bytes + 4);
+    header.logSlots = get16(bytes + 6);
+    memcpy(header.start.squares, bytes + 8, 32);
+    header.start.sideAndRights = bytes[40];
+    header.start.epSquare = bytes[41];
+    header.start.halfMoveClock = get16(bytes + 42);
+    header.start.fullMoveNumber = get16(bytes + 44);
+    return header.magic == STORE_MAGIC && header.version == STORE_VERSION && bytes[CHECK_OFFSET] == headerCheck(bytes);
+}
+
+void packPosition(const Position &position, PackedPosition &packed)
+{
+    for (Square sq = 0; sq < 64; sq += 2)
+    {
+        packed.squares[sq / 2] = position.board.pieceAt(sq) | (position.board.pieceAt(sq + 1) << 4);
+    }
+    packed.sideAndRights = (position.sideToMove << 4) | position.castlingRights;
+    packed.epSquare = position.epSquare;
+    packed.halfMoveClock = position.halfMoveClock;
+    packed.fullMoveNumber = position.fullMoveNumber;
+}
+
+void unpackPosition(const PackedPosition &packed, Position &position)
+{
+    position.clear();
+    for (Square sq = 0; sq < 64; sq++)
+    {
+        PieceCode piece = (packed.squares[sq / 2] >> (4 * (sq & 1))) & 0x0F;
+        if (piece != NO_PIECE)
+            position.board.put(sq, piece);
+    }
+    position.sideToMove = (PieceColor)((packed.sideAndRights >> 4) & 1);
+    position.castlingRights = packed.sideAndRights & 0x0F;
+    position.epSquare = packed.epSquare;
+    position.halfMoveClock = packed.halfMoveClock;
+    position.fullMoveNumber = packed.fullMoveNumber;
+}
+
+GameStore::GameStore() : sequence(0), newestSlot(1), logStart(0), logSlots(0), plies(0), valid(false)
+{
+#if !defined(__AVR__)
+    file = nullptr;
+    fileBytes = GAME_STORE_BYTES;
+#endif
+    logSlots = (storeBytes() - LOG_ADDRESS) / 2;
+}
+
+#if defined(__AVR__)
+
+uint16_t GameStore::storeBytes() const
+{
+    return GAME_STORE_BYTES;
+}
+
+void GameStore::read(uint16_t address, void *data, uint16_t length) const
+{
+    eeprom_read_block(data, (const void *)address, length);
+}
+
+// Only bytes that differ are programmed, which spares the cells
+void GameStore::write(uint16_t address, const void *data, uint16_t length)
+{
+    eeprom_update_block(data, (void *)address, length);
+}
+
+#else
+
+GameStore::~GameStore()
+{
+    if (file)
+        fclose((FILE *)file);
+}
+
+bool GameStore::openFile(const char *path)
+{
+    if (file)
+        fclose((FILE *)file);
+    file = fopen(path, "r+b");
+    if (!file)
+    {
+        // New "chip": blank like erased EEPROM
+        file = fopen(path, "w+b");
+        if (!file)
+            return false;
+        for (uint16_t i = 0; i < GAME_STORE_BYTES; i++)
+        {
+            fputc(0xFF, (FILE *)file);
+        }
+        fflush((FILE *)file);
+    }
+    fseek((FILE *)file, 0, SEEK_END);
+    long size = ftell((FILE *)file);
+    fileBytes = size > 0xFFFF ? 0xFFFF : size > LOG_ADDRESS + 4 ? (uint16_t)size : GAME_STORE_BYTES;
+    logSlots = (fileBytes - LOG_ADDRESS) / 2;
+    valid = false;
+    return true;
+}
+
+uint16_t GameStore::storeBytes() const
+{
+    return fileBytes;
+}
+
+void GameStore::read(uint16_t address, void *data, uint16_t length) const
+{
+    if (!file || fseek((FILE *)file, address, SEEK_SET) != 0 || fread(data, 1, length, (FILE *)file) != length)
+    {
+        for (uint16_t i = 0; i < length; i++)
+        {
+            ((uint8_t *)data)[i] = 0xFF;
+        }
+    }
+}
+
+// Flushed at once, so a killed process keeps everything written so far
+void GameStore::write(uint16_t address, const void *data, uint16_t length)
+{
+    if (!file || fseek((FILE *)file, address, SEEK_SET) != 0)
+        return;
+    fwrite(data, 1, length, (FILE *)file);
+    fflush((FILE *)file);
+}
+
+#endif
+
+uint16_t GameStore::capacity() const
+{
+    return logSlots - 1; // one slot always holds the terminator
+}
+
+uint16_t GameStore::slotAddress(uint16_t slot) const
+{
+    return LOG_ADDRESS + 2 * (slot % logSlots);
+}
+
+Move GameStore::readSlot(uint16_t slot) const
+{
+    uint8_t bytes[2];
+    read(slotAddress(slot), bytes, 2);
+    return get16(bytes);
+}
+
+void GameStore::writeSlot(uint16_t slot, Move move)
+{
+    uint8_t bytes[2];
+    put16(bytes, move);
+    write(slotAddress(slot), bytes, 2);
+}
+
+bool GameStore::load(Position &start)
+{
+    StoreHeader headers[2];
+    bool ok[2];
+    uint16_t maxSlots = (storeBytes() - LOG_ADDRESS) / 2;
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        uint8_t bytes[HEADER_BYTES];
+        read(GAME_STORE_BASE + i * HEADER_BYTES, bytes, HEADER_BYTES);
+        ok[i] = decodeHeader(bytes, headers[i]) && headers[i].logSlots >= 2 && headers[i].logSlots <= maxSlots &&
+                headers[i].logStart < headers[i].logSlots;
+    }
+
+    valid = ok[0] || ok[1];
+    if (!valid)
+        return false;
+    // Both valid: the later sequence number, allowing for wrap-around
+    newestSlot = !ok[0] || (ok[1] && (int8_t)(headers[1].sequence - headers[0].sequence) > 0) ? 1 : 0;
+    const StoreHeader &header = headers[newestSlot];
+    sequence = header.sequence;
+    logStart = header.logStart;
+    logSlots = header.logSlots;
+    unpackPosition(header.start, start);
+
+    plies = 0;
+    while (plies < capacity() && readSlot(logStart + plies) != EMPTY_SLOT)
+    {
+        plies++;
+    }
+    return true;
+}
+
+Move GameStore::moveAt(uint16_t index) const
+{
+    return readSlot(logStart + index);
+}
+
+void GameStore::startGame(const Position &start)
+{
+    // Continue the sequence of whatever is stored, so a stale header can
+    // never look newer than this one
+    if (!valid)
+    {
+        Position stored;
+        load(stored);
+    }
+
+    // The new log begins where the old one ended, or anywhere if none (then
+    // in a ring as large as the store allows)
+    uint16_t begin = valid ? (logStart + plies) % logSlots : 0;
+    if (!valid)
+        logSlots = (storeBytes() - LOG_ADDRESS) / 2;
+
+    // Terminator first: until the header lands, the old header still
+    // describes the old game (whose end this slot already was)
+    writeSlot(begin, EMPTY_SLOT);
+
+    StoreHeader header;
+    header.magic = STORE_MAGIC;
+    header.version = STORE_VERSION;
+    header.sequence = valid ? sequence + 1 : 0;
+    header.logStart = begin;
+    header.logSlots = logSlots;
+    packPosition(start, header.start);
+    uint8_t bytes[HEADER_BYTES];
+    encodeHeader(header, bytes);
+
+    uint8_t slot = valid ? !newestSlot : 0;
+    write(GAME_STORE_BASE + slot * HEADER_BYTES, bytes, HEADER_BYTES);
+
+    sequence = header.sequence;
+    newestSlot = slot;
+    logStart = begin;
+    plies = 0;
+    valid = true;
+}
+
+void GameStore::appendMove(Move move, const Position &after)
+{
+    if (!valid)
+        return;
+    if (plies >= capacity())
+    {
+        // Ring full: carry on from the current position
+        startGame(after);
+        return;
+    }
+
+    // New terminator, then the move over the old one: a cut in between
+    // leaves the log one move short, never garbled
+    writeSlot(logStart + plies + 1, EMPTY_SLOT);
+    writeSlot(logStart + plies, move);
+    plies++;
+}
+
+void GameStore::erase()
+{
+    uint8_t blank[HEADER_BYTES];
+    memset(blank, 0xFF, sizeof(blank));
+    write(GAME_STORE_BASE, blank, HEADER_BYTES);
+    write(GAME_STORE_BASE + HEADER_BYTES, blank, HEADER_BYTES);
+    valid = false;
+    plies = 0;
+}
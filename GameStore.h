@@ -0,0 +1,103 @@
+#ifndef GAMESTORE_H
+#define GAMESTORE_H
+
+#include <Arduino.h>
+#include "Position.h"
+
+// The current game, kept in non-volatile memory so it survives a power
+// cut: the AVR's EEPROM, or a file on the host. Layout:
+//
+//   two header copies  starting position (packed) plus where the log begins;
+//                      written alternately once per game, the newer valid
+//                      copy wins, so a cut while writing one leaves the other
+//   move log           a ring of 16-bit moves ended by an empty (0xFFFF) slot
+//
+// A header is GAME_STORE_HEADER_BYTES, written field by field, little-endian,
+// at fixed offsets (no struct padding), so the same image reads back on the
+// AVR and on the host:
+//
+//   0  magic (2)   2  version   3  sequence   4  log start slot (2)
+//   6  ring size in slots (2)   8  PackedPosition, field by field (38)
+//   46 check: complement of the byte sum of bytes 0-45
+//
+// The ring size is the one the image was written with, so a dump of a
+// 4 KB Mega EEPROM reads on a host built for 1 KB (GAME_STORE_BASE must
+// match, though).
+//
+// Appending a move writes 4 bytes: the next terminator, then the move over
+// the old terminator. Each game's log starts where the previous one ended,
+// so writes spread over the whole ring instead of wearing its first cells.
+// A game longer than the ring is rebased: a new header holds the current
+// position and the log restarts from it.
+
+#ifndef GAME_STORE_BYTES
+#if defined(E2END)
+#define GAME_STORE_BYTES (E2END + 1)
+#else
+#define GAME_STORE_BYTES 1024
+#endif
+#endif
+
+#define GAME_STORE_HEADER_BYTES 47
+
+#ifndef GAME_STORE_BASE
+#define GAME_STORE_BASE 0 // first byte used, to share the EEPROM with other data
+#endif
+
+// Position in 38 bytes: two squares per byte, then the game fields
+struct PackedPosition
+{
+  uint8_t squares[32];    // piece code of square 2n in the low nibble, 2n + 1 in the high one
+  uint8_t sideAndRights;  // side to move in bit 4, castling rights in bits 0-3
+  Square epSquare;
+  uint16_t halfMoveClock;
+  uint16_t fullMoveNumber;
+};
+
+void packPosition(const Position &position, PackedPosition &packed);
+void unpackPosition(const PackedPosition &packed, Position &position);
+
+class GameStore
+{
+public:
+  GameStore();
+#if !defined(__AVR__)
+  ~GameStore();
+  // host: the file plays the EEPROM, its size the EEPROM's; created blank,
+  // GAME_STORE_BYTES long, if missing
+  bool openFile(const char *path);
+#endif
+
+  // Finds the newest valid header and the end of its log. False if no game
+  // is stored.
+  bool load(Position &start);
+  uint16_t moveCount() const { return plies; } // moves logged after start
+  Move moveAt(uint16_t index) const;
+
+  void startGame(const Position &start);
+  void appendMove(Move move, const Position &after); // after: the position it led to
+  void erase();
+  uint16_t capacity() const; // moves the ring holds
+
+private:
+  uint8_t sequence;   // of the newest header
+  uint8_t newestSlot; // which header copy holds it
+  uint16_t logStart;  // ring slot of the first move
+  uint16_t logSlots;  // ring size, from the header once one is loaded
+  uint16_t plies;
+  bool valid;
+#if !defined(__AVR__)
+  void *file;
+  uint16_t fileBytes;
+#endif
+
+  uint16_t storeBytes() const;
+
+  void read(uint16_t address, void *data, uint16_t length) const;
+  void write(uint16_t address, const void *data, uint16_t length);
+  uint16_t slotAddress(uint16_t slot) const;
+  Move readSlot(uint16_t slot) const;
+  void writeSlot(uint16_t slot, Move move);
+};
+
+#endif
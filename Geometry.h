@@ -0,0 +1,91 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <Arduino.h>
+#include "ChessTypes.h"
+
+// Board geometry shared by move generation and the backends' attack tests.
+// Rays are walked in 0x88 coordinates: leaving the board is one mask test.
+
+extern const int8_t knightOffsets88[8] PROGMEM;
+extern const int8_t kingOffsets88[8] PROGMEM; // first four are the straight directions
+
+inline uint8_t toX88(Square sq) { return sq + (sq & 0x38); }
+inline Square fromX88(uint8_t x) { return (x + (x & 7)) >> 1; }
+
+// Index into the delta tables for a move or attack from -> to. 0x88
+// differences are unique per (row, column) offset, -119..119.
+inline uint8_t deltaIndex88(Square from, Square to) { return (uint8_t)(toX88(to) - toX88(from) + 119); }
+
+// Bits of DeltaTables88::attackers: 1 << type for every piece, except that
+// white pawns use bit 0 (PAWN) and black pawns bit 6
+#define BLACK_PAWN_ATTACK_BIT 0x40
+inline uint8_t attackBit(PieceType type, PieceColor color)
+{
+  return type == PAWN ? 1 << (6 * color) : 1 << type;
+}
+template <PieceColor Us>
+inline uint8_t attackBit(PieceType type)
+{
+  return type == PAWN ? Side<Us>::pawnAttackBit : 1 << type;
+}
+
+// Compile-time generation of the delta tables: the values below are
+// evaluated by the compiler and the arrays land in flash like any other
+// PROGMEM table.
+constexpr int deltaRow(int d) { return (d + 120) / 16 - 7; }
+constexpr int deltaCol(int d) { return d - 16 * deltaRow(d); }
+constexpr int absValue(int v) { return v < 0 ? -v : v; }
+constexpr int signOf(int v) { return (v > 0) - (v < 0); }
+constexpr bool onStraight(int d) { return d != 0 && (deltaRow(d) == 0 || deltaCol(d) == 0); }
+constexpr bool onDiagonal(int d) { return d != 0 && absValue(deltaRow(d)) == absValue(deltaCol(d)); }
+
+constexpr uint8_t deltaAttackers(int d)
+{
+  return (onStraight(d) ? (1 << ROOK) | (1 << QUEEN) : 0) |
+         (onDiagonal(d) ? (1 << BISHOP) | (1 << QUEEN) : 0) |
+         (absValue(deltaRow(d)) * absValue(deltaCol(d)) == 2 ? 1 << KNIGHT : 0) |
+         (d != 0 && absValue(deltaRow(d)) <= 1 && absValue(deltaCol(d)) <= 1 ? 1 << KING : 0) |
+         (absValue(deltaCol(d)) == 1 && deltaRow(d) == 1 ? 1 << PAWN : 0) |
+         (absValue(deltaCol(d)) == 1 && deltaRow(d) == -1 ? BLACK_PAWN_ATTACK_BIT : 0);
+}
+
+// Dense-index step along the line, 0 if the squares share no line
+constexpr int8_t deltaStep(int d)
+{
+  return onStraight(d) || onDiagonal(d) ? 8 * signOf(deltaRow(d)) + signOf(deltaCol(d)) : 0;
+}
+
+template <int... I>
+struct IndexList
+{
+};
+template <int N, int... I>
+struct MakeIndexList : MakeIndexList<N - 1, N - 1, I...>
+{
+};
+template <int... I>
+struct MakeIndexList<0, I...>
+{
+  typedef IndexList<I...> type;
+};
+
+template <class List>
+struct DeltaTables;
+template <int... I>
+struct DeltaTables<IndexList<I...>>
+{
+  static const uint8_t attackers[sizeof...(I)]; // which pieces attack along the delta
+  static const int8_t steps[sizeof...(I)];
+};
+template <int... I>
+const uint8_t DeltaTables<IndexList<I...>>::attackers[sizeof...(I)] PROGMEM = {deltaAttackers(I - 119)...};
+template <int... I>
+const int8_t DeltaTables<IndexList<I...>>::steps[sizeof...(I)] PROGMEM = {deltaStep(I - 119)...};
+
+typedef DeltaTables<MakeIndexList<239>::type> DeltaTables88;
+
+inline uint8_t deltaAttackers88(uint8_t index) { return pgm_read_byte(&DeltaTables88::attackers[index]); }
+inline int8_t deltaStep88(uint8_t index) { return (int8_t)pgm_read_byte(&DeltaTables88::steps[index]); }
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <Arduino.h>
+#include "ChessTypes.h"
+
+// Zobrist-style position keys. The per-feature keys come from a mixing
+// function instead of random tables, so nothing is stored in SRAM or flash.
+// 32-bit on AVR (where 64-bit arithmetic is slow), 64-bit on the host.
+#if defined(__AVR__)
+typedef uint32_t HashKey;
+
+inline HashKey hashMix(uint32_t x)
+{
+  x ^= x >> 16;
+  x *= 0x7FEB352DUL;
+  x ^= x >> 15;
+  x *= 0x846CA68BUL;
+  x ^= x >> 16;
+  return x;
+}
+#else
+typedef uint64_t HashKey;
+
+inline HashKey hashMix(uint64_t x)
+{
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+#endif
+
+// Disjoint input ranges: pieces 0..1023, castling 1024..1039, en passant
+// 1040..1103, side to move 1104
+inline HashKey hashPiece(PieceCode piece, Square sq) { return hashMix(((uint16_t)piece << 6) | sq); }
+inline HashKey hashCastling(uint8_t rights) { return hashMix(1024 + rights); }
+inline HashKey hashEnPassant(Square sq) { return hashMix(1040 + sq); }
+inline HashKey hashBlackToMove() { return hashMix(1104); }
+
+#endif
@@ -1,5 +1,5 @@
 #include "King.h"
-#include "Rook.h"
+#include "ChessBoard.h"
 #include <Arduino.h>
 
 King::King(PieceColor color) : Piece(KING, color) {}
@@ -21,8 +21,9 @@ bool King::canMove(int fromRow, char fromCol, int toRow, char toCol)
         return true;
     }
 
-    // Castling (pattern check only - full validation needs board)
-    if (!hasMoved && rowDiff == 0 && colDiff == 2)
+    // Castling from the king's home square (pattern check only - full validation needs board)
+    int homeRow = (_color == WHITE) ? 1 : 8;
+    if (fromRow == homeRow && fromCol == 'E' && rowDiff == 0 && colDiff == 2)
     {
         return true;
     }
@@ -42,20 +43,18 @@ bool King::canMove(int fromRow, char fromCol, int toRow, char toCol, ChessBoard
         return true;
     }
 
-    if (!hasMoved && rowDiff == 0 && colDiff == 2)
+    if (rowDiff == 0 && colDiff == 2 && canMove(fromRow, fromCol, toRow, toCol))
     {
+        if (!board->hasCastlingRight(_color, toCol > fromCol))
+            return false; // king or rook has moved
+
         if (board->isSquareAttacked(fromRow, fromCol, _color == WHITE ? BLACK : WHITE))
             return false;
 
         char rookCol = (toCol > fromCol) ? 'H' : 'A';
         Piece *rookPiece = board->getPiece(fromRow, rookCol);
 
-        if (!rookPiece || rookPiece->getTypeName()[0] != 'R')
-            return false;
-
-        Rook *rook = (Rook *)rookPiece;
-
-        if (rook->hasMoved)
+        if (!rookPiece || rookPiece->getType() != ROOK || rookPiece->getColor() != _color)
             return false;
 
         char step = (toCol > fromCol) ? 1 : -1;
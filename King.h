@@ -14,8 +14,6 @@ class King : public Piece {
     bool canMove(int fromRow, char fromCol, int toRow, char toCol) override;
 
     bool canMove(int fromRow, char fromCol, int toRow, char toCol, ChessBoard* board);
-
-    bool hasMoved = false;
 };
 
 #endif
@@ -0,0 +1,263 @@
+#include "LatencyBench.h"
+#include "ChessBoard.h"
+#include "Perf.h"
+
+// One case per line: name;FEN;moves;final state. Moves are in coordinate
+// notation (e7e8q promotes). Final state: A active, M checkmate,
+// S stalemate, D draw.
+static const char latencyCorpus[] PROGMEM =
+    // Ordinary development with castling: the typical cost
+    "opening;rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1;"
+    "e2e4 e7e5 g1f3 b8c6 f1c4 g8f6 e1g1 f8c5;A\n"
+    // Mates with (nearly) every defender still on the board: hasAnyValidMove()
+    // has to generate and reject every pseudo-legal move
+    "scholar-mate;rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1;"
+    "e2e4 e7e5 d1h5 b8c6 f1c4 g8f6 h5f7;M\n"
+    "fools-mate;rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1;"
+    "f2f3 e7e5 g2g4 d8h4;M\n"
+    "legal-mate;rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1;"
+    "e2e4 e7e5 g1f3 d7d6 f1c4 c8g4 b1c3 g7g6 f3e5 g4d1 c4f7 e8e7 c3d5;M\n"
+    // Back-rank mate against six queens: ~70 pseudo-legal replies, all illegal
+    "queens-mated;7k/5ppp/1q6/q7/8/2q5/1qqq1PPP/4R1K1 w - - 0 1;e1e8;M\n"
+    // Sam Loyd's ten-move stalemate: 13 black pieces, none can move
+    "loyd-stalemate;rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1;"
+    "e2e3 a7a5 d1h5 a8a6 h5a5 h7h5 h2h4 a6h6 a5c7 f7f6 c7d7 e8f7 d7b7 d8d3 b7b8 d3h7 b8c8 f7g6 c8e6;S\n"
+    // The most legal moves known in a reachable position (218); the reply
+    // leaves black stalemated
+    "218-moves;R6R/3Q4/1Q4Q1/4Q3/2Q4Q/Q4Q2/pp1Q4/kBNN1KB1 w - - 0 1;h8h7;S\n"
+    // Special moves: en passant, promotion with check, castling both ways
+    "ep-promotion;4k3/1P6/8/3pP3/K7/8/6p1/8 w - d6 0 1;e5d6 g2g1q b7b8q;A\n"
+    "castling;r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1;e1g1 e8c8 a1a8;A\n"
+    // Each draw rule
+    "repetition;rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1;"
+    "g1f3 g8f6 f3g1 f6g8 g1f3 g8f6 f3g1 f6g8;D\n"
+    "bare-kings;8/8/4k3/8/8/2r5/3K4/8 w - - 0 1;d2c3;D\n"
+    "fifty-moves;8/8/4k3/8/8/8/R7/4K3 w - - 99 80;a2a3;D\n";
+
+#define FEN_BUFFER 96
+#define NAME_BUFFER 24
+
+static char corpusChar(uint16_t offset)
+{
+    return (char)pgm_read_byte(&latencyCorpus[offset]);
+}
+
+// Copies the field at offset into buffer (cut to size) and returns the
+// offset just past its ';'
+static uint16_t readField(uint16_t offset, char *buffer, uint8_t size)
+{
+    uint8_t length = 0;
+    for (char c = corpusChar(offset); c != ';' && c != '\n' && c != 0; c = corpusChar(++offset))
+    {
+        if (length + 1 < size)
+            buffer[length++] = c;
+    }
+    buffer[length] = 0;
+    return corpusChar(offset) == ';' ? offset + 1 : offset;
+}
+
+static uint16_t skipLine(uint16_t offset)
+{
+    while (corpusChar(offset) != '\n' && corpusChar(offset) != 0)
+    {
+        offset++;
+    }
+    return corpusChar(offset) == '\n' ? offset + 1 : offset;
+}
+
+static bool stateMatches(GameState state, char expected)
+{
+    switch (expected)
+    {
+    case 'A':
+        return state == GAME_ACTIVE;
+    case 'M':
+        return state == GAME_CHECKMATE_WHITE || state == GAME_CHECKMATE_BLACK;
+    case 'S':
+        return state == GAME_STALEMATE;
+    case 'D':
+        return state == GAME_DRAW;
+    }
+    return false;
+}
+
+void LatencyHistogram::clear()
+{
+    memset(this, 0, sizeof(*this));
+}
+
+static uint8_t bucketOf(uint32_t ticks)
+{
+    if (ticks < 4)
+        return ticks;
+    uint8_t exponent = 0;
+    for (uint32_t v = ticks; v > 1; v >>= 1)
+    {
+        exponent++;
+    }
+    uint16_t bucket = 4 * (exponent - 1) + ((ticks >> (exponent - 2)) & 3);
+    return bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1;
+}
+
+static uint32_t bucketTop(uint8_t bucket)
+{
+    if (bucket < 4)
+        return bucket;
+    uint8_t exponent = bucket / 4 + 1;
+    return ((uint32_t)(5 + bucket % 4) << (exponent - 2)) - 1;
+}
+
+void LatencyHistogram::add(uint32_t ticks)
+{
+    LatencyCount &count = counts[bucketOf(ticks)];
+    if (count != (LatencyCount)~0)
+        count++;
+    samples++;
+    if (ticks > maxTicks)
+        maxTicks = ticks;
+}
+
+uint32_t LatencyHistogram::quantile(uint32_t numerator, uint32_t denominator) const
+{
+    // Rank of the wanted sample, 1-based, rounded up
+    uint32_t rank = (uint32_t)(((uint64_t)samples * numerator + denominator - 1) / denominator);
+    if (rank == 0)
+        rank = 1;
+    uint32_t seen = 0;
+    for (uint8_t bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+    {
+        seen += counts[bucket];
+        if (seen >= rank)
+            return bucketTop(bucket) < maxTicks ? bucketTop(bucket) : maxTicks;
+    }
+    return maxTicks;
+}
+
+// Replays one case; offset points at its FEN field
+static void runCase(ChessBoard &board, uint16_t offset, LatencyCaseResult &result, LatencyHistogram &all)
+{
+    char fen[FEN_BUFFER];
+    offset = readField(offset, fen, sizeof(fen));
+    Position start;
+    if (!start.setFromFen(fen))
+    {
+        result.passed = false;
+        return;
+    }
+    board.setPosition(start);
+
+    bool passed = true;
+    uint8_t ply = 0;
+    char c = corpusChar(offset);
+    while (c != ';' && c != '\n' && c != 0)
+    {
+        if (c == ' ')
+        {
+            c = corpusChar(++offset);
+            continue;
+        }
+        Square from = (corpusChar(offset + 1) - '1') * 8 + (c - 'a');
+        Square to = (corpusChar(offset + 3) - '1') * 8 + (corpusChar(offset + 2) - 'a');
+        offset += 4;
+        PromotionType promotion = PROMOTE_QUEEN;
+        switch (corpusChar(offset))
+        {
+        case 'r':
+            promotion = PROMOTE_ROOK;
+            offset++;
+            break;
+        case 'b':
+            promotion = PROMOTE_BISHOP;
+            offset++;
+            break;
+        case 'n':
+            promotion = PROMOTE_KNIGHT;
+            offset++;
+            break;
+        case 'q':
+            offset++;
+            break;
+        }
+
+        // Drain earlier output so the move's own prints only fill the buffer
+        Serial.flush();
+        uint32_t begin = perfTicks();
+        bool accepted = board.movePiece(from, to, promotion);
+        uint32_t ticks = perfTicks() - begin;
+
+        passed = passed && accepted;
+        all.add(ticks);
+        if (ticks > result.maxTicks)
+        {
+            result.maxTicks = ticks;
+            result.worstPly = ply;
+        }
+        ply++;
+        c = corpusChar(offset);
+    }
+    result.plies = ply;
+    result.passed = passed && c == ';' && stateMatches(board.getGameState(), corpusChar(offset + 1));
+}
+
+void runLatencyBench(LatencyReport &report, uint16_t repeats)
+{
+    static ChessBoard board; // too big for the AVR's stack frame
+    char name[NAME_BUFFER];
+
+    report.all.clear();
+    memset(report.cases, 0, sizeof(report.cases));
+    for (uint8_t i = 0; i < LATENCY_MAX_CASES; i++)
+    {
+        report.cases[i].passed = true;
+    }
+
+    for (uint16_t r = 0; r < repeats; r++)
+    {
+        uint8_t index = 0;
+        for (uint16_t offset = 0; corpusChar(offset) != 0 && index < LATENCY_MAX_CASES; offset = skipLine(offset), index++)
+        {
+            LatencyCaseResult result = report.cases[index];
+            runCase(board, readField(offset, name, sizeof(name)), result, report.all);
+            result.passed = result.passed && report.cases[index].passed;
+            report.cases[index] = result;
+        }
+        report.caseCount = index;
+    }
+}
+
+void printLatencyReport(const LatencyReport &report)
+{
+    char name[NAME_BUFFER];
+    uint16_t offset = 0;
+    uint8_t failed = 0;
+
+    Serial.println("movePiece latency (" PERF_TICK_UNIT "), game-state update included");
+    for (uint8_t i = 0; i < report.caseCount; i++, offset = skipLine(offset))
+    {
+        const LatencyCaseResult &result = report.cases[i];
+        readField(offset, name, sizeof(name));
+        Serial.print(name);
+        Serial.print(": max ");
+        Serial.print((unsigned long)result.maxTicks);
+        Serial.print(" at ply ");
+        Serial.print((unsigned int)result.worstPly + 1);
+        Serial.print(" of ");
+        Serial.print((unsigned int)result.plies);
+        Serial.println(result.passed ? "" : "  FAILED");
+        failed += !result.passed;
+    }
+
+    const LatencyHistogram &all = report.all;
+    Serial.print("moves: ");
+    Serial.print((unsigned long)all.samples);
+    Serial.print("  p50 ");
+    Serial.print((unsigned long)all.quantile(1, 2));
+    Serial.print("  p99 ");
+    Serial.print((unsigned long)all.quantile(99, 100));
+    Serial.print("  p99.9 ");
+    Serial.print((unsigned long)all.quantile(999, 1000));
+    Serial.print("  max ");
+    Serial.println((unsigned long)all.maxTicks);
+    Serial.print("failed cases: ");
+    Serial.println((unsigned int)failed);
+}
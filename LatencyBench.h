@@ -0,0 +1,67 @@
+#ifndef LATENCYBENCH_H
+#define LATENCYBENCH_H
+
+#include <Arduino.h>
+
+// Worst-case latency of ChessBoard::movePiece(), game-state update included,
+// over a fixed corpus of adversarial positions and move sequences (see
+// LatencyBench.cpp): full mate and stalemate scans with every piece still on
+// the board, a 218-move position, castling, en passant and promotion, and
+// each draw rule. Every case also checks its final game state, so the corpus
+// doubles as a regression test.
+//
+// Ticks are perfTicks(): micros(), or cycles with SMARTCHESS_PERF_CYCLES.
+//
+// Host: host/latency_bench.cpp. AVR (an ATmega2560 board or simavr): build
+// the sketch with SMARTCHESS_LATENCY_BENCH and SMARTCHESS_PERF_CYCLES
+// defined, e.g.
+//
+//   arduino-cli compile --fqbn arduino:avr:mega --output-dir build
+//     --build-property "compiler.cpp.extra_flags=-DSMARTCHESS_LATENCY_BENCH -DSMARTCHESS_PERF_CYCLES"
+//   simavr -m atmega2560 -f 16000000 build/Sah_Strgar_Oreskovic_Kovac.ino.elf
+//
+// and setup() prints the report on the serial port instead of starting a game.
+
+// Log-scale histogram: four buckets per power of two, up to 2^28 ticks
+#define LATENCY_BUCKETS 112
+#define LATENCY_MAX_CASES 16
+
+#if defined(__AVR__)
+typedef uint16_t LatencyCount; // a handful of repeats on the target
+#else
+typedef uint32_t LatencyCount;
+#endif
+
+struct LatencyHistogram
+{
+  LatencyCount counts[LATENCY_BUCKETS];
+  uint32_t samples;
+  uint32_t maxTicks;
+
+  void clear();
+  void add(uint32_t ticks);
+  // Upper bound of the bucket holding the sample at numerator / denominator
+  // of the sorted samples, e.g. (999, 1000) for p99.9; exact at the top
+  uint32_t quantile(uint32_t numerator, uint32_t denominator) const;
+};
+
+struct LatencyCaseResult
+{
+  uint32_t maxTicks;
+  uint8_t worstPly; // index of the slowest move in the case
+  uint8_t plies;
+  bool passed; // every move accepted and the expected final state reached
+};
+
+struct LatencyReport
+{
+  LatencyHistogram all;
+  LatencyCaseResult cases[LATENCY_MAX_CASES];
+  uint8_t caseCount;
+};
+
+// Plays the whole corpus repeats times, timing every movePiece() call
+void runLatencyBench(LatencyReport &report, uint16_t repeats);
+void printLatencyReport(const LatencyReport &report);
+
+#endif
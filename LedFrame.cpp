@@ -0,0 +1,178 @@
+#include "LedFrame.h"
+
+static_assert(LED_SEGMENT_LENGTH * LED_SEGMENTS == 64, "LED_SEGMENT_LENGTH must divide 64");
+
+// Position of the square's LED along the wiring, rank by rank from A1
+static uint8_t ledIndex(Square sq)
+{
+    uint8_t rank = sq >> 3;
+    uint8_t file = sq & 7;
+    if (LED_SERPENTINE && (rank & 1))
+        file = 7 - file;
+    return rank * 8 + file;
+}
+
+LedFrame::LedFrame()
+{
+    memset(pixels, 0, sizeof(pixels));
+#if !defined(__AVR__)
+    memset(strip, 0, sizeof(strip));
+    wire = 0;
+#endif
+    invalidate();
+}
+
+void LedFrame::setSquare(Square sq, uint32_t rgb)
+{
+    uint8_t index = ledIndex(sq);
+    uint8_t grb[3] = {(uint8_t)(rgb >> 8), (uint8_t)(rgb >> 16), (uint8_t)rgb};
+    if (memcmp(pixels[index], grb, 3) == 0)
+        return;
+    memcpy(pixels[index], grb, 3);
+    uint8_t segment = index / LED_SEGMENT_LENGTH;
+    uint8_t count = index % LED_SEGMENT_LENGTH + 1;
+    if (count > sendCount[segment])
+        sendCount[segment] = count;
+}
+
+uint32_t LedFrame::getSquare(Square sq) const
+{
+    const uint8_t *grb = pixels[ledIndex(sq)];
+    return ((uint32_t)grb[1] << 16) | ((uint32_t)grb[0] << 8) | grb[2];
+}
+
+void LedFrame::drawSquares(const BoardBackend &board, uint64_t squares)
+{
+    for (uint8_t rank = 0; rank < 8; rank++)
+    {
+        uint8_t files = squares >> (8 * rank);
+        for (Square sq = rank * 8; files; sq++, files >>= 1)
+        {
+            if (!(files & 1))
+                continue;
+            PieceCode piece = board.pieceAt(sq);
+            if (piece == NO_PIECE)
+                setSquare(sq, LED_COLOR_EMPTY);
+            else
+                setSquare(sq, pieceColor(piece) == WHITE ? LED_COLOR_WHITE : LED_COLOR_BLACK);
+        }
+    }
+}
+
+void LedFrame::invalidate()
+{
+    memset(sendCount, LED_SEGMENT_LENGTH, sizeof(sendCount));
+}
+
+uint8_t LedFrame::show()
+{
+    uint8_t sent = 0;
+    for (uint8_t segment = 0; segment < LED_SEGMENTS; segment++)
+    {
+        if (sendCount[segment])
+        {
+            sendChain(segment, sendCount[segment]);
+            sent += sendCount[segment];
+            sendCount[segment] = 0;
+        }
+    }
+#if !defined(__AVR__)
+    // Each chain latches while the next is sent; only the last latch adds
+    if (sent)
+        wire += LED_LATCH_MICROS;
+#endif
+    return sent;
+}
+
+#if defined(__AVR__)
+
+static_assert(F_CPU == 16000000UL, "the WS2812 bit timing is written for 16 MHz");
+
+static const uint8_t ledPins[] = LED_PINS;
+static_assert(sizeof(ledPins) == LED_SEGMENTS, "LED_PINS needs one pin per chain");
+
+static unsigned long lastPush[LED_SEGMENTS];
+
+void LedFrame::begin()
+{
+    for (uint8_t i = 0; i < LED_SEGMENTS; i++)
+    {
+        pinMode(ledPins[i], OUTPUT);
+        digitalWrite(ledPins[i], LOW);
+        lastPush[i] = micros();
+    }
+    invalidate();
+}
+
+// One byte, most significant bit first: 20 cycles (1.25 us) per '1' bit,
+// high for 12 (750 ns); 21 per '0' bit, high for 5 (310 ns)
+static inline void sendByte(volatile uint8_t *port, uint8_t high, uint8_t low, uint8_t value)
+{
+    uint8_t bits = 8;
+    asm volatile("1:                     \n\t"
+                 "st   %a[port], %[high]  \n\t"
+                 "nop                     \n\t"
+                 "nop                     \n\t"
+                 "sbrs %[value], 7        \n\t"
+                 "st   %a[port], %[low]   \n\t"
+                 "lsl  %[value]           \n\t"
+                 "nop                     \n\t"
+                 "nop                     \n\t"
+                 "nop                     \n\t"
+                 "nop                     \n\t"
+                 "nop                     \n\t"
+                 "st   %a[port], %[low]   \n\t"
+                 "nop                     \n\t"
+                 "nop                     \n\t"
+                 "nop                     \n\t"
+                 "dec  %[bits]            \n\t"
+                 "brne 1b                 \n\t"
+                 : [bits] "+r"(bits), [value] "+r"(value)
+                 : [port] "e"(port), [high] "r"(high), [low] "r"(low)
+                 : "memory");
+}
+
+void LedFrame::sendChain(uint8_t segment, uint8_t count)
+{
+    volatile uint8_t *port = portOutputRegister(digitalPinToPort(ledPins[segment]));
+    uint8_t mask = digitalPinToBitMask(ledPins[segment]);
+    const uint8_t *data = pixels[segment * LED_SEGMENT_LENGTH];
+    uint16_t bytes = count * 3;
+
+    // A chain shows its data once the line has been low LED_LATCH_MICROS;
+    // sending sooner would append to it instead
+    while (micros() - lastPush[segment] < LED_LATCH_MICROS)
+    {
+    }
+    uint8_t oldSREG = SREG;
+    cli();
+    uint8_t high = *port | mask;
+    uint8_t low = *port & ~mask;
+    while (bytes--)
+    {
+        sendByte(port, high, low, *data++);
+    }
+    SREG = oldSREG;
+    lastPush[segment] = micros();
+}
+
+#else
+
+void LedFrame::begin()
+{
+    invalidate();
+}
+
+void LedFrame::sendChain(uint8_t segment, uint8_t count)
+{
+    memcpy(strip[segment * LED_SEGMENT_LENGTH], pixels[segment * LED_SEGMENT_LENGTH], count * 3);
+    wire += (unsigned long)count * LED_PIXEL_MICROS;
+}
+
+uint32_t LedFrame::stripSquare(Square sq) const
+{
+    const uint8_t *grb = strip[ledIndex(sq)];
+    return ((uint32_t)grb[1] << 16) | ((uint32_t)grb[0] << 8) | grb[2];
+}
+
+#endif
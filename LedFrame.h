@@ -0,0 +1,95 @@
+#ifndef LEDFRAME_H
+#define LEDFRAME_H
+
+#include <Arduino.h>
+#include "ChessTypes.h"
+#include "BoardBackend.h"
+
+// Framebuffer for a WS2812 LED under each square. Setting a square marks
+// its pixel changed only if the colour differs; show() then sends just the
+// chains with changes, each only as far as its last changed pixel. After a
+// move that is 2-4 squares instead of the 64 a full redraw pushes:
+//
+//   board.movePiece(...);
+//   leds.drawSquares(board.getBackend(), board.takeDirtySquares());
+//   leds.show();
+//
+// A WS2812 chain can't be addressed: the first pixel keeps the first 24
+// bits sent and passes the rest on, so reaching pixel n means resending
+// pixels 0..n-1. Pixels past the last one sent keep their colour. Each
+// pixel takes 30 us on the wire with interrupts off (the timing is bit-
+// exact), so the 64 squares can be wired as several shorter chains
+// (LED_SEGMENT_LENGTH) to shorten both the pushes and the time the sensor
+// interrupt waits.
+//
+// AVR: bit-banged for a 16 MHz CPU, one pin per chain. Host: no hardware;
+// the chains are emulated, pixel for pixel, and their wire time added up.
+
+#ifndef LED_SEGMENT_LENGTH
+#define LED_SEGMENT_LENGTH 64 // pixels per chain; 64 = one chain, 8 = one per rank
+#endif
+#define LED_SEGMENTS (64 / LED_SEGMENT_LENGTH)
+
+#ifndef LED_PINS
+#define LED_PINS {6} // data pin of each chain
+#endif
+
+// Chains running back and forth: odd ranks go H to A
+#ifndef LED_SERPENTINE
+#define LED_SERPENTINE 1
+#endif
+
+#define LED_PIXEL_MICROS 30 // 24 bits at 800 kHz
+#define LED_LATCH_MICROS 50 // line held low: the chain shows what it got
+
+// drawSquares() palette, 0xRRGGBB
+#ifndef LED_COLOR_EMPTY
+#define LED_COLOR_EMPTY 0x000000
+#endif
+#ifndef LED_COLOR_WHITE
+#define LED_COLOR_WHITE 0x202020
+#endif
+#ifndef LED_COLOR_BLACK
+#define LED_COLOR_BLACK 0x001030
+#endif
+#ifndef LED_COLOR_ATTENTION
+#define LED_COLOR_ATTENTION 0x300000 // not drawSquares(): for squares needing a hand
+#endif
+
+class LedFrame
+{
+public:
+  LedFrame();
+
+  // Sets the pins up. Every pixel counts as changed: the first show() sends
+  // the whole frame.
+  void begin();
+
+  void setSquare(Square sq, uint32_t rgb);
+  uint32_t getSquare(Square sq) const;
+  // Colours the given squares (bit sq set) by what stands on them
+  void drawSquares(const BoardBackend &board, uint64_t squares);
+  // The next show() sends every pixel (e.g. after the strip lost power)
+  void invalidate();
+
+  // Sends the changes; returns the number of pixels sent
+  uint8_t show();
+
+#if !defined(__AVR__)
+  uint32_t stripSquare(Square sq) const; // what the emulated LED shows
+  unsigned long wireMicros() const { return wire; } // total, pushes and latches
+#endif
+
+private:
+  uint8_t pixels[64][3];          // wire order (green, red, blue), by LED index
+  uint8_t sendCount[LED_SEGMENTS]; // pixels of each chain show() must send
+
+#if !defined(__AVR__)
+  uint8_t strip[64][3];
+  unsigned long wire;
+#endif
+
+  void sendChain(uint8_t segment, uint8_t count);
+};
+
+#endif
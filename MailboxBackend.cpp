@@ -0,0 +1,110 @@
+#include "BoardBackend.h"
+#include "Geometry.h"
+#include <Arduino.h>
+
+void MailboxBackend::clear()
+{
+    for (uint8_t i = 0; i < 64; i++)
+    {
+        cells[i] = NO_PIECE;
+    }
+    count[WHITE] = 0;
+    count[BLACK] = 0;
+    material = 0;
+    hash = 0;
+}
+
+// Point list slot at sq and record the slot in the square's high nibble
+void MailboxBackend::setSlot(PieceColor color, uint8_t slot, Square sq)
+{
+    list[color][slot] = sq;
+    cells[sq] = (slot << 4) | (cells[sq] & 0x0F);
+}
+
+bool MailboxBackend::put(Square sq, PieceCode piece)
+{
+    PieceColor color = pieceColor(piece);
+    if (count[color] >= MAX_PIECES_PER_SIDE || !materialHasRoom(material, piece))
+        return false; // more than 16 pieces per side cannot occur in a game
+
+    cells[sq] = piece;
+    material += materialDelta(piece, sq);
+    hash ^= hashPiece(piece, sq);
+    uint8_t slot = count[color]++;
+
+    // Keep the king in slot 0 so kingSquare() never searches
+    if (pieceType(piece) == KING && slot != 0)
+    {
+        setSlot(color, slot, list[color][0]);
+        slot = 0;
+    }
+    setSlot(color, slot, sq);
+    return true;
+}
+
+void MailboxBackend::remove(Square sq)
+{
+    PieceCode piece = pieceAt(sq);
+    PieceColor color = pieceColor(piece);
+    uint8_t slot = slotOf(sq);
+    cells[sq] = NO_PIECE;
+    material -= materialDelta(piece, sq);
+    hash ^= hashPiece(piece, sq);
+
+    // Fill the hole with the last entry
+    uint8_t last = --count[color];
+    if (slot != last)
+        setSlot(color, slot, list[color][last]);
+}
+
+void MailboxBackend::move(Square from, Square to)
+{
+    PieceCode piece = pieceAt(from);
+    hash ^= hashPiece(piece, from) ^ hashPiece(piece, to);
+    cells[to] = cells[from];
+    cells[from] = NO_PIECE;
+    list[pieceColor(pieceAt(to))][slotOf(to)] = to;
+}
+
+Square MailboxBackend::kingSquare(PieceColor color) const
+{
+    if (count[color] != 0 && pieceAt(list[color][0]) == makePiece(KING, color))
+        return list[color][0];
+    return NO_SQUARE;
+}
+
+bool MailboxBackend::isAttacked(Square sq, PieceColor by) const
+{
+    if (sq >= NO_SQUARE)
+        return false;
+    if (by == WHITE)
+        return attackedBy<WHITE>(sq);
+    return attackedBy<BLACK>(sq);
+}
+
+// One table lookup per piece tells whether it could attack sq at all; only
+// sliders lined up with sq then walk the squares between
+template <PieceColor By>
+bool MailboxBackend::attackedBy(Square sq) const
+{
+    for (uint8_t i = 0; i < count[By]; i++)
+    {
+        Square from = list[By][i];
+        PieceType type = pieceType(pieceAt(from));
+        uint8_t delta = deltaIndex88(from, sq);
+        if (!(deltaAttackers88(delta) & attackBit<By>(type)))
+            continue;
+        if (type == PAWN || type == KNIGHT || type == KING)
+            return true;
+
+        int8_t step = deltaStep88(delta);
+        Square s = from + step;
+        while (s != sq && pieceAt(s) == NO_PIECE)
+        {
+            s += step;
+        }
+        if (s == sq)
+            return true;
+    }
+    return false;
+}
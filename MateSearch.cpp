@@ -0,0 +1,172 @@
+#include "MateSearch.h"
+
+MateSearch::MateSearch(TranspositionTable &table)
+    : table(table), nodes(0), nodeLimit(0), aborted(false), tableCutoffs(true)
+{
+}
+
+bool MateSearch::solve(const Position &position, uint8_t maxMoves, MateResult &result)
+{
+    if (maxMoves > MATE_MAX_MOVES)
+        maxMoves = MATE_MAX_MOVES;
+    nodes = 0;
+    aborted = false;
+    result.mateIn = 0;
+    result.lineLength = 0;
+
+    for (uint8_t moves = 1; moves <= maxMoves && !aborted; moves++)
+    {
+        // Window (0, MATE_SCORE): anything but a mate fails low at once
+        int16_t score = search(position, 2 * moves - 1, 0, 0, MATE_SCORE);
+        if (!aborted && score > MATE_BOUND)
+        {
+            result.mateIn = (MATE_SCORE - score + 1) / 2;
+            result.lineLength = pvLength[0];
+            memcpy(result.line, pv[0], pvLength[0] * sizeof(Move));
+            break;
+        }
+    }
+
+    // A table hit inside the line cuts it short: finish it from there with
+    // the table read for ordering only
+    if (result.mateIn && result.lineLength < 2 * result.mateIn - 1)
+    {
+        Position end = position;
+        for (uint8_t i = 0; i < result.lineLength; i++)
+        {
+            end.makeMove(result.line[i]);
+        }
+        uint8_t ply = result.lineLength;
+        tableCutoffs = false;
+        search(end, 2 * result.mateIn - 1 - ply, ply, -MATE_SCORE, MATE_SCORE);
+        tableCutoffs = true;
+        memcpy(&result.line[ply], pv[ply], pvLength[ply] * sizeof(Move));
+        result.lineLength += pvLength[ply];
+    }
+    result.nodes = nodes;
+    result.aborted = aborted;
+    return result.mateIn != 0;
+}
+
+bool MateSearch::forcesMate(const Position &position, Move move, uint8_t mateIn)
+{
+    if (mateIn == 0 || mateIn > MATE_MAX_MOVES || !position.isLegal(move))
+        return false;
+    nodes = 0;
+    aborted = false;
+
+    Position after = position;
+    after.makeMove(move);
+    int16_t score = -search(after, 2 * mateIn - 2, 1, -MATE_SCORE, 0);
+    return !aborted && score > MATE_BOUND;
+}
+
+// depth: plies left; odd at the attacker's turn, even at the defender's
+int16_t MateSearch::search(const Position &position, uint8_t depth, uint8_t ply, int16_t alpha, int16_t beta)
+{
+    pvLength[ply] = 0;
+    nodes++;
+    if (nodeLimit && nodes > nodeLimit)
+    {
+        aborted = true;
+        return 0;
+    }
+
+    // Mate-distance window: being mated here, or mating with the next move,
+    // bound every score this node can have
+    if (alpha < -MATE_SCORE + ply)
+        alpha = -MATE_SCORE + ply;
+    if (beta > MATE_SCORE - ply - 1)
+        beta = MATE_SCORE - ply - 1;
+    if (alpha >= beta)
+        return alpha;
+
+    const BoardBackend &board = position.board;
+    PieceColor side = position.sideToMove;
+    if (depth == 0)
+    {
+        // Defender after the attacker's last move: mated or not
+        if (position.hasLegalMove())
+            return 0;
+        return position.inCheck() ? -MATE_SCORE + ply : 0;
+    }
+
+    HashKey key = position.key() ^ MATE_KEY_SALT;
+    TTEntry entry;
+    Move ttMove = NO_MOVE;
+    if (table.probe(key, entry))
+    {
+        ttMove = entry.move;
+        int16_t score = scoreFromTT(entry.score, ply);
+        // A mate found with more plies to spare may be too long for this node
+        bool fits = abs(entry.score) < MATE_BOUND || MATE_SCORE - abs(entry.score) <= depth;
+        if (tableCutoffs && entry.depth >= depth && fits &&
+            (entry.bound == TT_EXACT || (entry.bound == TT_LOWER && score >= beta) ||
+             (entry.bound == TT_UPPER && score <= alpha)))
+            return score;
+    }
+
+    bool attacker = depth & 1;
+    CheckInfo info;
+    if (attacker)
+        computeCheckInfo(board, side, info);
+
+    int16_t originalAlpha = alpha;
+    int16_t best = -MATE_SCORE;
+    Move bestMove = NO_MOVE;
+    bool anyMove = false;
+
+    // Returns true to stop: beta reached or out of nodes
+    auto tryMove = [&](Move m)
+    {
+        if (attacker && !givesCheck(board, info, m))
+            return false;
+        if (leavesKingInCheck(board, m, side))
+            return false;
+        anyMove = true;
+
+        Position child = position;
+        child.makeMove(m);
+        int16_t score = -search(child, depth - 1, ply + 1, -beta, -alpha);
+        if (aborted)
+            return true;
+        if (score > best)
+        {
+            best = score;
+            bestMove = m;
+        }
+        if (score > alpha)
+        {
+            alpha = score;
+            pv[ply][0] = m;
+            memcpy(&pv[ply][1], pv[ply + 1], pvLength[ply + 1] * sizeof(Move));
+            pvLength[ply] = pvLength[ply + 1] + 1;
+        }
+        return alpha >= beta;
+    };
+
+    bool stopped = false;
+    if (ttMove != NO_MOVE && isPseudoLegal(board, side, position.castlingRights, position.epSquare, ttMove))
+        stopped = tryMove(ttMove);
+    if (!stopped)
+    {
+        auto others = [&](Move m)
+        { return m != ttMove && tryMove(m); };
+        generateMoves(board, side, position.castlingRights, position.epSquare, others);
+    }
+    if (aborted)
+        return 0;
+
+    if (!anyMove)
+    {
+        // Attacker out of checks: no mate this way. Defender without a
+        // move: mated (the attacker only gives check).
+        if (attacker || !position.inCheck())
+            return 0;
+        return -MATE_SCORE + ply;
+    }
+
+    TTBound bound = best <= originalAlpha ? TT_UPPER : best >= beta ? TT_LOWER : TT_EXACT;
+    table.store(key, bestMove, scoreToTT(best, ply), depth, bound);
+    return best;
+}
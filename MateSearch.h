@@ -0,0 +1,67 @@
+#ifndef MATESEARCH_H
+#define MATESEARCH_H
+
+#include <Arduino.h>
+#include "Position.h"
+#include "TranspositionTable.h"
+
+// Forced-mate solver for puzzle mode and hints. The attacker only tries
+// checking moves, the defender every legal reply (in check, these are all
+// evasions), so the tree stays small enough for the AVR. Depth-limited
+// alpha-beta with a mate-distance window: the window starts at "any mate",
+// narrows to the shortest mate found so far, and a defender stops at its
+// first reply that escapes. Deepened one move at a time, so the first mate
+// found is the shortest.
+//
+// Mates that need a quiet move are not found (the puzzles are chosen to
+// need checks only).
+
+#ifndef MATE_MAX_MOVES
+#define MATE_MAX_MOVES 4 // mate in 4: 7 plies of recursion
+#endif
+#define MATE_MAX_PLIES (2 * MATE_MAX_MOVES - 1)
+
+// Mate results in the shared table are salted apart from other searches:
+// "no mate within n" is not an evaluation
+#define MATE_KEY_SALT hashMix(2000)
+
+struct MateResult
+{
+  uint8_t mateIn;            // attacker moves to mate, 0 if none was found
+  uint8_t lineLength;        // plies in line
+  Move line[MATE_MAX_PLIES]; // attacker's moves and the longest defence
+  uint32_t nodes;
+  bool aborted; // node limit hit: a longer mate may still exist
+};
+
+class MateSearch
+{
+public:
+  explicit MateSearch(TranspositionTable &table);
+
+  void setNodeLimit(uint32_t nodes) { nodeLimit = nodes; } // 0: unlimited
+
+  // Shortest mate in at most maxMoves for the side to move
+  bool solve(const Position &position, uint8_t maxMoves, MateResult &result);
+
+  // Puzzle mode: whether the player's move (any legal move) still forces
+  // mate within mateIn moves, counting the move itself
+  bool forcesMate(const Position &position, Move move, uint8_t mateIn);
+
+  uint32_t getNodes() const { return nodes; }
+
+private:
+  TranspositionTable &table;
+  uint32_t nodes;
+  uint32_t nodeLimit;
+  bool aborted;
+  bool tableCutoffs; // off while completing a line
+
+  // Principal variation: line from each ply down
+  Move pv[MATE_MAX_PLIES + 1][MATE_MAX_PLIES];
+  uint8_t pvLength[MATE_MAX_PLIES + 1];
+
+  int16_t search(const Position &position, uint8_t depth, uint8_t ply, int16_t alpha, int16_t beta);
+};
+
+#endif
@@ -0,0 +1,43 @@
+#include "Material.h"
+
+// What a side can mate with, once pawns, rooks and queens are ruled out
+enum MinorClass
+{
+    MINOR_NONE,
+    MINOR_KNIGHT,
+    MINOR_LIGHT_BISHOP,
+    MINOR_DARK_BISHOP,
+    MINOR_TWO_KNIGHTS,
+    MINOR_MATING // anything else (includes pawns, rooks and queens)
+};
+
+// Row: white's class. Bit n set: drawn against black class n.
+static const uint8_t insufficientPairs[6] PROGMEM = {
+    0x1F, // bare king: vs bare king, one minor or two knights
+    0x0F, // knight: vs bare king, knight or one bishop
+    0x07, // light bishop: vs bare king, knight or light bishop
+    0x0B, // dark bishop: vs bare king, knight or dark bishop
+    0x01, // two knights: vs bare king
+    0x00};
+
+static MinorClass minorClass(uint32_t side)
+{
+    // Nibbles 0, 1 and 4: pawns, rooks, queens
+    if (side & 0x000F00FFUL)
+        return MINOR_MATING;
+
+    uint8_t knights = (side >> (KNIGHT * 4)) & 0x0F;
+    uint8_t bishops = (side >> (BISHOP * 4)) & 0x0F;
+    if (bishops == 0)
+        return knights == 0 ? MINOR_NONE : knights == 1 ? MINOR_KNIGHT : knights == 2 ? MINOR_TWO_KNIGHTS : MINOR_MATING;
+    if (bishops == 1 && knights == 0)
+        return ((side >> (MATERIAL_LIGHT_BISHOP_NIBBLE * 4)) & 0x0F) ? MINOR_LIGHT_BISHOP : MINOR_DARK_BISHOP;
+    return MINOR_MATING;
+}
+
+bool isInsufficientMaterial(MaterialKey key)
+{
+    MinorClass white = minorClass((uint32_t)key);
+    MinorClass black = minorClass((uint32_t)(key >> 32));
+    return (pgm_read_byte(&insufficientPairs[white]) >> black) & 1;
+}
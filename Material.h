@@ -0,0 +1,55 @@
+#ifndef MATERIAL_H
+#define MATERIAL_H
+
+#include <Arduino.h>
+#include "ChessTypes.h"
+
+// Material signature, kept up to date by the board backend on every put and
+// remove. Each colour owns 32 bits (white low, black high) holding one 4-bit
+// count per PieceType at nibble PieceType, then the light- and dark-square
+// bishop counts in nibbles 6 and 7.
+typedef uint64_t MaterialKey;
+
+#define MATERIAL_LIGHT_BISHOP_NIBBLE 6
+#define MATERIAL_DARK_BISHOP_NIBBLE 7
+// Piece counts only: drops the bishop square colours
+#define MATERIAL_COUNT_MASK 0x00FFFFFF00FFFFFFULL
+
+inline bool isLightSquare(Square sq) { return ((sq >> 3) + (sq & 7)) & 1; }
+
+// Amount a piece on sq adds to the key
+inline MaterialKey materialDelta(PieceCode piece, Square sq)
+{
+  uint8_t base = pieceColor(piece) * 32;
+  MaterialKey delta = (MaterialKey)1 << (base + pieceType(piece) * 4);
+  if (pieceType(piece) == BISHOP)
+  {
+    uint8_t nibble = isLightSquare(sq) ? MATERIAL_LIGHT_BISHOP_NIBBLE : MATERIAL_DARK_BISHOP_NIBBLE;
+    delta += (MaterialKey)1 << (base + nibble * 4);
+  }
+  return delta;
+}
+
+inline uint8_t materialCount(MaterialKey key, PieceColor color, PieceType type)
+{
+  return (uint8_t)(key >> (color * 32 + type * 4)) & 0x0F;
+}
+
+// A count is a nibble: the backends refuse a 16th piece of one type and
+// colour (possible by hand or FEN, e.g. a side without a king), which would
+// carry into the next count
+#define MATERIAL_MAX_COUNT 15
+
+inline bool materialHasRoom(MaterialKey key, PieceCode piece)
+{
+  return materialCount(key, pieceColor(piece), pieceType(piece)) < MATERIAL_MAX_COUNT;
+}
+
+// Same material with the colours swapped
+inline MaterialKey mirrorMaterial(MaterialKey key) { return (key >> 32) | (key << 32); }
+
+// True when neither side can ever force mate (no board access: one table
+// lookup per side's minor-piece class)
+bool isInsufficientMaterial(MaterialKey key);
+
+#endif
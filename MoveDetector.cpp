@@ -0,0 +1,111 @@
+#include "MoveDetector.h"
+
+uint64_t occupancyOf(const Position &position)
+{
+    uint64_t bits = 0;
+    for (uint8_t color = WHITE; color <= BLACK; color++)
+    {
+        BoardBackend::PieceIterator it = position.board.pieces((PieceColor)color);
+        Square sq;
+        while (it.next(sq))
+        {
+            bits |= 1ULL << sq;
+        }
+    }
+    return bits;
+}
+
+// Occupancy after m, which must be legal in a position with this occupancy
+static uint64_t occupancyAfter(uint64_t occupied, Move m)
+{
+    Square from = moveFrom(m);
+    Square to = moveTo(m);
+    occupied = (occupied & ~(1ULL << from)) | (1ULL << to);
+    if (moveFlag(m) == MOVE_EN_PASSANT)
+        occupied &= ~(1ULL << enPassantVictim(m));
+    else if (moveFlag(m) == MOVE_CASTLING)
+        occupied ^= moveSquares(m) & ~((1ULL << from) | (1ULL << to));
+    return occupied;
+}
+
+// A rook going where castling would put it, with that castling still allowed
+static bool startsCastling(const Position &position, Move m)
+{
+    Square from = moveFrom(m);
+    Square to = moveTo(m);
+    if (moveFlag(m) != MOVE_NORMAL || pieceType(position.board.pieceAt(from)) != ROOK)
+        return false;
+    if (!(position.castlingRights & castlingRightsLost(from)))
+        return false;
+    return to == ((from & 7) ? from - 2 : from + 3);
+}
+
+MoveDetector::MoveDetector() : occupied(0), touched(0), deferred(NO_MOVE), deferredSince(0)
+{
+}
+
+void MoveDetector::reset(uint64_t occupiedNow)
+{
+    occupied = occupiedNow;
+    touched = 0;
+    deferred = NO_MOVE;
+}
+
+void MoveDetector::sense(const SensorEvent &event)
+{
+    uint64_t bit = 1ULL << event.square;
+    occupied = event.placed ? occupied | bit : occupied & ~bit;
+    touched |= bit;
+}
+
+void MoveDetector::resync(uint64_t occupiedNow)
+{
+    occupied = occupiedNow;
+    touched = ~0ULL; // whatever was lifted meanwhile
+}
+
+Move MoveDetector::detect(const Position &position, unsigned long now)
+{
+    uint64_t before = occupancyOf(position);
+    if (occupied == before)
+    {
+        deferred = NO_MOVE;
+        return NO_MOVE;
+    }
+
+    Move found = NO_MOVE;
+    uint8_t matches = 0;
+    auto match = [&](Move m)
+    {
+        if (moveFlag(m) == MOVE_PROMOTION && movePromotion(m) != PROMOTE_QUEEN)
+            return false;
+        if (occupancyAfter(before, m) != occupied)
+            return false;
+        Square to = moveTo(m);
+        if (position.board.pieceAt(to) != NO_PIECE && !(touched & (1ULL << to)))
+            return false;
+        if (leavesKingInCheck(position.board, m, position.sideToMove))
+            return false;
+        found = m;
+        return ++matches > 1;
+    };
+    generateMoves(position.board, position.sideToMove, position.castlingRights, position.epSquare, match);
+    if (matches != 1)
+    {
+        deferred = NO_MOVE;
+        return NO_MOVE;
+    }
+
+    if (startsCastling(position, found))
+    {
+        if (deferred != found)
+        {
+            deferred = found;
+            deferredSince = now;
+        }
+        if (now - deferredSince < MOVE_DETECT_SETTLE_MS)
+            return NO_MOVE;
+    }
+    deferred = NO_MOVE;
+    return found;
+}
@@ -0,0 +1,62 @@
+#ifndef MOVEDETECTOR_H
+#define MOVEDETECTOR_H
+
+#include <Arduino.h>
+#include "Position.h"
+#include "SensorMatrix.h"
+
+// Works out the move played from what the sensors report. The switches only
+// say whether a square is occupied, so the detector keeps the physical
+// occupancy up to date from lift/place events and looks for the one legal
+// move whose resulting occupancy it equals:
+//
+//   - captures leave the same occupancy whatever the target, so a capture
+//     only counts if its target square saw a lift or place since the last
+//     move (the taken piece coming off)
+//   - castling and en passant match once the rook or the taken pawn has
+//     been dealt with too
+//   - a promotion is taken as a queen (the sensors can't tell the pieces
+//     apart)
+//   - a rook moving to its castling square while that castling is still
+//     possible could be the first half of castling: it is only taken after
+//     MOVE_DETECT_SETTLE_MS without the king following
+//
+// While the pieces match no legal move (a piece in the hand, or an illegal
+// move made on the board) nothing is detected; physical() against the
+// position shows which squares differ.
+
+#ifndef MOVE_DETECT_SETTLE_MS
+#define MOVE_DETECT_SETTLE_MS 600
+#endif
+
+class MoveDetector
+{
+public:
+  MoveDetector();
+
+  // Starts over from the switches as they stand
+  void reset(uint64_t occupied);
+  void sense(const SensorEvent &event);
+  // After lost events (SensorMatrix::takeOverflow()): the switches as they are now
+  void resync(uint64_t occupied);
+
+  // The move the pieces now show in position, NO_MOVE if none (yet). Call
+  // it after events and, while waiting() is true, every pass.
+  Move detect(const Position &position, unsigned long now);
+  // The move detected was played: the next one starts
+  void accept() { touched = 0; }
+
+  uint64_t physical() const { return occupied; }
+  bool waiting() const { return deferred != NO_MOVE; }
+
+private:
+  uint64_t occupied;
+  uint64_t touched; // squares with events since the last move
+  Move deferred;    // a possible first half of castling
+  unsigned long deferredSince;
+};
+
+// Occupied squares of a position, bit sq set
+uint64_t occupancyOf(const Position &position);
+
+#endif
@@ -0,0 +1,4 @@
+#include "MoveGen.h"
+
+const int8_t knightOffsets88[8] PROGMEM = {33, 31, 18, 14, -14, -18, -31, -33};
+const int8_t kingOffsets88[8] PROGMEM = {16, 1, -16, -1, 17, -15, -17, 15};
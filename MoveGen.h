@@ -0,0 +1,419 @@
+#ifndef MOVEGEN_H
+#define MOVEGEN_H
+
+#include <Arduino.h>
+#include "BoardBackend.h"
+#include "Geometry.h"
+
+// Move generation and make-move written once against the BoardBackend
+// interface, so the same code runs on the AVR mailbox and host bitboards.
+// The work is templated on the side to move (Side<Us> in ChessTypes.h):
+// each colour gets its own code with pawn directions, ranks and castling
+// squares folded in as constants, and the entry points branch on the
+// colour once per call rather than inside the loops.
+
+// Square of the pawn removed by an en passant capture
+inline Square enPassantVictim(Move m) { return (moveFrom(m) & 0x38) | (moveTo(m) & 7); }
+
+template <PieceColor Us, class Backend, class Visitor>
+bool generatePawnMoves(const Backend &board, Square from, Square epSquare, Visitor &visit)
+{
+    uint8_t x = toX88(from);
+    if ((x + Side<Us>::up88) & 0x88)
+        return false; // pawn on the last rank (only in hand-made setups)
+
+    bool promotes = (from >> 3) == Side<Us>::seventhRank;
+    Square targets[3];
+    uint8_t n = 0;
+
+    Square ahead = from + Side<Us>::up;
+    if (board.pieceAt(ahead) == NO_PIECE)
+    {
+        targets[n++] = ahead;
+        if ((from >> 3) == Side<Us>::pawnRank && board.pieceAt(ahead + Side<Us>::up) == NO_PIECE)
+        {
+            if (visit(makeMove(from, ahead + Side<Us>::up)))
+                return true;
+        }
+    }
+    for (int8_t side88 = -1; side88 <= 1; side88 += 2)
+    {
+        uint8_t t = x + Side<Us>::up88 + side88;
+        if (t & 0x88)
+            continue;
+        Square to = fromX88(t);
+        PieceCode target = board.pieceAt(to);
+        if (target != NO_PIECE && pieceColor(target) == Side<Us>::them)
+            targets[n++] = to;
+        else if (target == NO_PIECE && to == epSquare)
+        {
+            if (visit(makeMove(from, to, MOVE_EN_PASSANT)))
+                return true;
+        }
+    }
+
+    for (uint8_t i = 0; i < n; i++)
+    {
+        if (!promotes)
+        {
+            if (visit(makeMove(from, targets[i])))
+                return true;
+            continue;
+        }
+        for (uint8_t p = PROMOTE_QUEEN; p <= PROMOTE_KNIGHT; p++)
+        {
+            if (visit(makeMove(from, targets[i], MOVE_PROMOTION, (PromotionType)p)))
+                return true;
+        }
+    }
+    return false;
+}
+
+// Knight and king: one step along each of eight offsets
+template <PieceColor Us, class Backend, class Visitor>
+bool generateStepMoves(const Backend &board, Square from, const int8_t *offsets, Visitor &visit)
+{
+    uint8_t x = toX88(from);
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        uint8_t t = x + (int8_t)pgm_read_byte(&offsets[i]);
+        if (t & 0x88)
+            continue;
+        PieceCode target = board.pieceAt(fromX88(t));
+        if ((target == NO_PIECE || pieceColor(target) == Side<Us>::them) && visit(makeMove(from, fromX88(t))))
+            return true;
+    }
+    return false;
+}
+
+// Sliders: rook uses the straight half of the king offsets (first..last),
+// bishop the diagonal half, queen all eight
+template <PieceColor Us, class Backend, class Visitor>
+bool generateSliderMoves(const Backend &board, Square from, uint8_t first, uint8_t last, Visitor &visit)
+{
+    uint8_t x = toX88(from);
+    for (uint8_t i = first; i < last; i++)
+    {
+        int8_t step = (int8_t)pgm_read_byte(&kingOffsets88[i]);
+        for (uint8_t t = x + step; !(t & 0x88); t += step)
+        {
+            PieceCode target = board.pieceAt(fromX88(t));
+            if (target != NO_PIECE && pieceColor(target) == Us)
+                break;
+            if (visit(makeMove(from, fromX88(t))))
+                return true;
+            if (target != NO_PIECE)
+                break;
+        }
+    }
+    return false;
+}
+
+// Castling: king and rook on their home squares, rights intact, the
+// squares between them empty and the king's path not attacked
+template <PieceColor Us, class Backend, class Visitor>
+bool generateCastling(const Backend &board, uint8_t castling, Visitor &visit)
+{
+    const Square home = Side<Us>::kingHome;
+    const PieceColor them = Side<Us>::them;
+    if (!(castling & (Side<Us>::kingSide | Side<Us>::queenSide)) || board.pieceAt(home) != makePiece(KING, Us) ||
+        board.isAttacked(home, them))
+        return false;
+
+    PieceCode rook = makePiece(ROOK, Us);
+    if ((castling & Side<Us>::kingSide) && board.pieceAt(home + 3) == rook &&
+        board.pieceAt(home + 1) == NO_PIECE && board.pieceAt(home + 2) == NO_PIECE &&
+        !board.isAttacked(home + 1, them) && !board.isAttacked(home + 2, them))
+    {
+        if (visit(makeMove(home, home + 2, MOVE_CASTLING)))
+            return true;
+    }
+    if ((castling & Side<Us>::queenSide) && board.pieceAt(home - 4) == rook &&
+        board.pieceAt(home - 1) == NO_PIECE && board.pieceAt(home - 2) == NO_PIECE &&
+        board.pieceAt(home - 3) == NO_PIECE &&
+        !board.isAttacked(home - 1, them) && !board.isAttacked(home - 2, them))
+    {
+        if (visit(makeMove(home, home - 2, MOVE_CASTLING)))
+            return true;
+    }
+    return false;
+}
+
+template <PieceColor Us, class Backend, class Visitor>
+bool generateMovesFor(const Backend &board, uint8_t castling, Square epSquare, Visitor &visit)
+{
+    typename Backend::PieceIterator it = board.pieces(Us);
+    Square from;
+    while (it.next(from))
+    {
+        bool stop;
+        switch (pieceType(board.pieceAt(from)))
+        {
+        case PAWN:
+            stop = generatePawnMoves<Us>(board, from, epSquare, visit);
+            break;
+        case KNIGHT:
+            stop = generateStepMoves<Us>(board, from, knightOffsets88, visit);
+            break;
+        case KING:
+            stop = generateStepMoves<Us>(board, from, kingOffsets88, visit);
+            break;
+        case ROOK:
+            stop = generateSliderMoves<Us>(board, from, 0, 4, visit);
+            break;
+        case BISHOP:
+            stop = generateSliderMoves<Us>(board, from, 4, 8, visit);
+            break;
+        default:
+            stop = generateSliderMoves<Us>(board, from, 0, 8, visit);
+            break;
+        }
+        if (stop)
+            return true;
+    }
+    return generateCastling<Us>(board, castling, visit);
+}
+
+// Calls visit(move) for every pseudo-legal move of side. Castling is fully
+// validated here (rights, empty path, no attacked square on the king's way);
+// everything else still has to pass leavesKingInCheck(). Returns true as soon
+// as visit returns true.
+template <class Backend, class Visitor>
+bool generateMoves(const Backend &board, PieceColor side, uint8_t castling, Square epSquare, Visitor &visit)
+{
+    if (side == WHITE)
+        return generateMovesFor<WHITE>(board, castling, epSquare, visit);
+    return generateMovesFor<BLACK>(board, castling, epSquare, visit);
+}
+
+// Plays m on the board (captures, en passant, promotion and the castling
+// rook included). Returns the captured piece, NO_PIECE if none.
+template <class Backend>
+PieceCode applyMove(Backend &board, Move m)
+{
+    Square from = moveFrom(m);
+    Square to = moveTo(m);
+    MoveFlag flag = moveFlag(m);
+    PieceColor color = pieceColor(board.pieceAt(from));
+
+    Square victim = flag == MOVE_EN_PASSANT ? enPassantVictim(m) : to;
+    PieceCode captured = board.pieceAt(victim);
+    if (captured != NO_PIECE)
+        board.remove(victim);
+
+    board.move(from, to);
+
+    if (flag == MOVE_PROMOTION)
+    {
+        board.remove(to);
+        board.put(to, makePiece(promotionPieceType(movePromotion(m)), color));
+    }
+    else if (flag == MOVE_CASTLING)
+    {
+        if (to > from)
+            board.move(to + 1, to - 1); // H-file rook to F
+        else
+            board.move(to - 2, to + 1); // A-file rook to D
+    }
+    return captured;
+}
+
+// Bit sq set for every square applyMove() changes: from, to, the pawn taken
+// en passant and the castling rook's two squares. Taking the move back
+// (restoring the copied Position) changes the same squares.
+inline uint64_t moveSquares(Move m)
+{
+    Square from = moveFrom(m);
+    Square to = moveTo(m);
+    uint64_t squares = (1ULL << from) | (1ULL << to);
+    if (moveFlag(m) == MOVE_EN_PASSANT)
+        squares |= 1ULL << enPassantVictim(m);
+    else if (moveFlag(m) == MOVE_CASTLING)
+        squares |= to > from ? (1ULL << (to + 1)) | (1ULL << (to - 1)) : (1ULL << (to - 2)) | (1ULL << (to + 1));
+    return squares;
+}
+
+// Precomputed once per position for the side about to move, then reused by
+// givesCheck() for every move tried in it
+struct CheckInfo
+{
+    Square kingSquare;        // the king that would be checked, NO_SQUARE if none
+    uint8_t candidateCount;   // mover's pieces that shield that king from a mover's slider
+    Square candidates[8];     // leaving these squares can give a discovered check
+    int8_t candidateStep[8];  // 0x88 step from the king through each candidate
+};
+
+template <class Backend>
+void computeCheckInfo(const Backend &board, PieceColor side, CheckInfo &info)
+{
+    info.kingSquare = board.kingSquare(opponent(side));
+    info.candidateCount = 0;
+    if (info.kingSquare == NO_SQUARE)
+        return;
+
+    uint8_t king = toX88(info.kingSquare);
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        int8_t step = (int8_t)pgm_read_byte(&kingOffsets88[i]);
+        uint8_t t = king + step;
+        while (!(t & 0x88) && board.pieceAt(fromX88(t)) == NO_PIECE)
+            t += step;
+        if ((t & 0x88) || pieceColor(board.pieceAt(fromX88(t))) != side)
+            continue;
+
+        uint8_t shield = t;
+        for (t += step; !(t & 0x88) && board.pieceAt(fromX88(t)) == NO_PIECE; t += step)
+            ;
+        if (t & 0x88)
+            continue;
+        // Offsets 0-3 are straight lines, 4-7 diagonals
+        PieceCode slider = board.pieceAt(fromX88(t));
+        PieceType type = pieceType(slider);
+        if (pieceColor(slider) == side && (type == QUEEN || type == (i < 4 ? ROOK : BISHOP)))
+        {
+            info.candidates[info.candidateCount] = fromX88(shield);
+            info.candidateStep[info.candidateCount++] = step;
+        }
+    }
+}
+
+// True if a piece of type and color standing on from attacks target, with
+// vacated treated as empty (the square the piece has just left)
+template <class Backend>
+bool pieceAttacksSquare(const Backend &board, PieceType type, PieceColor color, Square from, Square target, Square vacated)
+{
+    uint8_t delta = deltaIndex88(from, target);
+    if (type == KING || !(deltaAttackers88(delta) & attackBit(type, color)))
+        return false; // a king never gives check
+    if (type == PAWN || type == KNIGHT)
+        return true;
+
+    int8_t step = deltaStep88(delta);
+    for (Square s = from + step; s != target; s += step)
+    {
+        if (s != vacated && board.pieceAt(s) != NO_PIECE)
+            return false;
+    }
+    return true;
+}
+
+// True if m (pseudo-legal for the side info was computed for) checks the
+// opposing king. Decided before m is played.
+template <class Backend>
+bool givesCheck(const Backend &board, const CheckInfo &info, Move m)
+{
+    if (info.kingSquare == NO_SQUARE)
+        return false;
+
+    Square from = moveFrom(m);
+    Square to = moveTo(m);
+    MoveFlag flag = moveFlag(m);
+    PieceCode piece = board.pieceAt(from);
+
+    // Castling moves the rook as well and en passant empties two squares:
+    // both are rare enough to simply play on a copy
+    if (flag == MOVE_CASTLING || flag == MOVE_EN_PASSANT)
+    {
+        Backend after = board;
+        applyMove(after, m);
+        return after.isAttacked(info.kingSquare, pieceColor(piece));
+    }
+
+    // Direct check from the destination (a promoted pawn checks as its new piece)
+    PieceType type = flag == MOVE_PROMOTION ? promotionPieceType(movePromotion(m)) : pieceType(piece);
+    if (pieceAttacksSquare(board, type, pieceColor(piece), to, info.kingSquare, from))
+        return true;
+
+    // Discovered check, unless the piece stays on the line it was shielding
+    for (uint8_t i = 0; i < info.candidateCount; i++)
+    {
+        if (info.candidates[i] != from)
+            continue;
+        for (uint8_t t = toX88(info.kingSquare) + info.candidateStep[i]; !(t & 0x88); t += info.candidateStep[i])
+        {
+            if (fromX88(t) == to)
+                return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+template <class Backend>
+bool givesCheck(const Backend &board, Move m)
+{
+    CheckInfo info;
+    computeCheckInfo(board, pieceColor(board.pieceAt(moveFrom(m))), info);
+    return givesCheck(board, info, m);
+}
+
+template <PieceColor Us, class Backend>
+bool isPseudoLegalFor(const Backend &board, uint8_t castling, Square epSquare, Move m)
+{
+    Square from = moveFrom(m);
+    Square to = moveTo(m);
+    MoveFlag flag = moveFlag(m);
+    PieceCode piece = board.pieceAt(from);
+    if (piece == NO_PIECE || pieceColor(piece) != Us || from == to)
+        return false;
+    PieceCode target = board.pieceAt(to);
+    if (target != NO_PIECE && pieceColor(target) == Us)
+        return false;
+    if (flag != MOVE_PROMOTION && movePromotion(m) != PROMOTE_QUEEN)
+        return false;
+
+    PieceType type = pieceType(piece);
+    if (flag == MOVE_CASTLING)
+    {
+        // Rare: let the generator's full castling checks decide
+        if (type != KING)
+            return false;
+        auto isThisMove = [m](Move generated)
+        { return generated == m; };
+        return generateCastling<Us>(board, castling, isThisMove);
+    }
+
+    if (type == PAWN)
+    {
+        if (((to >> 3) == Side<Us>::lastRank) != (flag == MOVE_PROMOTION))
+            return false;
+        if (to == from + Side<Us>::up)
+            return target == NO_PIECE && flag != MOVE_EN_PASSANT;
+        if (to == from + 2 * Side<Us>::up)
+            return target == NO_PIECE && flag == MOVE_NORMAL && (from >> 3) == Side<Us>::pawnRank &&
+                   board.pieceAt(from + Side<Us>::up) == NO_PIECE;
+        if (!(deltaAttackers88(deltaIndex88(from, to)) & Side<Us>::pawnAttackBit))
+            return false;
+        if (flag == MOVE_EN_PASSANT)
+            return to == epSquare && target == NO_PIECE;
+        return target != NO_PIECE;
+    }
+
+    if (flag != MOVE_NORMAL)
+        return false;
+    if (type == KING)
+        return (deltaAttackers88(deltaIndex88(from, to)) & (1 << KING)) != 0;
+    return pieceAttacksSquare(board, type, Us, from, to, NO_SQUARE);
+}
+
+// True if m is one of the moves generateMoves() would produce for side,
+// without generating the others. Moves must be encoded exactly as the
+// generator does (flags set, promotion bits zero unless promoting).
+template <class Backend>
+bool isPseudoLegal(const Backend &board, PieceColor side, uint8_t castling, Square epSquare, Move m)
+{
+    if (side == WHITE)
+        return isPseudoLegalFor<WHITE>(board, castling, epSquare, m);
+    return isPseudoLegalFor<BLACK>(board, castling, epSquare, m);
+}
+
+// True if playing m would leave side's own king attacked
+template <class Backend>
+bool leavesKingInCheck(const Backend &board, Move m, PieceColor side)
+{
+    Backend after = board;
+    applyMove(after, m);
+    return after.isAttacked(after.kingSquare(side), opponent(side));
+}
+
+#endif
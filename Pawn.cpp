@@ -1,4 +1,5 @@
 #include "Pawn.h"
+#include "ChessTypes.h"
 #include <Arduino.h>
 
 Pawn::Pawn(PieceColor color) : Piece(PAWN, color) {}
@@ -8,7 +9,7 @@ const char* Pawn::getTypeName() {
 }
 
 bool Pawn::canMove(int fromRow, char fromCol, int toRow, char toCol) {
-    int dir = (_color == WHITE) ? 1 : -1;
+    int dir = pawnDirection(_color);
     int rowDiff = toRow - fromRow;
     int colDiff = toCol - fromCol;
 
@@ -16,7 +17,7 @@ bool Pawn::canMove(int fromRow, char fromCol, int toRow, char toCol) {
     if(rowDiff == dir && colDiff == 0) return true;
 
     // 2-square initial move
-    if((_color == WHITE && fromRow == 2 || _color == BLACK && fromRow == 7) &&
+    if(fromRow == 2 + 5 * _color && // rank 2 for white, 7 for black
        rowDiff == 2*dir && colDiff == 0) return true;
 
     // Diagonal capture
@@ -0,0 +1,118 @@
+#include "Perf.h"
+
+#if defined(__AVR__) && defined(SMARTCHESS_PERF_CYCLES)
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#elif defined(SMARTCHESS_PERF_CYCLES) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+#if defined(__AVR__) && defined(SMARTCHESS_PERF_CYCLES)
+
+// Timer1 counts every CPU cycle; its overflows extend it to 32 bits
+static volatile uint16_t timerOverflows;
+static bool timerStarted;
+
+ISR(TIMER1_OVF_vect)
+{
+    timerOverflows++;
+}
+
+static void startTimer()
+{
+    TCCR1A = 0;
+    TCCR1B = _BV(CS10); // normal mode, no prescaler
+    TCNT1 = 0;
+    TIFR1 = _BV(TOV1);
+    TIMSK1 = _BV(TOIE1);
+    timerStarted = true;
+}
+
+uint32_t perfTicks()
+{
+    if (!timerStarted)
+        startTimer();
+    uint16_t high, low;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        low = TCNT1;
+        high = timerOverflows;
+        // Overflowed after interrupts went off: the ISR hasn't counted it yet
+        if ((TIFR1 & _BV(TOV1)) && low < 0x8000)
+            high++;
+    }
+    return ((uint32_t)high << 16) | low;
+}
+
+#elif defined(SMARTCHESS_PERF_CYCLES) && (defined(__x86_64__) || defined(__i386__))
+
+uint32_t perfTicks()
+{
+    return (uint32_t)__rdtsc();
+}
+
+#else
+
+uint32_t perfTicks()
+{
+    return micros();
+}
+
+#endif
+
+#ifdef SMARTCHESS_PERF
+
+PerfStats perfStats;
+
+static const char *const counterNames[PERF_COUNTER_COUNT] = {
+    "movePiece", "updateGameState", "hasAnyValidMove", "isSquareAttacked", "isPathClear", "isMoveLegal"};
+
+const PerfStats &getPerfStats()
+{
+    return perfStats;
+}
+
+void resetPerfStats()
+{
+    memset(&perfStats, 0, sizeof(perfStats));
+}
+
+// Serial has no 64-bit print
+static void printTicks(uint64_t ticks)
+{
+    if (ticks >= 1000000000ULL)
+    {
+        Serial.print((unsigned long)(ticks / 1000000000ULL));
+        unsigned long low = (unsigned long)(ticks % 1000000000ULL);
+        for (unsigned long digit = 100000000UL; digit > 1 && low < digit; digit /= 10)
+        {
+            Serial.print('0');
+        }
+        Serial.print(low);
+    }
+    else
+    {
+        Serial.print((unsigned long)ticks);
+    }
+}
+
+void printPerfStats()
+{
+    Serial.println("perf (" PERF_TICK_UNIT "): calls total max mean");
+    for (uint8_t i = 0; i < PERF_COUNTER_COUNT; i++)
+    {
+        const PerfCounterStats &stats = perfStats.counters[i];
+        Serial.print(counterNames[i]);
+        Serial.print(' ');
+        Serial.print((unsigned long)stats.calls);
+        Serial.print(' ');
+        printTicks(stats.totalTicks);
+        Serial.print(' ');
+        Serial.print((unsigned long)stats.maxTicks);
+        Serial.print(' ');
+        printTicks(stats.calls ? stats.totalTicks / stats.calls : 0);
+        Serial.println();
+    }
+}
+
+#endif
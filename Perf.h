@@ -0,0 +1,85 @@
+#ifndef PERF_H
+#define PERF_H
+
+#include <Arduino.h>
+
+// Optional call counters and timers for the board's hot paths. Define
+// SMARTCHESS_PERF to build them in; otherwise PERF_SCOPE() expands to nothing
+// and the counters don't exist in the binary. perfTicks() is always there
+// for benchmarks (the linker drops it when unused).
+//
+// Times are inclusive (movePiece() contains the isSquareAttacked() calls it
+// makes) and in PERF_TICK_UNIT: micros() by default (4 us steps on a 16 MHz
+// AVR), or CPU cycles with SMARTCHESS_PERF_CYCLES defined as well. On the AVR
+// the cycle counter takes over Timer1, so PWM on pins 9 and 10 and the Servo
+// library are unavailable in that build.
+
+#ifdef SMARTCHESS_PERF_CYCLES
+#define PERF_TICK_UNIT "cyc"
+#else
+#define PERF_TICK_UNIT "us"
+#endif
+
+uint32_t perfTicks();
+
+#ifdef SMARTCHESS_PERF
+
+enum PerfCounter
+{
+  PERF_MOVE_PIECE,
+  PERF_UPDATE_GAME_STATE,
+  PERF_HAS_ANY_VALID_MOVE,
+  PERF_IS_SQUARE_ATTACKED, // every attack test, isInCheck() and castling checks included
+  PERF_IS_PATH_CLEAR,
+  PERF_IS_MOVE_LEGAL, // the "would this leave my king in check" test
+  PERF_COUNTER_COUNT
+};
+
+struct PerfCounterStats
+{
+  uint32_t calls;
+  uint64_t totalTicks;
+  uint32_t maxTicks; // slowest single call
+};
+
+struct PerfStats
+{
+  PerfCounterStats counters[PERF_COUNTER_COUNT];
+};
+
+const PerfStats &getPerfStats();
+void resetPerfStats();
+void printPerfStats(); // one line per counter: name, calls, total, max, mean
+
+extern PerfStats perfStats;
+
+inline void perfRecord(PerfCounter counter, uint32_t ticks)
+{
+  PerfCounterStats &stats = perfStats.counters[counter];
+  stats.calls++;
+  stats.totalTicks += ticks;
+  if (ticks > stats.maxTicks)
+    stats.maxTicks = ticks;
+}
+
+// Times its own lifetime: the rest of the enclosing block
+class PerfScope
+{
+public:
+  explicit PerfScope(PerfCounter counter) : counter(counter), start(perfTicks()) {}
+  ~PerfScope() { perfRecord(counter, perfTicks() - start); }
+
+private:
+  PerfCounter counter;
+  uint32_t start;
+};
+
+#define PERF_SCOPE(counter) PerfScope perfScope_(counter)
+
+#else
+
+#define PERF_SCOPE(counter)
+
+#endif
+
+#endif
@@ -0,0 +1,137 @@
+#include "Position.h"
+
+void Position::clear()
+{
+    board.clear();
+    sideToMove = WHITE;
+    castlingRights = 0;
+    epSquare = NO_SQUARE;
+    halfMoveClock = 0;
+    fullMoveNumber = 1;
+}
+
+void Position::setStartPosition()
+{
+    static const PieceType backRank[8] = {ROOK, KNIGHT, BISHOP, QUEEN, KING, BISHOP, KNIGHT, ROOK};
+    clear();
+    for (Square file = 0; file < 8; file++)
+    {
+        board.put(file, makePiece(backRank[file], WHITE));
+        board.put(8 + file, makePiece(PAWN, WHITE));
+        board.put(48 + file, makePiece(PAWN, BLACK));
+        board.put(56 + file, makePiece(backRank[file], BLACK));
+    }
+    castlingRights = CASTLE_WHITE_KINGSIDE | CASTLE_WHITE_QUEENSIDE | CASTLE_BLACK_KINGSIDE | CASTLE_BLACK_QUEENSIDE;
+}
+
+static const char *skipSpaces(const char *text)
+{
+    while (*text == ' ')
+        text++;
+    return text;
+}
+
+bool Position::setFromFen(const char *fen)
+{
+    static const char pieceLetters[] = "prnbqk";
+    clear();
+
+    // Ranks 8 down to 1, files a to h
+    int8_t row = 7, file = 0;
+    const char *c = skipSpaces(fen);
+    for (; *c && *c != ' '; c++)
+    {
+        if (*c == '/')
+        {
+            if (file != 8 || row == 0)
+                break;
+            row--;
+            file = 0;
+        }
+        else if (*c >= '1' && *c <= '8')
+            file += *c - '0';
+        else
+        {
+            const char *letter = strchr(pieceLetters, tolower(*c));
+            if (!letter || file > 7)
+                break;
+            PieceColor color = isupper(*c) ? WHITE : BLACK;
+            if (!board.put(row * 8 + file, makePiece((PieceType)(letter - pieceLetters), color)))
+                break; // more pieces than a side can have
+            file++;
+        }
+        if (file > 8)
+            break;
+    }
+    if (*c != ' ' || row != 0 || file != 8)
+    {
+        clear();
+        return false;
+    }
+
+    c = skipSpaces(c);
+    if (*c != 'w' && *c != 'b')
+    {
+        clear();
+        return false;
+    }
+    sideToMove = *c++ == 'w' ? WHITE : BLACK;
+
+    c = skipSpaces(c);
+    for (; *c && *c != ' '; c++)
+    {
+        switch (*c)
+        {
+        case 'K':
+            castlingRights |= CASTLE_WHITE_KINGSIDE;
+            break;
+        case 'Q':
+            castlingRights |= CASTLE_WHITE_QUEENSIDE;
+            break;
+        case 'k':
+            castlingRights |= CASTLE_BLACK_KINGSIDE;
+            break;
+        case 'q':
+            castlingRights |= CASTLE_BLACK_QUEENSIDE;
+            break;
+        }
+    }
+
+    c = skipSpaces(c);
+    if (c[0] >= 'a' && c[0] <= 'h' && c[1] >= '1' && c[1] <= '8')
+    {
+        epSquare = (c[1] - '1') * 8 + (c[0] - 'a');
+        c += 2;
+    }
+    else if (*c == '-')
+        c++;
+
+    c = skipSpaces(c);
+    if (isdigit(*c))
+    {
+        halfMoveClock = (uint16_t)strtoul(c, (char **)&c, 10);
+        c = skipSpaces(c);
+        if (isdigit(*c))
+            fullMoveNumber = (uint16_t)strtoul(c, nullptr, 10);
+    }
+    return true;
+}
+
+HashKey Position::key() const
+{
+    HashKey key = board.pieceHash() ^ hashCastling(castlingRights);
+    if (epSquare != NO_SQUARE)
+        key ^= hashEnPassant(epSquare);
+    if (sideToMove == BLACK)
+        key ^= hashBlackToMove();
+    return key;
+}
+
+bool Position::hasLegalMove() const
+{
+    const BoardBackend &squares = board;
+    PieceColor side = sideToMove;
+    auto isLegal = [&squares, side](Move m)
+    { return !leavesKingInCheck(squares, m, side); };
+    return generateMoves(board, sideToMove, castlingRights, epSquare, isLegal);
+}
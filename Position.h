@@ -0,0 +1,105 @@
+#ifndef POSITION_H
+#define POSITION_H
+
+#include <Arduino.h>
+#include "BoardBackend.h"
+#include "MoveGen.h"
+#include "Hash.h"
+
+// Everything needed to continue a game from a position, in one plain value:
+// copying it (assignment or memcpy) is a complete snapshot. Engines and
+// analysis copy a Position and call makeMove() on the copy instead of
+// mutating the live game. Holds no pointers; about 100 bytes.
+struct Position
+{
+  BoardBackend board;
+  PieceColor sideToMove;
+  uint8_t castlingRights; // CastlingRight bits
+  Square epSquare;        // square a pawn can capture onto en passant, NO_SQUARE if none
+  uint16_t halfMoveClock; // plies since the last capture or pawn move
+  uint16_t fullMoveNumber;
+
+  void clear();
+  void setStartPosition();
+  // Forsyth-Edwards notation; the two clocks may be left out. False (and a
+  // cleared position) if the text is malformed or a side has more than
+  // MAX_PIECES_PER_SIDE pieces. Not checked for legality.
+  bool setFromFen(const char *fen);
+
+  // Full key: pieces (kept by the backend) plus side, castling and en passant
+  HashKey key() const;
+  bool inCheck() const { return board.isAttacked(board.kingSquare(sideToMove), opponent(sideToMove)); }
+  // Full check of an arbitrary move: one the generator would produce that
+  // doesn't leave the mover's king attacked
+  bool isLegal(Move m) const
+  {
+    return isPseudoLegal(board, sideToMove, castlingRights, epSquare, m) && !leavesKingInCheck(board, m, sideToMove);
+  }
+  bool hasLegalMove() const;
+
+  // Plays a pseudo-legal move and updates every field. Square edits go
+  // through editor: the backend itself, or a wrapper that keeps extra
+  // state (e.g. a TrackedBoard) in step. Returns the captured piece.
+  template <class Editor>
+  PieceCode makeMove(Editor &editor, Move m);
+  PieceCode makeMove(Move m) { return makeMove(board, m); }
+
+private:
+  template <PieceColor Us, class Editor>
+  PieceCode makeMoveAs(Editor &editor, Move m);
+};
+
+#if !defined(__AVR__)
+#include <type_traits>
+static_assert(std::is_trivially_copyable<Position>::value, "Position must stay a plain value");
+#endif
+
+// Castling rights lost when a piece leaves or lands on sq
+inline uint8_t castlingRightsLost(Square sq)
+{
+  switch (sq)
+  {
+  case 0:
+    return CASTLE_WHITE_QUEENSIDE;
+  case 4:
+    return CASTLE_WHITE_KINGSIDE | CASTLE_WHITE_QUEENSIDE;
+  case 7:
+    return CASTLE_WHITE_KINGSIDE;
+  case 56:
+    return CASTLE_BLACK_QUEENSIDE;
+  case 60:
+    return CASTLE_BLACK_KINGSIDE | CASTLE_BLACK_QUEENSIDE;
+  case 63:
+    return CASTLE_BLACK_KINGSIDE;
+  }
+  return 0;
+}
+
+template <class Editor>
+PieceCode Position::makeMove(Editor &editor, Move m)
+{
+  if (sideToMove == WHITE)
+    return makeMoveAs<WHITE>(editor, m);
+  return makeMoveAs<BLACK>(editor, m);
+}
+
+template <PieceColor Us, class Editor>
+PieceCode Position::makeMoveAs(Editor &editor, Move m)
+{
+  Square from = moveFrom(m);
+  Square to = moveTo(m);
+  bool pawnMove = pieceType(board.pieceAt(from)) == PAWN;
+
+  PieceCode captured = applyMove(editor, m);
+
+  halfMoveClock = (pawnMove || captured != NO_PIECE) ? 0 : halfMoveClock + 1;
+  // En passant is only possible right after a two-square pawn advance
+  epSquare = (pawnMove && to == from + 2 * Side<Us>::up) ? from + Side<Us>::up : NO_SQUARE;
+  // King or rook moves (and rooks captured at home) lose castling rights
+  castlingRights &= ~(castlingRightsLost(from) | castlingRightsLost(to));
+  fullMoveNumber += Us; // a new move number starts after black's move
+  sideToMove = Side<Us>::them;
+  return captured;
+}
+
+#endif
@@ -0,0 +1,101 @@
+#include "Protocol.h"
+
+uint16_t positionCheck(const Position &position)
+{
+    PackedPosition packed;
+    packPosition(position, packed);
+    uint16_t crc = 0xFFFF;
+    for (uint8_t i = 0; i < sizeof(packed.squares); i++)
+    {
+        crc = crc16Update(crc, packed.squares[i]);
+    }
+    crc = crc16Update(crc, packed.sideAndRights);
+    return crc16Update(crc, packed.epSquare);
+}
+
+void ProtocolEncoder::start(MessageType type)
+{
+    length = 0;
+    put(PROTOCOL_SYNC);
+    put(type);
+    put(sequence++);
+    put(0); // payload length, filled in by finish()
+}
+
+void ProtocolEncoder::finish()
+{
+    frame[3] = length - PROTOCOL_HEADER_BYTES;
+    uint16_t crc = 0xFFFF;
+    for (uint8_t i = 1; i < length; i++)
+    {
+        crc = crc16Update(crc, frame[i]);
+    }
+    put16(crc);
+}
+
+void ProtocolEncoder::position(const Position &position)
+{
+    PackedPosition packed;
+    packPosition(position, packed);
+    start(MSG_POSITION);
+    for (uint8_t i = 0; i < sizeof(packed.squares); i++)
+    {
+        put(packed.squares[i]);
+    }
+    put(packed.sideAndRights);
+    put(packed.epSquare);
+    put16(packed.halfMoveClock);
+    put16(packed.fullMoveNumber);
+    finish();
+}
+
+void ProtocolEncoder::move(Move m, const Position &after)
+{
+    start(MSG_MOVE);
+    put16(m);
+    put16(positionCheck(after));
+    finish();
+}
+
+void ProtocolEncoder::state(GameState state, const Position &position)
+{
+    start(MSG_STATE);
+    put(state);
+    put(position.sideToMove);
+    put(position.inCheck() ? 1 : 0);
+    finish();
+}
+
+void ProtocolEncoder::legalMoves(const Position &position)
+{
+    start(MSG_LEGAL_MOVES);
+    // Moves come piece by piece (castling last, from the king's square), so
+    // the entry for a move's square is usually the last one written
+    uint8_t *entries = frame + PROTOCOL_HEADER_BYTES;
+    auto add = [&](Move m)
+    {
+        if (leavesKingInCheck(position.board, m, position.sideToMove))
+            return false;
+        Square from = moveFrom(m);
+        uint8_t *entry = length > PROTOCOL_HEADER_BYTES ? frame + length - 9 : entries;
+        if (length == PROTOCOL_HEADER_BYTES || entry[0] != from)
+        {
+            for (entry = entries; entry < frame + length && entry[0] != from; entry += 9)
+            {
+            }
+            if (entry == frame + length)
+            {
+                put(from);
+                for (uint8_t i = 0; i < 8; i++)
+                {
+                    put(0);
+                }
+            }
+        }
+        Square to = moveTo(m);
+        entry[1 + (to >> 3)] |= 1 << (to & 7);
+        return false;
+    };
+    generateMoves(position.board, position.sideToMove, position.castlingRights, position.epSquare, add);
+    finish();
+}
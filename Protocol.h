@@ -0,0 +1,87 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <Arduino.h>
+#include "ChessBoard.h"
+#include "GameStore.h"
+
+// Binary messages to the companion app, in place of printBoard() text (about
+// 180 bytes a move at 9600 baud; a move here is a 10-byte frame). Frame:
+//
+//   0xA5 | type | sequence | length | payload (length bytes) | CRC-16, low byte first
+//
+// The CRC (CCITT: polynomial 0x1021, start 0xFFFF) covers type to payload.
+// The sequence number goes up by one per frame, so the receiver can tell a
+// frame went missing; after that it should wait for the next MSG_POSITION.
+// A receiver finds frames by looking for 0xA5 and checking the CRC, so a
+// corrupted byte costs one frame, not the stream. Multi-byte fields are
+// little-endian.
+//
+//   MSG_POSITION     38 bytes: a PackedPosition (GameStore.h), field by field
+//   MSG_MOVE         4 bytes: the Move just played, then positionCheck() of
+//                    the position it led to, so a receiver applying moves
+//                    to its own copy notices if it went wrong
+//   MSG_STATE        3 bytes: GameState, side to move, 1 if that side is in check
+//   MSG_LEGAL_MOVES  9 bytes per piece that can move: its square, then a
+//                    64-bit set of target squares (bit sq set)
+//
+// The encoder builds one frame at a time in a fixed buffer; nothing is
+// allocated.
+
+#define PROTOCOL_SYNC 0xA5
+#define PROTOCOL_HEADER_BYTES 4
+#define PROTOCOL_MAX_PAYLOAD (MAX_PIECES_PER_SIDE * 9)
+#define PROTOCOL_MAX_FRAME (PROTOCOL_HEADER_BYTES + PROTOCOL_MAX_PAYLOAD + 2)
+
+enum MessageType
+{
+  MSG_POSITION = 1,
+  MSG_MOVE = 2,
+  MSG_STATE = 3,
+  MSG_LEGAL_MOVES = 4
+};
+
+inline uint16_t crc16Update(uint16_t crc, uint8_t data)
+{
+  crc ^= (uint16_t)data << 8;
+  for (uint8_t i = 0; i < 8; i++)
+  {
+    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+// CRC of the squares, side to move, castling rights and en passant square
+uint16_t positionCheck(const Position &position);
+
+class ProtocolEncoder
+{
+public:
+  ProtocolEncoder() : sequence(0), length(0) {}
+
+  // Each builds one frame, replacing the previous one
+  void position(const Position &position);
+  void move(Move m, const Position &after);
+  void state(GameState state, const Position &position);
+  void legalMoves(const Position &position);
+
+  const uint8_t *data() const { return frame; }
+  uint8_t size() const { return length; }
+  void send() { Serial.write(frame, length); }
+
+private:
+  uint8_t frame[PROTOCOL_MAX_FRAME];
+  uint8_t sequence;
+  uint8_t length;
+
+  void start(MessageType type);
+  void put(uint8_t b) { frame[length++] = b; }
+  void put16(uint16_t w)
+  {
+    put((uint8_t)w);
+    put((uint8_t)(w >> 8));
+  }
+  void finish();
+};
+
+#endif
@@ -9,8 +9,6 @@ class Rook : public Piece {
 
     const char* getTypeName() override;
     bool canMove(int fromRow, char fromCol, int toRow, char toCol) override;
-
-    bool hasMoved = false;
 };
 
 #endif
@@ -5,8 +5,116 @@
 #include "Bishop.h"
 #include "Queen.h"
 #include "King.h"
+#include "LatencyBench.h"
+#include "GameStore.h"
 
 ChessBoard board;
+GameStore store; // the game in EEPROM, so a power cut doesn't lose it (see GameStore.h)
+
+#ifdef SMARTCHESS_SENSOR_BOARD
+#include "SensorMatrix.h"
+#include "MoveDetector.h"
+#include "LedFrame.h"
+#include "Protocol.h"
+
+// Sensor board build: the pieces are the input. Moving them plays moves
+// (see MoveDetector.h), the LEDs show the position with any square that
+// doesn't match it lit up, and the companion app gets frames (see
+// Protocol.h). Setting the pieces up for a new game starts one.
+MoveDetector detector;
+LedFrame leds;
+ProtocolEncoder link;
+static uint64_t startOccupancy;
+static uint64_t shownMismatch; // squares lit LED_COLOR_ATTENTION
+
+// occupied: the switches as they stand
+static void announceSensorGame(uint64_t occupied)
+{
+    detector.reset(occupied);
+    link.position(board.getPosition());
+    link.send();
+    link.state(board.getGameState(), board.getPosition());
+    link.send();
+}
+
+static void startSensorGame(uint64_t occupied)
+{
+    board.initializeStandardGame();
+    announceSensorGame(occupied);
+}
+
+static void sensorBoardSetup()
+{
+    sensors.begin();
+    leds.begin();
+    // After a power cut the pieces are still where they were: carry on with
+    // the stored game if it is still being played (resume() keeps the store
+    // attached), else a new one
+    if (board.resume(store) && board.getGameState() == GAME_ACTIVE)
+    {
+        announceSensorGame(sensors.occupancy());
+    }
+    else
+    {
+        board.attachStore(&store);
+        startSensorGame(sensors.occupancy());
+    }
+    startOccupancy = 0xFFFF00000000FFFFULL; // ranks 1, 2, 7 and 8
+}
+
+static void sensorBoardLoop()
+{
+    bool sensed = false;
+    SensorEvent event;
+    while (sensors.poll(event))
+    {
+        detector.sense(event);
+        sensed = true;
+    }
+    if (sensors.takeOverflow())
+    {
+        detector.resync(sensors.occupancy());
+        sensed = true;
+    }
+
+    if (sensed || detector.waiting())
+    {
+        if (detector.physical() == startOccupancy && occupancyOf(board.getPosition()) != startOccupancy)
+        {
+            startSensorGame(detector.physical());
+        }
+        else
+        {
+            Move move = detector.detect(board.getPosition(), millis());
+            if (move != NO_MOVE && board.movePiece(move))
+            {
+                detector.accept();
+                link.move(board.getLastMove(), board.getPosition());
+                link.send();
+                link.state(board.getGameState(), board.getPosition());
+                link.send();
+            }
+        }
+    }
+
+    // Only squares whose piece or whose match with the pieces changed
+    uint64_t dirty = board.takeDirtySquares();
+    if (!sensed && !dirty)
+        return;
+    uint64_t mismatch = detector.physical() ^ occupancyOf(board.getPosition());
+    uint64_t redraw = dirty | (mismatch ^ shownMismatch);
+    if (!redraw)
+        return;
+    leds.drawSquares(board.getBackend(), redraw & ~mismatch);
+    for (Square sq = 0; sq < 64; sq++)
+    {
+        if ((redraw & mismatch) >> sq & 1)
+            leds.setSquare(sq, LED_COLOR_ATTENTION);
+    }
+    shownMismatch = mismatch;
+    leds.show();
+}
+#endif
 
 /*
  * ============================================================================
@@ -27,6 +135,12 @@ ChessBoard board;
  *   - Sets current turn to WHITE
  *   - Call this once at the start of a new game
  *
+ * board.resume(store);  board.attachStore(&store);
+ *   - resume() continues the game a GameStore holds (after a power cut) and
+ *     returns false if none is stored; a stored game may have ended, so check
+ *     getGameState() before carrying on with it. attachStore() makes every
+ *     move land in the store from then on (resume() already attaches it)
+ *
  * ============================================================================
  * 2. MAKING MOVES
  * ============================================================================
@@ -55,120 +169,102 @@ ChessBoard board;
  *     * GAME_CHECKMATE_BLACK - black is checkmated (white wins)
  *     * GAME_STALEMATE - current player is stalemated (draw)
  *     * GAME_DRAW - game is a draw (50-move rule, threefold repetition, etc.)
- *   - Example: if (board.getGameState() == GAME_CHECKMATE_WHITE) { /* black wins */
-**PieceColor turn = board.getCurrentTurn();
-*-Returns whose turn it is : WHITE or BLACK * -Example : *if (board.getCurrentTurn() == WHITE){* // white's turn
-                                                                                               *} *
-                                          *bool inCheck = board.isInCheck(color);
-*-Checks if a player's king is in check * -color : WHITE or BLACK * -Returns true if king is in check, false otherwise * -Example : *if (board.isInCheck(WHITE))
-{
-    *Serial.println("White is in check!");
-    *
-}
- * 
+ *   - Example: if (board.getGameState() == GAME_CHECKMATE_WHITE) { // black wins }
+ *
+ * PieceColor turn = board.getCurrentTurn();
+ *   - Returns whose turn it is: WHITE or BLACK
+ *   - Example: if (board.getCurrentTurn() == WHITE) { // white's turn }
+ *
+ * bool inCheck = board.isInCheck(color);
+ *   - Checks if a player's king is in check
+ *   - color: WHITE or BLACK
+ *   - Returns true if king is in check, false otherwise
+ *   - Example: if (board.isInCheck(WHITE)) { Serial.println("White is in check!"); }
+ *
  * ============================================================================
  * 4. READING THE BOARD (for Arduino sensors)
  * ============================================================================
- * 
+ *
  * Piece* piece = board.getPiece(row, col);
  *   - Gets the piece at a specific square
  *   - Returns pointer to Piece if square has a piece, nullptr if empty
  *   - Use this to read what piece is on a square (for your sensors)
- *   - Example: 
+ *   - Example:
  *     Piece* p = board.getPiece(1, 'E');
- *if (p != nullptr)
- {
-     *if (p->getColor() == WHITE && p->getTypeName()[0] == 'K'){
-         * // White king is on e1
-         *}
-         *
- }
- **= = == == == == == == == == == == == == == == == == == == == == == == == == == == == == == == == == == == == == ==
-       *5. DISPLAY / DEBUGGING * ==
-       == == == == == == == == == == == == == == == == == == == == == == == == == == == == == == == == == == == == ==
-       **board.printBoard();
+ *     if (p != nullptr) {
+ *       if (p->getColor() == WHITE && p->getTypeName()[0] == 'K') {
+ *         // White king is on e1
+ *       }
+ *     }
+ *
+ * ============================================================================
+ * 5. DISPLAY / DEBUGGING
+ * ============================================================================
+ *
+ * board.printBoard();
  *   - Prints the board to Serial (for debugging)
  *   - Shows pieces as single letters (K, Q, R, B, N, P)
  *   - Useful for testing and debugging
- * 
+ *
  * ============================================================================
  * EXAMPLE GAME FLOW
  * ============================================================================
- * 
- * void setup()
- {
-     *Serial.begin(9600);
-     ** // 1. Initialize a new game
-      *board.initializeStandardGame();
-     *board.printBoard(); // See starting position
-     **                   // 2. Make moves
-      *                   // White moves pawn e2 to e4
-      *if (board.movePiece(2, 'E', 4, 'E'))
-     {
-         *Serial.println("White: e2-e4");
-         *
-     }
-     else
-     {
-         *Serial.println("Illegal move!");
-         *
-     }
-     ** // Black moves pawn e7 to e5
-      *if (board.movePiece(7, 'E', 5, 'E'))
-     {
-         *Serial.println("Black: e7-e5");
-         *
-     }
-     ** // White moves knight g1 to f3
-      *board.movePiece(1, 'G', 3, 'F');
-     ** // Check game state after each move
-      *GameState state = board.getGameState();
-     *if (state == GAME_ACTIVE)
-     {
-         *Serial.println("Game continues...");
-         *
-     }
-     else if (state == GAME_CHECKMATE_WHITE)
-     {
-         *Serial.println("Black wins by checkmate!");
-         *
-     }
-     else if (state == GAME_CHECKMATE_BLACK)
-     {
-         *Serial.println("White wins by checkmate!");
-         *
-     }
-     else if (state == GAME_STALEMATE || state == GAME_DRAW)
-     {
-         *Serial.println("Game is a draw!");
-         *
-     }
-     ** // 3. Check if a player is in check
-      *if (board.isInCheck(WHITE))
-     {
-         *Serial.println("White is in check!");
-         *
-     }
-     ** // 4. Check whose turn it is
-      *PieceColor turn = board.getCurrentTurn();
-     *if (turn == WHITE)
-     {
-         *Serial.println("White to move");
-         *
-     }
-     else
-     {
-         *Serial.println("Black to move");
-         *
-     }
-     ** // 5. Pawn promotion example (when pawn reaches 8th rank)
-      * // board.movePiece(7, 'A', 8, 'A', PROMOTE_QUEEN); // Promote to queen
-      * // board.movePiece(7, 'A', 8, 'A', PROMOTE_ROOK);  // Promote to rook
-      * // board.movePiece(7, 'A', 8, 'A', PROMOTE_BISHOP); // Promote to bishop
-      * // board.movePiece(7, 'A', 8, 'A', PROMOTE_KNIGHT); // Promote to knight
-          *
- }
- * 
+ *
+ * void setup() {
+ *   Serial.begin(9600);
+ *
+ *   // 1. Initialize a new game
+ *   board.initializeStandardGame();
+ *   board.printBoard(); // See starting position
+ *
+ *   // 2. Make moves
+ *   // White moves pawn e2 to e4
+ *   if (board.movePiece(2, 'E', 4, 'E')) {
+ *     Serial.println("White: e2-e4");
+ *   } else {
+ *     Serial.println("Illegal move!");
+ *   }
+ *
+ *   // Black moves pawn e7 to e5
+ *   if (board.movePiece(7, 'E', 5, 'E')) {
+ *     Serial.println("Black: e7-e5");
+ *   }
+ *
+ *   // White moves knight g1 to f3
+ *   board.movePiece(1, 'G', 3, 'F');
+ *
+ *   // Check game state after each move
+ *   GameState state = board.getGameState();
+ *   if (state == GAME_ACTIVE) {
+ *     Serial.println("Game continues...");
+ *   } else if (state == GAME_CHECKMATE_WHITE) {
+ *     Serial.println("Black wins by checkmate!");
+ *   } else if (state == GAME_CHECKMATE_BLACK) {
+ *     Serial.println("White wins by checkmate!");
+ *   } else if (state == GAME_STALEMATE || state == GAME_DRAW) {
+ *     Serial.println("Game is a draw!");
+ *   }
+ *
+ *   // 3. Check if a player is in check
+ *   if (board.isInCheck(WHITE)) {
+ *     Serial.println("White is in check!");
+ *   }
+ *
+ *   // 4. Check whose turn it is
+ *   PieceColor turn = board.getCurrentTurn();
+ *   if (turn == WHITE) {
+ *     Serial.println("White to move");
+ *   } else {
+ *     Serial.println("Black to move");
+ *   }
+ *
+ *   // 5. Pawn promotion example (when pawn reaches 8th rank)
+ *   // board.movePiece(7, 'A', 8, 'A', PROMOTE_QUEEN);  // Promote to queen
+ *   // board.movePiece(7, 'A', 8, 'A', PROMOTE_ROOK);   // Promote to rook
+ *   // board.movePiece(7, 'A', 8, 'A', PROMOTE_BISHOP); // Promote to bishop
+ *   // board.movePiece(7, 'A', 8, 'A', PROMOTE_KNIGHT); // Promote to knight
+ * }
+ *
  * void loop() {
  *   // Your Arduino code here:
  *   // 1. Read sensors to detect piece movements
@@ -212,35 +308,59 @@ void setup()
  {
      Serial.begin(9600);
 
-     // Initialize a new chess game
-     board.initializeStandardGame();
-
-     // Print the starting board
-     Serial.println("\n=== Starting Position ===");
-     board.printBoard();
+#ifdef SMARTCHESS_SENSOR_BOARD
+     sensorBoardSetup();
+     return;
+#endif
 
-     // Example: Make a few moves
-     Serial.println("\n=== Making Moves ===");
+#ifdef SMARTCHESS_LATENCY_BENCH
+     // Benchmark build (see LatencyBench.h): report and stop
+     static LatencyReport report;
+     runLatencyBench(report, 4);
+     printLatencyReport(report);
+     return;
+#endif
 
-     // White: e2-e4
-     if (board.movePiece(2, 'E', 4, 'E'))
+     // Carry on with the game stored in EEPROM if it is still being played
+     // (resume() keeps the store attached); a finished one, or none, gives way
+     // to a new chess game, whose header replaces it in the store
+     if (board.resume(store) && board.getGameState() == GAME_ACTIVE)
      {
-         Serial.println("White: e2-e4");
+         Serial.println("\n=== Resumed Game ===");
          board.printBoard();
      }
-
-     // Black: e7-e5
-     if (board.movePiece(7, 'E', 5, 'E'))
+     else
      {
-         Serial.println("Black: e7-e5");
-         board.printBoard();
-     }
+         board.attachStore(&store);
+         board.initializeStandardGame();
 
-     // White: Ng1-f3
-     if (board.movePiece(1, 'G', 3, 'F'))
-     {
-         Serial.println("White: Ng1-f3");
+         // Print the starting board
+         Serial.println("\n=== Starting Position ===");
          board.printBoard();
+
+         // Example: Make a few moves
+         Serial.println("\n=== Making Moves ===");
+
+         // White: e2-e4
+         if (board.movePiece(2, 'E', 4, 'E'))
+         {
+             Serial.println("White: e2-e4");
+             board.printBoard();
+         }
+
+         // Black: e7-e5
+         if (board.movePiece(7, 'E', 5, 'E'))
+         {
+             Serial.println("Black: e7-e5");
+             board.printBoard();
+         }
+
+         // White: Ng1-f3
+         if (board.movePiece(1, 'G', 3, 'F'))
+         {
+             Serial.println("White: Ng1-f3");
+             board.printBoard();
+         }
      }
 
      // Check game state
@@ -272,16 +392,35 @@ void setup()
 
  void loop()
  {
+#ifdef SMARTCHESS_SENSOR_BOARD
+     sensorBoardLoop();
+     return;
+#endif
+
      // Your Arduino integration code goes here:
      //
-     // 1. Read sensors (magnetic, pressure, etc.) to detect piece positions
+     // 1. Read sensors (magnetic, pressure, etc.) to detect piece positions.
+     //    With the reed-switch matrix (see SensorMatrix.h): sensors.begin() in setup(),
+     //    then drain sensors.poll(event) here; if sensors.takeOverflow(), rebuild from
+     //    sensors.occupancy()
      // 2. Compare current positions with previous positions to detect moves
      // 3. Convert sensor coordinates to chess notation (row 1-8, col 'A'-'H')
      // 4. Call board.movePiece(fromRow, fromCol, toRow, toCol)
      // 5. If move returns false, handle error (illegal move, wrong turn, etc.)
      // 6. Check board.getGameState() after each move
-     // 7. Update displays/LEDs/motors based on game state
+     // 7. Update displays/LEDs/motors based on game state. LEDs under the squares
+     //    (see LedFrame.h): leds.drawSquares(board.getBackend(), board.takeDirtySquares());
+     //    leds.show(); sends only the squares the move changed
+     //    Companion app: frames from a ProtocolEncoder link instead of printBoard() text (see Protocol.h):
+     //    link.move(board.getLastMove(), board.getPosition()); link.send();
      // 8. Handle pawn promotion (detect when pawn reaches 8th/1st rank)
+     // 9. Hint button: search.startHint(board.getPosition(), budgetMs), then
+     //    poll once per pass so steps 1-7 keep running (see Search.h):
+     //      if (search.pollHint() == HINT_READY) { showHint(search.bestMove()); search.cancelHint(); }
+     //    With endgame tables in external flash (see Endgame.h): tables.begin(readFlash) in setup()
+     //    and search.setEndgameTables(&tables); covered endings are then played from the table
+     // 10. Playing against the board: after its move, search.startPonder(board.getPosition())
+     //    and keep polling; once the player's move is in, search.ponderHit(board.getPosition(), budgetMs)
      //
      // Example flow:
      // if (detectMove()) {
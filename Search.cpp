@@ -0,0 +1,452 @@
+#include "Search.h"
+#include "Evaluate.h"
+#include "Endgame.h"
+
+// Captures and promotions: searched first, and the only moves quiescence
+// looks at
+template <class Backend>
+static bool isTactical(const Backend &board, Move m)
+{
+    return moveFlag(m) == MOVE_PROMOTION || moveFlag(m) == MOVE_EN_PASSANT || board.pieceAt(moveTo(m)) != NO_PIECE;
+}
+
+// Margin on top of the captured piece for quiescence to still try a capture
+#define DELTA_MARGIN 200
+
+Search::Search(TranspositionTable &table)
+    : table(table), tables(nullptr), rootCount(0), top(0), status(HINT_IDLE), sliceMicros(SEARCH_DEFAULT_SLICE_MICROS), sliceNodes(0),
+      best(NO_MOVE), bestReply(NO_MOVE), score(0), completed(0), nodes(0), stopped(false), expired(false), pondering(false), expected(NO_MOVE)
+{
+}
+
+void Search::startHint(const Position &position, uint32_t budget, uint8_t maxDepth)
+{
+    Frame &root = frames[0];
+    root.position = position;
+    rootCount = 0;
+    auto collect = [&](Move m)
+    {
+        if (!leavesKingInCheck(position.board, m, position.sideToMove))
+            rootMoves[rootCount++] = m;
+        return rootCount == SEARCH_MAX_ROOT_MOVES;
+    };
+    generateMoves(position.board, position.sideToMove, position.castlingRights, position.epSquare, collect);
+
+    budgetStart = millis();
+    budgetMs = budget;
+    targetDepth = maxDepth < 1 ? 1 : maxDepth > SEARCH_MAX_DEPTH ? SEARCH_MAX_DEPTH : maxDepth;
+    best = rootCount ? rootMoves[0] : NO_MOVE;
+    bestReply = NO_MOVE;
+    score = 0;
+    completed = 0;
+    nodes = 0;
+    startIteration(1);
+    pondering = false;
+    // Nothing to choose between: no need to think
+    status = rootCount > 1 ? HINT_THINKING : HINT_READY;
+    if (status == HINT_THINKING && probeRoot())
+        finish();
+}
+
+void Search::startPonder(const Position &position)
+{
+    // The reply the last search expects: the second move of its line if
+    // this is the position it led to, else the table's move here
+    Position played = frames[0].position;
+    if (best != NO_MOVE)
+        played.makeMove(best);
+    TTEntry entry;
+    expected = NO_MOVE;
+    if (best != NO_MOVE && played.key() == position.key())
+        expected = bestReply;
+    else if (table.probe(position.key(), entry))
+        expected = entry.move;
+    if (expected != NO_MOVE && !position.isLegal(expected))
+        expected = NO_MOVE;
+
+    Position target = position;
+    if (expected != NO_MOVE)
+        target.makeMove(expected);
+    // No budget: the opponent's move ends it
+    startHint(target, 0xFFFFFFFF);
+    pondering = true;
+}
+
+bool Search::ponderHit(const Position &position, uint32_t budget, uint8_t maxDepth)
+{
+    bool hit = pondering && expected != NO_MOVE && status != HINT_IDLE && frames[0].position.key() == position.key();
+    if (!hit)
+    {
+        // A miss leaves only table entries behind: they describe other
+        // positions and are as valid as any
+        startHint(position, budget, maxDepth);
+        return false;
+    }
+
+    pondering = false;
+    budgetStart = millis();
+    budgetMs = budget;
+    targetDepth = maxDepth < 1 ? 1 : maxDepth > SEARCH_MAX_DEPTH ? SEARCH_MAX_DEPTH : maxDepth;
+    if (completed >= targetDepth)
+        finish();
+    return true;
+}
+
+HintStatus Search::pollHint()
+{
+    if (status != HINT_THINKING)
+        return status;
+    sliceStart = micros();
+    sliceStartNodes = nodes;
+    stopped = false;
+    expired = false;
+    if (budgetOver())
+        finish();
+    else
+        runSlice();
+    return status;
+}
+
+void Search::runSlice()
+{
+    while (!stopped)
+    {
+        Frame &frame = frames[top];
+        Move m;
+        if (!nextMove(frame, m))
+        {
+            if (top == 0)
+            {
+                if (!completeIteration())
+                    return;
+                continue;
+            }
+            int16_t value = leave(frame, top);
+            top--;
+            deliver(frames[top], -value);
+            continue;
+        }
+
+        const BoardBackend &board = frame.position.board;
+        if (frame.depth == 0)
+        {
+            // Hopeless even if the piece came for free
+            PieceCode victim = board.pieceAt(moveTo(m));
+            int16_t gain = victim != NO_PIECE ? pieceValue(pieceType(victim)) : PAWN_VALUE;
+            if (moveFlag(m) == MOVE_PROMOTION)
+                gain += QUEEN_VALUE;
+            if (frame.bestScore + gain + DELTA_MARGIN <= frame.alpha)
+                continue;
+        }
+        if (leavesKingInCheck(board, m, frame.position.sideToMove))
+            continue;
+        frame.anyMove = true;
+        frame.current = m;
+
+        Frame &child = frames[top + 1];
+        child.position = frame.position;
+        child.position.makeMove(m);
+        uint8_t depth = frame.depth ? frame.depth - 1 : 0;
+        int16_t value;
+        if (enter(child, depth, top + 1, -frame.beta, -frame.alpha, value))
+            top++;
+        else
+            deliver(frame, -value);
+    }
+    if (expired)
+        finish();
+}
+
+void Search::checkTime()
+{
+    if (budgetOver())
+        expired = stopped = true;
+    else if (sliceOver())
+        stopped = true;
+}
+
+// A table win is a mate at its distance; without one (a WDL-only table, or
+// too long a mate for the score range) it scores just short of a mate
+static int16_t tableScore(const EgtbResult &result, uint8_t ply)
+{
+    if (result.wdl == EGTB_DRAW)
+        return 0;
+    int16_t score = result.dtm != EGTB_DTM_UNKNOWN && ply + result.dtm < MATE_SCORE - MATE_BOUND
+                        ? MATE_SCORE - ply - result.dtm
+                        : MATE_BOUND;
+    return result.wdl == EGTB_WIN ? score : -score;
+}
+
+// Score of position from the endgame tables; false if they don't cover it
+bool Search::probeTables(const Position &position, uint8_t ply, int16_t &value)
+{
+    EgtbResult result;
+    if (position.castlingRights || position.epSquare != NO_SQUARE || !tables->probe(position, result) ||
+        result.wdl == EGTB_ILLEGAL)
+        return false;
+    value = tableScore(result, ply);
+    return true;
+}
+
+// Settles a root position the tables cover: every move is scored from the
+// position it leads to. False (nothing changed) if any of those is missing.
+bool Search::probeRoot()
+{
+    const Position &position = frames[0].position;
+    int16_t value;
+    if (!tables || !probeTables(position, 0, value))
+        return false;
+    Move choice = NO_MOVE;
+    int16_t choiceScore = -MATE_SCORE;
+    for (uint16_t i = 0; i < rootCount; i++)
+    {
+        Position child = position;
+        child.makeMove(rootMoves[i]);
+        nodes++;
+        if (!probeTables(child, 1, value))
+            return false;
+        if (choice == NO_MOVE || -value > choiceScore)
+        {
+            choice = rootMoves[i];
+            choiceScore = -value;
+        }
+    }
+    best = choice;
+    score = choiceScore;
+    completed = targetDepth;
+    return true;
+}
+
+void Search::startIteration(uint8_t depth)
+{
+    Frame &root = frames[0];
+    root.depth = depth;
+    root.alpha = -MATE_SCORE;
+    root.beta = MATE_SCORE;
+    root.stage = STAGE_ROOT;
+    top = 0;
+    rootIndex = 0;
+    iterationBest = 0;
+    plyLimit = depth + SEARCH_QUIESCENCE_PLIES;
+}
+
+// False once the search is over
+bool Search::completeIteration()
+{
+    completed = frames[0].depth;
+    Move m = rootMoves[iterationBest];
+    memmove(&rootMoves[1], &rootMoves[0], iterationBest * sizeof(Move));
+    rootMoves[0] = m;
+    // A proven mate either way won't change with more depth
+    if (completed >= targetDepth || abs(score) > MATE_BOUND)
+    {
+        finish();
+        return false;
+    }
+    startIteration(completed + 1);
+    return true;
+}
+
+// Sets up a node. False if it is settled on entry (value holds its score),
+// true if its moves have to be searched.
+bool Search::enter(Frame &frame, uint8_t depth, uint8_t ply, int16_t alpha, int16_t beta, int16_t &value)
+{
+    if (++nodes % SEARCH_TIME_CHECK_NODES == 0)
+        checkTime();
+    if (sliceNodes && nodes - sliceStartNodes >= sliceNodes)
+        stopped = true;
+
+    const Position &position = frame.position;
+    frame.depth = depth;
+    frame.beta = beta;
+    frame.anyMove = false;
+    frame.ttMove = NO_MOVE;
+    frame.bestMove = NO_MOVE;
+
+    if (depth == 0)
+    {
+        // Quiescence: captures only, with the side to move free to stand pat
+        frame.bestScore = evaluate(position);
+        if (frame.bestScore >= beta || ply >= plyLimit)
+        {
+            value = frame.bestScore;
+            return false;
+        }
+        frame.alpha = frame.bestScore > alpha ? frame.bestScore : alpha;
+        startStage(frame, STAGE_TACTICAL);
+        return true;
+    }
+
+    if (position.halfMoveClock >= 100)
+    {
+        value = 0;
+        return false;
+    }
+
+    if (tables && probeTables(position, ply, value))
+        return false;
+
+    // Mate-distance window, as in MateSearch
+    if (alpha < -MATE_SCORE + ply)
+        alpha = -MATE_SCORE + ply;
+    if (beta > MATE_SCORE - ply - 1)
+        beta = MATE_SCORE - ply - 1;
+    if (alpha >= beta)
+    {
+        value = alpha;
+        return false;
+    }
+
+    TTEntry entry;
+    if (table.probe(position.key(), entry))
+    {
+        frame.ttMove = entry.move;
+        int16_t stored = scoreFromTT(entry.score, ply);
+        if (entry.depth >= depth &&
+            (entry.bound == TT_EXACT || (entry.bound == TT_LOWER && stored >= beta) ||
+             (entry.bound == TT_UPPER && stored <= alpha)))
+        {
+            value = stored;
+            return false;
+        }
+    }
+
+    frame.alpha = alpha;
+    frame.beta = beta;
+    frame.originalAlpha = alpha;
+    frame.bestScore = -MATE_SCORE;
+    frame.stage = STAGE_TABLE;
+    return true;
+}
+
+// Score of a node whose moves are all searched (or that reached beta)
+int16_t Search::leave(Frame &frame, uint8_t ply)
+{
+    if (frame.depth == 0)
+        return frame.alpha;
+    if (!frame.anyMove)
+        return frame.position.inCheck() ? -MATE_SCORE + ply : 0;
+
+    TTBound bound = frame.bestScore <= frame.originalAlpha ? TT_UPPER : frame.bestScore >= frame.beta ? TT_LOWER : TT_EXACT;
+    table.store(frame.position.key(), frame.bestMove, scoreToTT(frame.bestScore, ply), frame.depth, bound);
+    return frame.bestScore;
+}
+
+// Score of frame.current, from frame's side
+void Search::deliver(Frame &frame, int16_t value)
+{
+    if (frame.stage == STAGE_ROOT)
+    {
+        if (value > frame.alpha)
+        {
+            frame.alpha = value;
+            iterationBest = rootIndex - 1;
+            // The previous iteration's best is searched first, so any move
+            // ahead of it now is the better-informed choice
+            best = frame.current;
+            score = value;
+            // The reply's frame is still as it left: its best move, or the
+            // table's if it was settled on entry
+            bestReply = frames[1].bestMove != NO_MOVE ? frames[1].bestMove : frames[1].ttMove;
+        }
+        // Root moves are a natural place to stop
+        checkTime();
+        return;
+    }
+
+    if (frame.depth && value > frame.bestScore)
+    {
+        frame.bestScore = value;
+        frame.bestMove = frame.current;
+    }
+    if (value > frame.alpha)
+        frame.alpha = value;
+    if (frame.alpha >= frame.beta)
+        frame.stage = STAGE_DONE;
+}
+
+bool Search::nextMove(Frame &frame, Move &m)
+{
+    const Position &position = frame.position;
+    for (;;)
+    {
+        switch (frame.stage)
+        {
+        case STAGE_ROOT:
+            if (rootIndex == rootCount)
+                return false;
+            m = rootMoves[rootIndex++];
+            return true;
+
+        case STAGE_TABLE:
+            startStage(frame, STAGE_TACTICAL);
+            if (frame.ttMove != NO_MOVE &&
+                isPseudoLegal(position.board, position.sideToMove, position.castlingRights, position.epSquare, frame.ttMove))
+            {
+                m = frame.ttMove;
+                return true;
+            }
+            break;
+
+        case STAGE_TACTICAL:
+        case STAGE_QUIET:
+            if (frame.batchNext == frame.batchCount)
+            {
+                if (!frame.generatedAll)
+                    fillBatch(frame);
+                if (frame.batchNext == frame.batchCount)
+                {
+                    startStage(frame, frame.stage == STAGE_TACTICAL && frame.depth ? STAGE_QUIET : STAGE_DONE);
+                    break;
+                }
+            }
+            m = frame.batch[frame.batchNext++];
+            return true;
+
+        default:
+            return false;
+        }
+    }
+}
+
+void Search::startStage(Frame &frame, uint8_t stage)
+{
+    frame.stage = stage;
+    frame.generated = 0;
+    frame.generatedAll = false;
+    frame.batchCount = 0;
+    frame.batchNext = 0;
+}
+
+// Next batch of the frame's stage: the generator runs from the start each
+// time and skips what earlier batches took
+void Search::fillBatch(Frame &frame)
+{
+    const Position &position = frame.position;
+    bool tactical = frame.stage == STAGE_TACTICAL;
+    uint16_t skip = frame.generated;
+    uint8_t count = 0;
+    bool more = false;
+    auto take = [&](Move m)
+    {
+        if (isTactical(position.board, m) != tactical || m == frame.ttMove)
+            return false;
+        if (skip)
+        {
+            skip--;
+            return false;
+        }
+        if (count == SEARCH_MOVE_BATCH)
+        {
+            more = true;
+            return true;
+        }
+        frame.batch[count++] = m;
+        return false;
+    };
+    generateMoves(position.board, position.sideToMove, position.castlingRights, position.epSquare, take);
+    frame.generated += count;
+    frame.generatedAll = !more;
+    frame.batchCount = count;
+    frame.batchNext = 0;
+}
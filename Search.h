@@ -0,0 +1,239 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <Arduino.h>
+#include "Position.h"
+#include "TranspositionTable.h"
+
+class EndgameTables;
+
+// Best-move search behind the hint button. Iterative deepening alpha-beta
+// with a quiescence search on captures, run in slices so loop() keeps
+// scanning sensors and driving LEDs while the board thinks:
+//
+//   search.startHint(position, 3000); // on the button press
+//   ...
+//   if (search.pollHint() == HINT_READY) // once per loop(), at most one slice
+//     show(search.bestMove());
+//
+// A move is held from the start (the first legal one until a search says
+// otherwise) and replaced as soon as a deeper iteration proves another one
+// better, so the hint is ready the moment the budget runs out.
+//
+// The search keeps its own stack: one Frame per ply holding the position,
+// the window and where the node is in its move order. A slice ends after a
+// node count or a time, whichever comes first, and the next one carries on
+// from the same node; slicing changes when the work is done, never what is
+// searched. Moves are generated a batch at a time (regenerating and skipping
+// the ones already handed out) so a frame needs no full move list.
+//
+// Pondering uses the opponent's thinking time. After the board's move,
+// startPonder() searches the position after the reply the last search
+// expected (the second move of its line), or, with no expectation, the
+// opponent's position itself, which warms the table for every reply at
+// once. When the opponent moves, ponderHit() either keeps the search going
+// with a budget from now (the expected reply: iterations, best move and
+// table all carry over) or drops it and starts afresh on the real position.
+//
+// With endgame tables attached (setEndgameTables()), positions they cover
+// are scored from the table rather than searched: at the root every move is
+// scored from the position it leads to and the hint is ready at once, and
+// inside the tree such a node is a leaf. Castling and en passant rights keep
+// a position out of the tables, which know nothing of them.
+//
+// Repetitions are not detected: the search sees only the position, not the
+// game.
+
+#ifndef SEARCH_MAX_DEPTH
+#if defined(SMARTCHESS_SMALL_SRAM)
+#define SEARCH_MAX_DEPTH 2
+#elif defined(__AVR__)
+#define SEARCH_MAX_DEPTH 4 // full-width plies
+#else
+#define SEARCH_MAX_DEPTH 32
+#endif
+#endif
+
+#ifndef SEARCH_QUIESCENCE_PLIES
+#if defined(SMARTCHESS_SMALL_SRAM)
+#define SEARCH_QUIESCENCE_PLIES 2
+#elif defined(__AVR__)
+#define SEARCH_QUIESCENCE_PLIES 4 // capture plies beyond the nominal depth
+#else
+#define SEARCH_QUIESCENCE_PLIES 16
+#endif
+#endif
+
+// Frames: one per ply, the root's included; about 150 bytes each on AVR
+#define SEARCH_MAX_PLY (SEARCH_MAX_DEPTH + SEARCH_QUIESCENCE_PLIES)
+
+#ifndef SEARCH_MOVE_BATCH
+#if defined(SMARTCHESS_SMALL_SRAM)
+#define SEARCH_MOVE_BATCH 4
+#elif defined(__AVR__)
+#define SEARCH_MOVE_BATCH 8 // moves generated at once per frame
+#else
+#define SEARCH_MOVE_BATCH 32
+#endif
+#endif
+
+#ifndef SEARCH_MAX_ROOT_MOVES
+#if defined(SMARTCHESS_SMALL_SRAM)
+#define SEARCH_MAX_ROOT_MOVES 64
+#elif defined(__AVR__)
+#define SEARCH_MAX_ROOT_MOVES 96 // games hardly reach it; further moves are not considered
+#else
+#define SEARCH_MAX_ROOT_MOVES 256
+#endif
+#endif
+
+// Nodes between clock reads: bounds how far a slice overruns its time
+#ifndef SEARCH_TIME_CHECK_NODES
+#if defined(__AVR__)
+#define SEARCH_TIME_CHECK_NODES 16
+#else
+#define SEARCH_TIME_CHECK_NODES 32 // some 10 us of search; a clock read costs far less
+#endif
+#endif
+
+#define SEARCH_DEFAULT_SLICE_MICROS 5000
+
+// SRAM for a Search and its table together (both usually globals): on a
+// 2 KB part the rest is left to the board, the Serial buffers and the stack
+#if defined(__AVR__) && !defined(SEARCH_SRAM_BUDGET)
+#if defined(SMARTCHESS_SMALL_SRAM)
+#define SEARCH_SRAM_BUDGET 1152
+#else
+#define SEARCH_SRAM_BUDGET 3072
+#endif
+#endif
+
+enum HintStatus
+{
+  HINT_IDLE,     // nothing asked for, or cancelled
+  HINT_THINKING, // call pollHint() again
+  HINT_READY     // bestMove() is the hint (NO_MOVE: no legal move)
+};
+
+class Search
+{
+public:
+  explicit Search(TranspositionTable &table);
+
+  // Slice length; 0 lifts the limit. With both at 0 a slice runs to the end.
+  void setSliceMicros(uint32_t micros) { sliceMicros = micros; }
+  void setSliceNodes(uint32_t nodes) { sliceNodes = nodes; }
+  // Tables to probe (see Endgame.h), begun by the caller; nullptr for none
+  void setEndgameTables(EndgameTables *endgameTables) { tables = endgameTables; }
+
+  // Starts a search of position, to be given at most budgetMs of slices.
+  // It also ends once targetDepth is completed or a mate is proven.
+  void startHint(const Position &position, uint32_t budgetMs, uint8_t targetDepth = SEARCH_MAX_DEPTH);
+  // Runs one slice if the search is still thinking
+  HintStatus pollHint();
+  void cancelHint()
+  {
+    status = HINT_IDLE;
+    pondering = false;
+  }
+  HintStatus getStatus() const { return status; }
+
+  // position: the opponent to move. Runs through pollHint(), without a
+  // budget, until ponderHit() or cancelHint(); a READY status meanwhile only
+  // means the search ran out of depth.
+  void startPonder(const Position &position);
+  // The opponent's move is in: position is the board's turn again. True if
+  // the search carries on from the ponder, false if it started over.
+  bool ponderHit(const Position &position, uint32_t budgetMs, uint8_t targetDepth = SEARCH_MAX_DEPTH);
+  bool isPondering() const { return pondering; }
+  Move ponderMove() const { return expected; } // NO_MOVE: pondering on every reply
+
+  Move bestMove() const { return best; }
+  int16_t bestScore() const { return score; } // side to move's view; 0 until a root move is searched
+  uint8_t completedDepth() const { return completed; }
+  uint32_t getNodes() const { return nodes; }
+
+private:
+  enum Stage
+  {
+    STAGE_ROOT,     // root frame: rootMoves in order
+    STAGE_TABLE,    // the table's move
+    STAGE_TACTICAL, // captures and promotions
+    STAGE_QUIET,
+    STAGE_DONE // out of moves, or beta reached
+  };
+
+  struct Frame
+  {
+    Position position;
+    int16_t alpha;
+    int16_t beta;
+    int16_t originalAlpha;
+    int16_t bestScore; // quiescence: the stand-pat score
+    Move ttMove;
+    Move bestMove;
+    Move current;  // move whose subtree is being searched
+    uint8_t depth; // plies left; 0 in quiescence
+    uint8_t stage;
+    bool anyMove;
+    bool generatedAll; // the stage has no moves beyond the batch
+    uint8_t batchCount;
+    uint8_t batchNext;
+    uint16_t generated; // moves of this stage taken into batches so far
+    Move batch[SEARCH_MOVE_BATCH];
+  };
+
+  TranspositionTable &table;
+  EndgameTables *tables;
+  Move rootMoves[SEARCH_MAX_ROOT_MOVES];
+  uint16_t rootCount;
+  Frame frames[SEARCH_MAX_PLY + 1];
+  uint8_t top; // frame being searched, also its ply
+
+  HintStatus status;
+  uint32_t sliceMicros;
+  uint32_t sliceNodes;
+  uint32_t sliceStart;
+  uint32_t sliceStartNodes;
+  uint32_t budgetStart;
+  uint32_t budgetMs;
+  uint8_t targetDepth;
+
+  uint16_t rootIndex;     // next root move to search
+  uint16_t iterationBest; // index in rootMoves of the best move of this iteration
+  uint8_t plyLimit;       // quiescence stops here
+
+  Move best;
+  Move bestReply; // second move of best's line, NO_MOVE if unknown
+  int16_t score;
+  uint8_t completed;
+  uint32_t nodes;
+  bool stopped; // slice or budget over
+  bool expired; // budget over
+  bool pondering;
+  Move expected; // reply the ponder search assumes
+
+  void runSlice();
+  void finish() { status = HINT_READY; }
+  bool budgetOver() const { return (uint32_t)(millis() - budgetStart) >= budgetMs; }
+  bool sliceOver() const { return sliceMicros && (uint32_t)(micros() - sliceStart) >= sliceMicros; }
+  void checkTime();
+
+  bool probeTables(const Position &position, uint8_t ply, int16_t &value);
+  bool probeRoot();
+  void startIteration(uint8_t depth);
+  bool completeIteration();
+  bool enter(Frame &frame, uint8_t depth, uint8_t ply, int16_t alpha, int16_t beta, int16_t &value);
+  int16_t leave(Frame &frame, uint8_t ply);
+  void deliver(Frame &frame, int16_t value);
+  bool nextMove(Frame &frame, Move &m);
+  void startStage(Frame &frame, uint8_t stage);
+  void fillBatch(Frame &frame);
+};
+
+#if defined(__AVR__)
+static_assert(sizeof(Search) + sizeof(TranspositionTable) <= SEARCH_SRAM_BUDGET,
+              "search and table exceed their SRAM budget: lower SEARCH_MAX_DEPTH, SEARCH_QUIESCENCE_PLIES or TT_ENTRIES");
+#endif
+
+#endif
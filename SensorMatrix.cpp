@@ -0,0 +1,226 @@
+#include "SensorMatrix.h"
+
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#endif
+
+#if defined(SMARTCHESS_SENSOR_BOARD)
+SensorMatrix sensors;
+#endif
+
+SensorMatrix::SensorMatrix() : rank(0), overflows(0), scans(0), seenOverflows(0)
+{
+    memset(stable, 0, sizeof(stable));
+    memset(counter0, 0xFF, sizeof(counter0));
+    memset(counter1, 0xFF, sizeof(counter1));
+    memset(buffers, 0, sizeof(buffers));
+#if !defined(__AVR__)
+    memset(simulated, 0, sizeof(simulated));
+#endif
+}
+
+void SensorMatrix::scanRow()
+{
+    uint8_t r = rank;
+    uint8_t sample = readRank(r);
+    rank = (r + 1) & 7;
+    driveRank(rank);
+
+    // Vertical counters: every square of the rank counts at once. A square
+    // agreeing with its stable state resets to 3; one that differs counts
+    // down and toggles when it rolls over, on the fourth differing scan.
+    uint8_t changed = stable[r] ^ sample;
+    counter0[r] = ~(counter0[r] & changed);
+    counter1[r] = counter0[r] ^ (counter1[r] & changed);
+    changed &= counter0[r] & counter1[r];
+    stable[r] ^= changed;
+
+    uint8_t writing = __atomic_load_n(&scans, __ATOMIC_RELAXED);
+    __atomic_store_n(&buffers[writing & 1][r], stable[r], __ATOMIC_RELAXED);
+    if (rank == 0)
+    {
+        // The other buffer can be read now
+        __atomic_store_n(&scans, (uint8_t)(writing + 1), __ATOMIC_RELEASE);
+    }
+
+    if (!changed)
+        return;
+    SensorEvent event;
+    event.time = (uint16_t)millis();
+    uint8_t dropped = 0;
+    for (uint8_t file = 0; file < 8; file++)
+    {
+        if (!(changed & (1 << file)))
+            continue;
+        event.square = r * 8 + file;
+        event.placed = stable[r] & (1 << file);
+        if (!events.push(event))
+            dropped++;
+    }
+    if (dropped)
+        __atomic_store_n(&overflows, (uint8_t)(overflows + dropped), __ATOMIC_RELEASE);
+}
+
+uint64_t SensorMatrix::occupancy() const
+{
+    uint8_t copy[8];
+    uint8_t before, after;
+    do
+    {
+        // Retry if a scan completed meanwhile: the next one overwrites this
+        // buffer
+        before = __atomic_load_n(&scans, __ATOMIC_ACQUIRE);
+        for (uint8_t r = 0; r < 8; r++)
+        {
+            copy[r] = __atomic_load_n(&buffers[(before & 1) ^ 1][r], __ATOMIC_RELAXED);
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&scans, __ATOMIC_RELAXED);
+    } while (before != after);
+
+    uint64_t bits = 0;
+    for (uint8_t r = 0; r < 8; r++)
+    {
+        bits |= (uint64_t)copy[r] << (8 * r);
+    }
+    return bits;
+}
+
+bool SensorMatrix::takeOverflow()
+{
+    uint8_t now = __atomic_load_n(&overflows, __ATOMIC_ACQUIRE);
+    bool dropped = now != seenOverflows;
+    seenOverflows = now;
+    return dropped;
+}
+
+#if defined(__AVR__)
+
+static_assert((F_CPU / 64) * SENSOR_ROW_MICROS / 1000000 <= 256, "SENSOR_ROW_MICROS too long for Timer2 at clk/64");
+
+static const uint8_t rankPins[8] = SENSOR_RANK_PINS;
+static const uint8_t filePins[8] = SENSOR_FILE_PINS;
+
+// Port registers and bit of each line, for the interrupt
+static volatile uint8_t *rankModes[8];
+static uint8_t rankMasks[8];
+static volatile uint8_t *fileInputs[8];
+static uint8_t fileMasks[8];
+
+#if defined(SMARTCHESS_SENSOR_BOARD)
+ISR(TIMER2_COMPA_vect)
+{
+    sensors.scanRow();
+}
+#endif
+
+void SensorMatrix::begin()
+{
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        pinMode(rankPins[i], INPUT); // released: high impedance, output latch low
+        pinMode(filePins[i], INPUT_PULLUP);
+        rankModes[i] = portModeRegister(digitalPinToPort(rankPins[i]));
+        rankMasks[i] = digitalPinToBitMask(rankPins[i]);
+        fileInputs[i] = portInputRegister(digitalPinToPort(filePins[i]));
+        fileMasks[i] = digitalPinToBitMask(filePins[i]);
+    }
+    rank = 0;
+    driveRank(0);
+    delayMicroseconds(10);
+    for (uint8_t r = 0; r < 8; r++)
+    {
+        stable[r] = readRank(r);
+        driveRank((r + 1) & 7);
+        delayMicroseconds(10);
+        counter0[r] = counter1[r] = 0xFF;
+        buffers[0][r] = buffers[1][r] = stable[r];
+    }
+
+    // CTC, one compare match every SENSOR_ROW_MICROS (250 counts at 16 MHz)
+    cli();
+    TCCR2A = _BV(WGM21);
+    TCCR2B = _BV(CS22);
+    OCR2A = (uint8_t)((F_CPU / 64) * SENSOR_ROW_MICROS / 1000000 - 1);
+    TCNT2 = 0;
+    TIMSK2 = _BV(OCIE2A);
+    sei();
+}
+
+uint8_t SensorMatrix::readRank(uint8_t r)
+{
+    (void)r; // the driven rank is the one read
+    uint8_t bits = 0;
+    for (uint8_t file = 0; file < 8; file++)
+    {
+        if (!(*fileInputs[file] & fileMasks[file]))
+            bits |= 1 << file;
+    }
+    return bits;
+}
+
+// One rank low, the rest released. The output latches stay low, so the
+// direction bit alone drives a line or releases it. The mode registers are
+// shared with other pins: outside the interrupt (begin()) the
+// read-modify-write runs with interrupts off.
+void SensorMatrix::driveRank(uint8_t r)
+{
+    uint8_t oldSREG = SREG;
+    cli();
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        if (i == r)
+            *rankModes[i] |= rankMasks[i];
+        else
+            *rankModes[i] &= ~rankMasks[i];
+    }
+    SREG = oldSREG;
+}
+
+#else
+
+void SensorMatrix::begin()
+{
+    rank = 0;
+    for (uint8_t r = 0; r < 8; r++)
+    {
+        stable[r] = readRank(r);
+        counter0[r] = counter1[r] = 0xFF;
+        buffers[0][r] = buffers[1][r] = stable[r];
+    }
+    SensorEvent stale;
+    while (events.pop(stale))
+    {
+    }
+    seenOverflows = __atomic_load_n(&overflows, __ATOMIC_ACQUIRE);
+}
+
+void SensorMatrix::setSwitches(uint64_t closed)
+{
+    for (uint8_t r = 0; r < 8; r++)
+    {
+        __atomic_store_n(&simulated[r], (uint8_t)(closed >> (8 * r)), __ATOMIC_RELAXED);
+    }
+}
+
+uint64_t SensorMatrix::switches() const
+{
+    uint64_t bits = 0;
+    for (uint8_t r = 0; r < 8; r++)
+    {
+        bits |= (uint64_t)__atomic_load_n(&simulated[r], __ATOMIC_RELAXED) << (8 * r);
+    }
+    return bits;
+}
+
+uint8_t SensorMatrix::readRank(uint8_t r)
+{
+    return __atomic_load_n(&simulated[r], __ATOMIC_RELAXED);
+}
+
+void SensorMatrix::driveRank(uint8_t r)
+{
+    (void)r;
+}
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef SENSORMATRIX_H
+#define SENSORMATRIX_H
+
+#include <Arduino.h>
+#include "ChessTypes.h"
+#include "SpscQueue.h"
+
+// Driver for the 8x8 reed-switch matrix under the squares. A timer
+// interrupt scans one rank per tick, so loop() never waits on the sensors
+// and a slow movePiece() can't make it miss a piece being lifted and put
+// back:
+//
+//   ISR (every SENSOR_ROW_MICROS)  loop()
+//   scanRow() --debounced changes--> poll(event)   lift/place, in order
+//             --complete scans-----> occupancy()   whole board, consistent
+//
+// Debouncing: a square changes once it has read the new state on four
+// scans in a row (32 ms at the default rate); shorter blips are contact
+// bounce and produce no event. Changes go out through a single-producer,
+// single-consumer queue; if loop() falls SENSOR_QUEUE_SIZE events behind,
+// newer events are dropped and takeOverflow() says so, after which
+// occupancy() is the way to resynchronise.
+//
+// Debounced rows are written into two buffers in turn; occupancy() copies
+// the one holding the last complete scan, so it never sees half of one scan
+// and half of the next.
+//
+// AVR: Timer2 in CTC mode drives the scan (so tone() and PWM on pins 9 and
+// 10 are not available). Each tick reads the rank driven since the last
+// tick, then drives the next, so the lines settle without a delay. The
+// interrupt works the port registers directly, looked up once in begin(),
+// rather than through digitalRead() and pinMode(). Host: no hardware; the
+// simulated switches are set with setSwitches() and anything (a test loop,
+// a thread playing the timer) calls scanRow().
+//
+// The global sensors, and on AVR the interrupt, exist only when
+// SMARTCHESS_SENSOR_BOARD is defined for every file (compiler.cpp.extra_flags,
+// see LatencyBench.h), so other builds keep Timer2 and the SRAM.
+
+#ifndef SENSOR_ROW_MICROS
+#define SENSOR_ROW_MICROS 1000 // one rank per tick: the board every 8 ms
+#endif
+
+#ifndef SENSOR_QUEUE_SIZE
+#define SENSOR_QUEUE_SIZE 32 // 4 bytes each
+#endif
+
+// Rank lines (driven low in turn) and file lines (inputs with pull-ups,
+// read low where a piece closes the switch). Defaults: an ATmega2560's
+// pins 22-29 and 30-37.
+#if defined(__AVR__) && defined(SMARTCHESS_SENSOR_BOARD) && !defined(__AVR_ATmega2560__) && \
+    !defined(__AVR_ATmega1280__) && (!defined(SENSOR_RANK_PINS) || !defined(SENSOR_FILE_PINS))
+#error "the default sensor pins 22-37 are a Mega's: define SENSOR_RANK_PINS and SENSOR_FILE_PINS for this board"
+#endif
+#ifndef SENSOR_RANK_PINS
+#define SENSOR_RANK_PINS {22, 23, 24, 25, 26, 27, 28, 29}
+#endif
+#ifndef SENSOR_FILE_PINS
+#define SENSOR_FILE_PINS {30, 31, 32, 33, 34, 35, 36, 37}
+#endif
+
+struct SensorEvent
+{
+  Square square;
+  bool placed;   // false: lifted
+  uint16_t time; // millis() when debouncing accepted it, low 16 bits
+};
+
+class SensorMatrix
+{
+public:
+  SensorMatrix();
+
+  // AVR: sets up the pins and starts the timer. Host: resets the matrix.
+  // The switches read as they are now, without events for pieces present.
+  void begin();
+
+  // The interrupt's work: reads one rank, debounces it and queues changes
+  void scanRow();
+
+  // loop() side
+  bool poll(SensorEvent &event) { return events.pop(event); }
+  uint64_t occupancy() const; // bit sq set: a piece stands there
+  uint8_t scanCount() const { return __atomic_load_n(&scans, __ATOMIC_ACQUIRE); } // complete scans, wrapping
+  bool takeOverflow(); // events dropped since the last call
+  uint8_t pending() const { return events.count(); }
+
+#if !defined(__AVR__)
+  void setSwitches(uint64_t closed); // simulated: bit sq closed (piece present)
+  uint64_t switches() const;
+#endif
+
+private:
+  // Interrupt side
+  uint8_t rank;        // next rank to read
+  uint8_t stable[8];   // debounced state per rank
+  uint8_t counter0[8]; // two-bit counter per square: scans it has read
+  uint8_t counter1[8]; //   differently from its stable state
+  uint8_t overflows;   // events dropped, wrapping
+
+  // Shared, through atomics
+  uint8_t buffers[2][8]; // buffer scans & 1 is being written, the other is complete
+  uint8_t scans;
+  SpscQueue<SensorEvent, SENSOR_QUEUE_SIZE> events;
+
+  // loop() side
+  uint8_t seenOverflows;
+
+#if !defined(__AVR__)
+  uint8_t simulated[8];
+#endif
+
+  uint8_t readRank(uint8_t r); // bit f set: switch closed on file f
+  void driveRank(uint8_t r);
+};
+
+#if defined(SMARTCHESS_SENSOR_BOARD)
+extern SensorMatrix sensors;
+#endif
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <Arduino.h>
+
+// Ring buffer between one producer and one consumer that never block each
+// other: an interrupt handler pushing and loop() popping, or two host
+// threads. Each index has a single writer; 8-bit indices load and store in
+// one instruction on the AVR, and the acquire/release pairs keep an item's
+// contents ordered with the index that publishes it (on the AVR they only
+// stop the compiler reordering). No interrupts are disabled.
+//
+// Size: a power of two up to 128. The indices run freely and wrap; their
+// difference is the fill level.
+template <class T, uint8_t Size>
+class SpscQueue
+{
+  static_assert(Size && (Size & (Size - 1)) == 0 && Size <= 128, "queue size must be a power of two up to 128");
+
+public:
+  SpscQueue() : head(0), tail(0) {}
+
+  // Producer side. False (and the item dropped) when full.
+  bool push(const T &item)
+  {
+    uint8_t h = __atomic_load_n(&head, __ATOMIC_RELAXED);
+    if ((uint8_t)(h - __atomic_load_n(&tail, __ATOMIC_ACQUIRE)) == Size)
+      return false;
+    items[h & (Size - 1)] = item;
+    __atomic_store_n(&head, (uint8_t)(h + 1), __ATOMIC_RELEASE);
+    return true;
+  }
+
+  // Consumer side. False when empty.
+  bool pop(T &item)
+  {
+    uint8_t t = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+    if (__atomic_load_n(&head, __ATOMIC_ACQUIRE) == t)
+      return false;
+    item = items[t & (Size - 1)];
+    __atomic_store_n(&tail, (uint8_t)(t + 1), __ATOMIC_RELEASE);
+    return true;
+  }
+
+  // Either side; a snapshot that may be stale by the time it is read
+  uint8_t count() const { return (uint8_t)(__atomic_load_n(&head, __ATOMIC_ACQUIRE) - __atomic_load_n(&tail, __ATOMIC_ACQUIRE)); }
+
+private:
+  T items[Size];
+  uint8_t head; // next slot to fill; written by the producer only
+  uint8_t tail; // next slot to empty; written by the consumer only
+};
+
+#endif
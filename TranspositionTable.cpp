@@ -0,0 +1,59 @@
+#include "TranspositionTable.h"
+
+#if (TT_ENTRIES & (TT_ENTRIES - 1)) != 0
+#error "TT_ENTRIES must be a power of two"
+#endif
+
+void TranspositionTable::clear()
+{
+    memset(entries, 0, sizeof(entries));
+}
+
+#if defined(__AVR__)
+static inline void loadSlot(const TTEntry &slot, TTEntry &entry)
+{
+    entry = slot;
+}
+static inline void storeSlot(TTEntry &slot, const TTEntry &entry)
+{
+    slot = entry;
+}
+#else
+static_assert(sizeof(TTEntry) == 8 && alignof(TTEntry) == 8, "a slot must be one machine word");
+static inline void loadSlot(const TTEntry &slot, TTEntry &entry)
+{
+    __atomic_load(&slot, &entry, __ATOMIC_RELAXED);
+}
+static inline void storeSlot(TTEntry &slot, const TTEntry &entry)
+{
+    __atomic_store(&slot, &entry, __ATOMIC_RELAXED);
+}
+#endif
+
+bool TranspositionTable::probe(HashKey key, TTEntry &entry) const
+{
+    TTEntry slot;
+    loadSlot(entries[indexOf(key)], slot);
+    if (slot.bound == TT_NONE || slot.check != checkOf(key))
+        return false;
+    entry = slot;
+    return true;
+}
+
+void TranspositionTable::store(HashKey key, Move move, int16_t score, uint8_t depth, TTBound bound)
+{
+    TTEntry slot;
+    loadSlot(entries[indexOf(key)], slot);
+    uint16_t check = checkOf(key);
+    if (slot.bound != TT_NONE && slot.check == check && slot.depth > depth)
+        return;
+    // A result without a move keeps the one found earlier for ordering
+    if (move == NO_MOVE && slot.check == check)
+        move = slot.move;
+    slot.check = check;
+    slot.move = move;
+    slot.score = score;
+    slot.depth = depth;
+    slot.bound = bound;
+    storeSlot(entries[indexOf(key)], slot);
+}
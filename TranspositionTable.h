@@ -0,0 +1,91 @@
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include <Arduino.h>
+#include "ChessTypes.h"
+#include "Hash.h"
+
+// Results of earlier searches, indexed by position key. One table is shared
+// by every search on the board; each search salts its keys (see
+// MATE_KEY_SALT) when its scores mean something different, so the searches
+// share the memory without reading each other's entries.
+//
+// Direct-mapped, 8 bytes per entry. A table is large: keep it in a global
+// or static, never on the stack.
+// 2 KB parts (ATmega328: Uno, Nano) hold the board, Serial and the search
+// in that; they get a smaller table and shallower search defaults
+#if defined(__AVR__) && (RAMEND - RAMSTART + 1) <= 2048
+#define SMARTCHESS_SMALL_SRAM
+#endif
+
+#ifndef TT_ENTRIES
+#if defined(SMARTCHESS_SMALL_SRAM)
+#define TT_ENTRIES 16 // 128 bytes of SRAM
+#elif defined(__AVR__)
+#define TT_ENTRIES 64 // 512 bytes of SRAM
+#else
+#define TT_ENTRIES 65536
+#endif
+#endif
+
+// Scores are in centipawns from the side to move's point of view; a mate
+// in n plies scores MATE_SCORE - n (negated when being mated)
+#define MATE_SCORE 30000
+#define MATE_BOUND (MATE_SCORE - 256) // beyond this, a score is a mate
+
+enum TTBound
+{
+  TT_NONE,
+  TT_UPPER, // score is at most this (no move reached alpha)
+  TT_LOWER, // score is at least this (a move reached beta)
+  TT_EXACT
+};
+
+// Host searches on several threads may share a table: there each slot is
+// read and written as one aligned 8-byte word (TranspositionTable.cpp), so
+// a probe sees one whole entry, never halves of two
+#if defined(__AVR__)
+#define TT_ENTRY_ALIGN
+#else
+#define TT_ENTRY_ALIGN alignas(8)
+#endif
+
+struct TT_ENTRY_ALIGN TTEntry
+{
+  uint16_t check; // top bits of the key, to tell positions sharing a slot apart
+  Move move;
+  int16_t score;
+  uint8_t depth;
+  uint8_t bound;
+};
+
+// Mate scores are stored as distances from the stored node, not the root,
+// so they stay right when the position is reached at another ply
+inline int16_t scoreToTT(int16_t score, uint8_t ply)
+{
+  return score > MATE_BOUND ? score + ply : score < -MATE_BOUND ? score - ply : score;
+}
+inline int16_t scoreFromTT(int16_t score, uint8_t ply)
+{
+  return score > MATE_BOUND ? score - ply : score < -MATE_BOUND ? score + ply : score;
+}
+
+class TranspositionTable
+{
+public:
+  TranspositionTable() { clear(); }
+  void clear();
+
+  bool probe(HashKey key, TTEntry &entry) const;
+  // Keeps the deeper result when two searches of one position meet; another
+  // position always takes the slot over
+  void store(HashKey key, Move move, int16_t score, uint8_t depth, TTBound bound);
+
+private:
+  TTEntry entries[TT_ENTRIES];
+
+  static uint16_t checkOf(HashKey key) { return (uint16_t)(key >> (8 * sizeof(HashKey) - 16)); }
+  static uint32_t indexOf(HashKey key) { return (uint32_t)(key & (TT_ENTRIES - 1)); }
+};
+
+#endif
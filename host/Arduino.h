@@ -0,0 +1,124 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+// Minimal stand-in for the Arduino core so the sketch sources (ChessBoard,
+// pieces, tables) build unchanged on a Linux host for the tools in host/.
+// Only what the sketch actually uses is provided.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <chrono>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+
+inline unsigned long micros()
+{
+  static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+inline unsigned long millis() { return micros() / 1000; }
+
+// Host tools replay thousands of games; they mute the debug prints.
+inline bool &arduinoSerialMuted()
+{
+  static bool muted = false;
+  return muted;
+}
+
+// A host tool standing in for the far end of the serial port takes the
+// bytes here instead of stdout
+typedef void (*SerialTap)(const uint8_t *data, size_t size);
+inline SerialTap &arduinoSerialTap()
+{
+  static SerialTap tap = nullptr;
+  return tap;
+}
+
+class HardwareSerial
+{
+public:
+  void begin(unsigned long) {}
+  operator bool() const { return true; }
+
+  size_t write(uint8_t b)
+  {
+    if (arduinoSerialTap() && !arduinoSerialMuted())
+    {
+      arduinoSerialTap()(&b, 1);
+      return 1;
+    }
+    return emit("%c", (char)b);
+  }
+  size_t write(const uint8_t *buf, size_t len)
+  {
+    for (size_t i = 0; i < len; i++)
+      write(buf[i]);
+    return len;
+  }
+
+  size_t print(const char *s) { return emit("%s", s); }
+  size_t print(char c) { return emit("%c", c); }
+  size_t print(int v) { return emit("%d", v); }
+  size_t print(unsigned int v) { return emit("%u", v); }
+  size_t print(long v) { return emit("%ld", v); }
+  size_t print(unsigned long v) { return emit("%lu", v); }
+  size_t print(double v) { return emit("%.2f", v); }
+
+  size_t println() { return emit("\n"); }
+  template <typename T>
+  size_t println(T v)
+  {
+    size_t n = print(v);
+    return n + println();
+  }
+
+  void flush() { fflush(stdout); }
+
+private:
+  template <typename T>
+  size_t emit(const char *fmt, T v)
+  {
+    if (arduinoSerialMuted())
+      return 0;
+    if (arduinoSerialTap())
+    {
+      char text[128];
+      int n = snprintf(text, sizeof(text), fmt, v);
+      n = n < (int)sizeof(text) ? n : (int)sizeof(text) - 1;
+      if (n > 0)
+        arduinoSerialTap()((const uint8_t *)text, (size_t)n);
+      return n > 0 ? (size_t)n : 0;
+    }
+    int n = printf(fmt, v);
+    return n > 0 ? (size_t)n : 0;
+  }
+  size_t emit(const char *fmt)
+  {
+    if (arduinoSerialMuted())
+      return 0;
+    if (arduinoSerialTap())
+    {
+      arduinoSerialTap()((const uint8_t *)fmt, strlen(fmt));
+      return strlen(fmt);
+    }
+    int n = printf("%s", fmt);
+    return n > 0 ? (size_t)n : 0;
+  }
+};
+
+static HardwareSerial Serial __attribute__((unused));
+
+#endif
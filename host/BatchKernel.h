@@ -0,0 +1,109 @@
+// Bitboard kernel of validateMoves(), written once against a small lane API
+// and included by BatchValidate.cpp inside one namespace per instruction
+// set. No include guard on purpose. The including namespace provides:
+//
+//   Vec, LANES               vector type and the number of uint64 lanes in it
+//   BATCH_TARGET             function attribute enabling the instruction set
+//   vload, vstore, vset      aligned load/store, broadcast
+//   vand, vor, vandnot       vandnot(a, b) = a & ~b
+//   vshl, vshr               per-lane 64-bit shifts
+//
+// and the file itself defines validateGroup(), filling the result fields of
+// a LaneGroup (BATCH_GROUP requests).
+//
+// Sliding attacks use Kogge-Stone fills: three shift/and steps per
+// direction, no table lookups, so every lane runs the same instructions.
+
+static const uint64_t NOT_FILE_A = 0xFEFEFEFEFEFEFEFEULL;
+static const uint64_t NOT_FILE_H = 0x7F7F7F7F7F7F7F7FULL;
+static const uint64_t NOT_FILE_AB = 0xFCFCFCFCFCFCFCFCULL;
+static const uint64_t NOT_FILE_GH = 0x3F3F3F3F3F3F3F3FULL;
+
+// Squares a slider on gen reaches stepping +n (wrap guards the file edge),
+// up to and including the first occupied square
+static inline BATCH_TARGET Vec fillUp(Vec gen, Vec empty, int n, Vec wrap)
+{
+  Vec pass = vand(empty, wrap);
+  gen = vor(gen, vand(pass, vshl(gen, n)));
+  pass = vand(pass, vshl(pass, n));
+  gen = vor(gen, vand(pass, vshl(gen, 2 * n)));
+  pass = vand(pass, vshl(pass, 2 * n));
+  gen = vor(gen, vand(pass, vshl(gen, 4 * n)));
+  return vand(vshl(gen, n), wrap);
+}
+
+static inline BATCH_TARGET Vec fillDown(Vec gen, Vec empty, int n, Vec wrap)
+{
+  Vec pass = vand(empty, wrap);
+  gen = vor(gen, vand(pass, vshr(gen, n)));
+  pass = vand(pass, vshr(pass, n));
+  gen = vor(gen, vand(pass, vshr(gen, 2 * n)));
+  pass = vand(pass, vshr(pass, 2 * n));
+  gen = vor(gen, vand(pass, vshr(gen, 4 * n)));
+  return vand(vshr(gen, n), wrap);
+}
+
+static inline BATCH_TARGET Vec straightReach(Vec from, Vec empty)
+{
+  Vec all = vset(~0ULL), notA = vset(NOT_FILE_A), notH = vset(NOT_FILE_H);
+  return vor(vor(fillUp(from, empty, 8, all), fillDown(from, empty, 8, all)),
+             vor(fillUp(from, empty, 1, notA), fillDown(from, empty, 1, notH)));
+}
+
+static inline BATCH_TARGET Vec diagonalReach(Vec from, Vec empty)
+{
+  Vec notA = vset(NOT_FILE_A), notH = vset(NOT_FILE_H);
+  return vor(vor(fillUp(from, empty, 9, notA), fillUp(from, empty, 7, notH)),
+             vor(fillDown(from, empty, 7, notA), fillDown(from, empty, 9, notH)));
+}
+
+static inline BATCH_TARGET Vec knightReach(Vec b)
+{
+  Vec one = vor(vand(vshl(b, 1), vset(NOT_FILE_A)), vand(vshr(b, 1), vset(NOT_FILE_H)));
+  Vec two = vor(vand(vshl(b, 2), vset(NOT_FILE_AB)), vand(vshr(b, 2), vset(NOT_FILE_GH)));
+  return vor(vor(vshl(one, 16), vshr(one, 16)), vor(vshl(two, 8), vshr(two, 8)));
+}
+
+static inline BATCH_TARGET Vec kingReach(Vec b)
+{
+  Vec side = vor(vand(vshl(b, 1), vset(NOT_FILE_A)), vand(vshr(b, 1), vset(NOT_FILE_H)));
+  Vec row = vor(b, side);
+  return vor(side, vor(vshl(row, 8), vshr(row, 8)));
+}
+
+// Squares from which an enemy pawn attacks a king on b; white is all ones in
+// lanes where the king is white
+static inline BATCH_TARGET Vec pawnThreats(Vec b, Vec white)
+{
+  Vec notA = vset(NOT_FILE_A), notH = vset(NOT_FILE_H);
+  Vec up = vor(vand(vshl(b, 7), notH), vand(vshl(b, 9), notA));
+  Vec down = vor(vand(vshr(b, 9), notH), vand(vshr(b, 7), notA));
+  return vor(vand(white, up), vandnot(down, white));
+}
+
+static BATCH_TARGET void validateGroup(LaneGroup &g)
+{
+  Vec all = vset(~0ULL);
+  for (int i = 0; i < BATCH_GROUP; i += LANES)
+  {
+    // Can the piece on from reach to at all?
+    Vec from = vload(g.from + i);
+    Vec empty = vandnot(all, vload(g.occupied + i));
+    Vec reach = vload(g.forced + i);
+    reach = vor(reach, vand(vload(g.straight + i), straightReach(from, empty)));
+    reach = vor(reach, vand(vload(g.diagonal + i), diagonalReach(from, empty)));
+    reach = vor(reach, vand(vload(g.knight + i), knightReach(from)));
+    reach = vor(reach, vand(vload(g.kingMove + i), kingReach(from)));
+    vstore(g.reached + i, vand(reach, vload(g.to + i)));
+
+    // Enemy pieces attacking the mover's king once the move is made
+    Vec king = vload(g.king + i);
+    Vec emptyAfter = vandnot(all, vload(g.after + i));
+    Vec attackers = vand(vload(g.theirStraight + i), straightReach(king, emptyAfter));
+    attackers = vor(attackers, vand(vload(g.theirDiagonal + i), diagonalReach(king, emptyAfter)));
+    attackers = vor(attackers, vand(vload(g.theirKnights + i), knightReach(king)));
+    attackers = vor(attackers, vand(vload(g.theirKing + i), kingReach(king)));
+    attackers = vor(attackers, vand(vload(g.theirPawns + i), pawnThreats(king, vload(g.white + i))));
+    vstore(g.attackers + i, attackers);
+  }
+}
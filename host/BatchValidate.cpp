@@ -0,0 +1,235 @@
+#include "BatchValidate.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BATCH_X86 1
+#else
+#define BATCH_X86 0
+#endif
+
+#if !defined(SMARTCHESS_MAILBOX_BACKEND)
+
+// Requests are gathered four at a time into one field per array, so a vector
+// load picks up the same field of neighbouring requests
+#define BATCH_GROUP 4
+
+struct alignas(32) LaneGroup
+{
+    uint64_t from[BATCH_GROUP];
+    uint64_t to[BATCH_GROUP];
+    uint64_t occupied[BATCH_GROUP];
+    uint64_t after[BATCH_GROUP]; // occupancy once the move is made
+    uint64_t king[BATCH_GROUP];  // mover's king once the move is made
+
+    // All ones when the moving piece steps that way, else zero
+    uint64_t straight[BATCH_GROUP];
+    uint64_t diagonal[BATCH_GROUP];
+    uint64_t knight[BATCH_GROUP];
+    uint64_t kingMove[BATCH_GROUP];
+    uint64_t forced[BATCH_GROUP]; // pawn and special moves, decided up front
+
+    // Enemy pieces left once the move is made
+    uint64_t theirStraight[BATCH_GROUP];
+    uint64_t theirDiagonal[BATCH_GROUP];
+    uint64_t theirKnights[BATCH_GROUP];
+    uint64_t theirPawns[BATCH_GROUP];
+    uint64_t theirKing[BATCH_GROUP];
+    uint64_t white[BATCH_GROUP];
+
+    // Results: non-zero if the piece reaches to, non-zero if the king is attacked
+    uint64_t reached[BATCH_GROUP];
+    uint64_t attackers[BATCH_GROUP];
+};
+
+static inline uint64_t allIf(bool condition)
+{
+    return condition ? ~0ULL : 0;
+}
+
+// Fills lane i from one request. Encoding checks and pawn, castling and en
+// passant moves are settled here by the scalar code; the kernel only has to
+// decide piece reach and king safety.
+static void loadLane(LaneGroup &g, int i, const Position &p, Move m)
+{
+    const BitboardBackend &board = p.board;
+    Square from = moveFrom(m);
+    Square to = moveTo(m);
+    MoveFlag flag = moveFlag(m);
+    PieceColor side = p.sideToMove;
+    PieceColor them = opponent(side);
+    uint64_t fromBit = 1ULL << from;
+    uint64_t toBit = 1ULL << to;
+    uint64_t own = board.colorSet(side);
+
+    // Set tests instead of pieceAt(): no search for the piece type
+    bool mine = (own & fromBit) != 0;
+    bool pawn = mine && (board.typeSet(PAWN) & fromBit);
+    bool king = mine && (board.typeSet(KING) & fromBit);
+    bool plain = mine && !pawn && flag == MOVE_NORMAL && movePromotion(m) == PROMOTE_QUEEN && !(own & toBit);
+    bool special = mine && (pawn || flag != MOVE_NORMAL);
+
+    uint64_t victim = flag == MOVE_EN_PASSANT ? 1ULL << enPassantVictim(m) : toBit;
+    uint64_t occupied = board.occupied();
+    uint64_t after = (occupied & ~fromBit & ~victim) | toBit;
+    if (flag == MOVE_CASTLING)
+        after ^= to > from ? (1ULL << (from + 3)) | (1ULL << (from + 1)) : (1ULL << (from - 4)) | (1ULL << (from - 1));
+
+    g.from[i] = fromBit;
+    g.to[i] = toBit;
+    g.occupied[i] = occupied;
+    g.after[i] = after;
+    g.king[i] = king ? toBit : board.typeSet(KING) & own;
+
+    uint64_t queen = board.typeSet(QUEEN) & fromBit;
+    g.straight[i] = allIf(plain && ((board.typeSet(ROOK) & fromBit) || queen));
+    g.diagonal[i] = allIf(plain && ((board.typeSet(BISHOP) & fromBit) || queen));
+    g.knight[i] = allIf(plain && (board.typeSet(KNIGHT) & fromBit));
+    g.kingMove[i] = allIf(plain && king);
+    g.forced[i] = allIf(special && isPseudoLegal(board, side, p.castlingRights, p.epSquare, m));
+
+    uint64_t enemy = board.colorSet(them) & ~victim;
+    uint64_t queens = board.typeSet(QUEEN);
+    g.theirStraight[i] = enemy & (board.typeSet(ROOK) | queens);
+    g.theirDiagonal[i] = enemy & (board.typeSet(BISHOP) | queens);
+    g.theirKnights[i] = enemy & board.typeSet(KNIGHT);
+    g.theirPawns[i] = enemy & board.typeSet(PAWN);
+    g.theirKing[i] = enemy & board.typeSet(KING);
+    g.white[i] = allIf(side == WHITE);
+}
+
+namespace scalar_lanes
+{
+    typedef uint64_t Vec;
+    static const int LANES = 1;
+#define BATCH_TARGET
+    static inline Vec vload(const uint64_t *p) { return *p; }
+    static inline void vstore(uint64_t *p, Vec v) { *p = v; }
+    static inline Vec vset(uint64_t x) { return x; }
+    static inline Vec vand(Vec a, Vec b) { return a & b; }
+    static inline Vec vor(Vec a, Vec b) { return a | b; }
+    static inline Vec vandnot(Vec a, Vec b) { return a & ~b; }
+    static inline Vec vshl(Vec v, int n) { return v << n; }
+    static inline Vec vshr(Vec v, int n) { return v >> n; }
+#include "BatchKernel.h"
+#undef BATCH_TARGET
+}
+
+#if BATCH_X86
+namespace sse2_lanes
+{
+    typedef __m128i Vec;
+    static const int LANES = 2;
+#define BATCH_TARGET __attribute__((target("sse2")))
+    static inline BATCH_TARGET Vec vload(const uint64_t *p) { return _mm_load_si128((const __m128i *)p); }
+    static inline BATCH_TARGET void vstore(uint64_t *p, Vec v) { _mm_store_si128((__m128i *)p, v); }
+    static inline BATCH_TARGET Vec vset(uint64_t x) { return _mm_set1_epi64x((long long)x); }
+    static inline BATCH_TARGET Vec vand(Vec a, Vec b) { return _mm_and_si128(a, b); }
+    static inline BATCH_TARGET Vec vor(Vec a, Vec b) { return _mm_or_si128(a, b); }
+    static inline BATCH_TARGET Vec vandnot(Vec a, Vec b) { return _mm_andnot_si128(b, a); }
+    static inline BATCH_TARGET Vec vshl(Vec v, int n) { return _mm_slli_epi64(v, n); }
+    static inline BATCH_TARGET Vec vshr(Vec v, int n) { return _mm_srli_epi64(v, n); }
+#include "BatchKernel.h"
+#undef BATCH_TARGET
+}
+
+namespace avx2_lanes
+{
+    typedef __m256i Vec;
+    static const int LANES = 4;
+#define BATCH_TARGET __attribute__((target("avx2")))
+    static inline BATCH_TARGET Vec vload(const uint64_t *p) { return _mm256_load_si256((const __m256i *)p); }
+    static inline BATCH_TARGET void vstore(uint64_t *p, Vec v) { _mm256_store_si256((__m256i *)p, v); }
+    static inline BATCH_TARGET Vec vset(uint64_t x) { return _mm256_set1_epi64x((long long)x); }
+    static inline BATCH_TARGET Vec vand(Vec a, Vec b) { return _mm256_and_si256(a, b); }
+    static inline BATCH_TARGET Vec vor(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+    static inline BATCH_TARGET Vec vandnot(Vec a, Vec b) { return _mm256_andnot_si256(b, a); }
+    static inline BATCH_TARGET Vec vshl(Vec v, int n) { return _mm256_slli_epi64(v, n); }
+    static inline BATCH_TARGET Vec vshr(Vec v, int n) { return _mm256_srli_epi64(v, n); }
+#include "BatchKernel.h"
+#undef BATCH_TARGET
+}
+#endif
+
+#endif // !SMARTCHESS_MAILBOX_BACKEND
+
+BatchIsa batchValidationIsa()
+{
+#if BATCH_X86 && !defined(SMARTCHESS_MAILBOX_BACKEND)
+    if (__builtin_cpu_supports("avx2"))
+        return BATCH_AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return BATCH_SSE2;
+#endif
+    return BATCH_SCALAR;
+}
+
+const char *batchIsaName(BatchIsa isa)
+{
+    switch (isa)
+    {
+    case BATCH_AVX2:
+        return "avx2";
+    case BATCH_SSE2:
+        return "sse2";
+    case BATCH_SCALAR:
+        return "scalar";
+    default:
+        return "auto";
+    }
+}
+
+void validateMoves(const Position *positions, const Move *moves, bool *legal, size_t count)
+{
+    static const BatchIsa best = batchValidationIsa();
+    validateMoves(positions, moves, legal, count, best);
+}
+
+void validateMoves(const Position *positions, const Move *moves, bool *legal, size_t count, BatchIsa isa)
+{
+#if defined(SMARTCHESS_MAILBOX_BACKEND)
+    // No bitboards to work on: one move at a time
+    (void)isa;
+    for (size_t i = 0; i < count; i++)
+    {
+        legal[i] = positions[i].isLegal(moves[i]);
+    }
+#else
+    BatchIsa supported = batchValidationIsa();
+    if (isa == BATCH_AUTO || isa > supported)
+        isa = supported;
+
+    LaneGroup group;
+    for (size_t base = 0; base < count; base += BATCH_GROUP)
+    {
+        size_t n = count - base < BATCH_GROUP ? count - base : BATCH_GROUP;
+        for (size_t i = 0; i < n; i++)
+        {
+            loadLane(group, i, positions[base + i], moves[base + i]);
+        }
+        for (size_t i = n; i < BATCH_GROUP; i++)
+        {
+            loadLane(group, i, positions[base], moves[base]); // padding, result unused
+        }
+
+        switch (isa)
+        {
+#if BATCH_X86
+        case BATCH_AVX2:
+            avx2_lanes::validateGroup(group);
+            break;
+        case BATCH_SSE2:
+            sse2_lanes::validateGroup(group);
+            break;
+#endif
+        default:
+            scalar_lanes::validateGroup(group);
+            break;
+        }
+
+        for (size_t i = 0; i < n; i++)
+        {
+            legal[base + i] = group.reached[i] != 0 && group.attackers[i] == 0;
+        }
+    }
+#endif
+}
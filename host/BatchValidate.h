@@ -0,0 +1,30 @@
+#ifndef BATCHVALIDATE_H
+#define BATCHVALIDATE_H
+
+// Batched legality checks for the relay server: one call validates a burst
+// of (position, move) requests. Positions are processed in groups of four;
+// the bitboard work for a group (the moving piece's reach, and whether the
+// mover's king is attacked after the move) runs in SIMD lanes, AVX2 or SSE2
+// picked at run time, with a portable scalar fallback.
+//
+// Results match Position::isLegal() for every move encoding.
+
+#include <Arduino.h>
+#include <stddef.h>
+#include "Position.h"
+
+enum BatchIsa
+{
+  BATCH_SCALAR,
+  BATCH_SSE2,
+  BATCH_AVX2,
+  BATCH_AUTO
+};
+
+void validateMoves(const Position *positions, const Move *moves, bool *legal, size_t count);
+// Same, on a chosen instruction set (falls back if the CPU lacks it)
+void validateMoves(const Position *positions, const Move *moves, bool *legal, size_t count, BatchIsa isa);
+BatchIsa batchValidationIsa(); // what BATCH_AUTO resolves to on this CPU
+const char *batchIsaName(BatchIsa isa);
+
+#endif
@@ -0,0 +1,134 @@
+#include "GameReview.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+const char *moveGradeName(MoveGrade grade)
+{
+    static const char *const names[GRADE_COUNT] = {"best", "good", "inaccuracy", "mistake", "blunder"};
+    return grade < GRADE_COUNT ? names[grade] : "?";
+}
+
+GameReview::GameReview(TranspositionTable &table, int threads)
+    : table(table), threads(std::max(1, threads)), nodes(0)
+{
+}
+
+// Number of legal moves in p, counting to two; only gets the first
+static int legalMoves(const Position &p, Move &only)
+{
+    int count = 0;
+    auto visit = [&](Move m)
+    {
+        if (leavesKingInCheck(p.board, m, p.sideToMove))
+            return false;
+        only = m;
+        return ++count == 2;
+    };
+    generateMoves(p.board, p.sideToMove, p.castlingRights, p.epSquare, visit);
+    return count;
+}
+
+// Searches p to depth in one go; returns the nodes searched
+static uint32_t searchScore(Search &search, const Position &p, uint8_t depth, int16_t &score)
+{
+    search.startHint(p, 0xFFFFFFFFUL, depth);
+    while (search.pollHint() == HINT_THINKING)
+    {
+    }
+    score = search.bestScore();
+    return search.getNodes();
+}
+
+static int16_t capped(int16_t score)
+{
+    return std::max(-REVIEW_SCORE_CAP, std::min((int)score, REVIEW_SCORE_CAP));
+}
+
+bool GameReview::review(const Position &start, const Move *moves, int count, uint8_t depth,
+                        std::vector<MoveReview> &out)
+{
+    std::vector<Position> positions(count + 1);
+    positions[0] = start;
+    for (int i = 0; i < count; i++)
+    {
+        if (!positions[i].isLegal(moves[i]))
+            return false;
+        positions[i + 1] = positions[i];
+        positions[i + 1].makeMove(moves[i]);
+    }
+
+    // Every position's score and best move, the last position first
+    std::vector<int16_t> scores(count + 1);
+    std::vector<Move> bests(count + 1);
+    std::atomic<int> next(count);
+    std::atomic<uint64_t> searched(0);
+    auto work = [&]()
+    {
+        Search search(table);
+        search.setSliceMicros(0);
+        search.setSliceNodes(0);
+        uint64_t myNodes = 0;
+        for (int i; (i = next--) >= 0;)
+        {
+            const Position &p = positions[i];
+            Move only = NO_MOVE;
+            int legal = legalMoves(p, only);
+            if (legal == 0)
+            {
+                scores[i] = p.inCheck() ? -MATE_SCORE : 0;
+                bests[i] = NO_MOVE;
+                continue;
+            }
+            if (legal == 1)
+            {
+                // The search answers a forced move without scoring it:
+                // score the position after it instead, a ply further on
+                bests[i] = only;
+                Position after = p;
+                after.makeMove(only);
+                int16_t reply = 0;
+                if (legalMoves(after, only) == 0)
+                    reply = after.inCheck() ? -MATE_SCORE : 0;
+                else
+                {
+                    myNodes += searchScore(search, after, depth, reply);
+                }
+                scores[i] = reply > MATE_BOUND ? -reply + 1 : reply < -MATE_BOUND ? -reply - 1 : -reply;
+                continue;
+            }
+            myNodes += searchScore(search, p, depth, scores[i]);
+            bests[i] = search.bestMove();
+        }
+        searched += myNodes;
+    };
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; t++)
+    {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    nodes = searched;
+
+    out.resize(count);
+    for (int i = 0; i < count; i++)
+    {
+        MoveReview &r = out[i];
+        r.played = moves[i];
+        r.best = bests[i];
+        r.bestScore = scores[i];
+        r.playedScore = -scores[i + 1];
+        r.loss = r.played == r.best ? 0 : std::max(0, capped(r.bestScore) - capped(r.playedScore));
+        r.grade = r.played == r.best            ? GRADE_BEST
+                  : r.loss >= REVIEW_BLUNDER    ? GRADE_BLUNDER
+                  : r.loss >= REVIEW_MISTAKE    ? GRADE_MISTAKE
+                  : r.loss >= REVIEW_INACCURACY ? GRADE_INACCURACY
+                                                : GRADE_GOOD;
+    }
+    return true;
+}
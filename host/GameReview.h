@@ -0,0 +1,77 @@
+#ifndef GAMEREVIEW_H
+#define GAMEREVIEW_H
+
+// Post-game review: every position of a finished game searched to a fixed
+// depth, and each move graded by how much it gave away against the best
+// move in its position. The positions are handed out to worker threads,
+// last first, and each worker runs its own Search on one shared
+// TranspositionTable. A position's subtree then finds the results of the
+// position after it (or the one before, searched at the same time) in the
+// table.
+//
+// Scores are in centipawns from the mover's point of view. A move's loss
+// is the best move's score minus the played one's (the score of the next
+// position, negated), with both capped at REVIEW_SCORE_CAP so that
+// "winning" compares with "mating". A move the search also picked loses
+// nothing.
+//
+// With more than one thread the table's contents depend on timing, so
+// scores (and now and then a grade) can differ from run to run.
+
+#include <Arduino.h>
+#include <vector>
+#include "Search.h"
+
+#ifndef REVIEW_INACCURACY
+#define REVIEW_INACCURACY 50 // centipawns lost
+#endif
+#ifndef REVIEW_MISTAKE
+#define REVIEW_MISTAKE 100
+#endif
+#ifndef REVIEW_BLUNDER
+#define REVIEW_BLUNDER 300
+#endif
+#ifndef REVIEW_SCORE_CAP
+#define REVIEW_SCORE_CAP 1000
+#endif
+
+enum MoveGrade
+{
+  GRADE_BEST, // the search's own choice
+  GRADE_GOOD,
+  GRADE_INACCURACY,
+  GRADE_MISTAKE,
+  GRADE_BLUNDER,
+  GRADE_COUNT
+};
+
+const char *moveGradeName(MoveGrade grade);
+
+struct MoveReview
+{
+  Move played;
+  Move best; // NO_MOVE if the search found none
+  int16_t bestScore;   // mover's view, before the move
+  int16_t playedScore; // mover's view, after the move
+  int16_t loss;        // capped scores' difference, never negative
+  MoveGrade grade;
+};
+
+class GameReview
+{
+public:
+  GameReview(TranspositionTable &table, int threads);
+
+  // Reviews count moves played from start; out gets one entry per move.
+  // False if a move isn't legal where it is played.
+  bool review(const Position &start, const Move *moves, int count, uint8_t depth, std::vector<MoveReview> &out);
+
+  uint64_t getNodes() const { return nodes; } // of the last review
+
+private:
+  TranspositionTable &table;
+  int threads;
+  uint64_t nodes;
+};
+
+#endif
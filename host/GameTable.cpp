@@ -0,0 +1,131 @@
+#include "GameTable.h"
+
+GameTable::GameTable(uint32_t capacity)
+    : capacity(capacity), liveCount(0),
+      boards(capacity), sideToMove(capacity), castlingRights(capacity), epSquare(capacity),
+      gameState(capacity), historyCount(capacity), live(capacity, 0), halfMoveClock(capacity),
+      fullMoveNumber(capacity), history((size_t)capacity * GAME_TABLE_HISTORY)
+{
+    // Hand out low ids first
+    freeIds.reserve(capacity);
+    for (uint32_t id = capacity; id > 0; id--)
+    {
+        freeIds.push_back(id - 1);
+    }
+}
+
+GameId GameTable::createGame()
+{
+    Position start;
+    start.setStartPosition();
+    return createGame(start);
+}
+
+GameId GameTable::createGame(const Position &start)
+{
+    if (freeIds.empty())
+        return NO_GAME;
+
+    GameId id = freeIds.back();
+    freeIds.pop_back();
+    live[id] = 1;
+    liveCount++;
+
+    store(id, start);
+    historyCount[id] = 0;
+    pushHistory(id, (uint32_t)start.key());
+    gameState[id] = GAME_ACTIVE;
+    return id;
+}
+
+void GameTable::releaseGame(GameId id)
+{
+    if (!isLive(id))
+        return;
+    live[id] = 0;
+    liveCount--;
+    freeIds.push_back(id);
+}
+
+Position GameTable::getPosition(GameId id) const
+{
+    Position p;
+    p.board = boards[id];
+    p.sideToMove = (PieceColor)sideToMove[id];
+    p.castlingRights = castlingRights[id];
+    p.epSquare = epSquare[id];
+    p.halfMoveClock = halfMoveClock[id];
+    p.fullMoveNumber = fullMoveNumber[id];
+    return p;
+}
+
+void GameTable::store(GameId id, const Position &p)
+{
+    boards[id] = p.board;
+    sideToMove[id] = p.sideToMove;
+    castlingRights[id] = p.castlingRights;
+    epSquare[id] = p.epSquare;
+    halfMoveClock[id] = p.halfMoveClock;
+    fullMoveNumber[id] = p.fullMoveNumber;
+}
+
+bool GameTable::isMoveLegal(GameId id, Move m) const
+{
+    return isLive(id) && gameState[id] == GAME_ACTIVE && getPosition(id).isLegal(m);
+}
+
+MoveResult GameTable::applyMove(GameId id, Move m)
+{
+    if (!isLive(id))
+        return MOVE_NO_SUCH_GAME;
+    if (gameState[id] != GAME_ACTIVE)
+        return MOVE_GAME_OVER;
+
+    Position p = getPosition(id);
+    if (!p.isLegal(m))
+        return MOVE_ILLEGAL;
+
+    bool check = givesCheck(p.board, m);
+    p.makeMove(m);
+    store(id, p);
+
+    // Nothing before a capture or pawn move can repeat
+    uint32_t key = (uint32_t)p.key();
+    if (p.halfMoveClock == 0)
+        historyCount[id] = 0;
+    pushHistory(id, key);
+
+    // Same rules as ChessBoard::updateGameState
+    if (!p.hasLegalMove())
+        gameState[id] = check ? (p.sideToMove == WHITE ? GAME_CHECKMATE_WHITE : GAME_CHECKMATE_BLACK) : GAME_STALEMATE;
+    else if (p.halfMoveClock >= 100 || countRepetitions(id, key) >= 3 ||
+             isInsufficientMaterial(p.board.materialKey()))
+        gameState[id] = GAME_DRAW;
+    return MOVE_APPLIED;
+}
+
+void GameTable::pushHistory(GameId id, uint32_t key)
+{
+    uint32_t *keys = &history[(size_t)id * GAME_TABLE_HISTORY];
+    if (historyCount[id] == GAME_TABLE_HISTORY)
+    {
+        for (int i = 0; i < GAME_TABLE_HISTORY - 1; i++)
+        {
+            keys[i] = keys[i + 1];
+        }
+        historyCount[id]--;
+    }
+    keys[historyCount[id]++] = key;
+}
+
+int GameTable::countRepetitions(GameId id, uint32_t key) const
+{
+    const uint32_t *keys = &history[(size_t)id * GAME_TABLE_HISTORY];
+    int count = 0;
+    for (int i = 0; i < historyCount[id]; i++)
+    {
+        if (keys[i] == key)
+            count++;
+    }
+    return count;
+}
@@ -0,0 +1,88 @@
+#ifndef GAMETABLE_H
+#define GAMETABLE_H
+
+// Host library mode for the relay server: many concurrent games in one
+// table. Storage is column-wise (struct of arrays): each field of every game
+// sits in its own contiguous array, so a game costs exactly the sum of its
+// columns and scanning one field across all games touches only that field.
+
+#include <Arduino.h>
+#include <vector>
+#include "ChessBoard.h"
+
+typedef uint32_t GameId;
+#define NO_GAME 0xFFFFFFFFUL
+
+// Position keys (low 32 bits) kept per game for repetition detection. The
+// window restarts at every capture or pawn move.
+#define GAME_TABLE_HISTORY 12
+
+// The columns are sized around the bitboard backend (80 bytes a board). A
+// mailbox board is 120 bytes on the host (piece lists, a 64-bit key), so a
+// SMARTCHESS_MAILBOX_BACKEND build has a budget of its own.
+#ifndef GAME_TABLE_BYTES_PER_GAME_BUDGET
+#if defined(SMARTCHESS_MAILBOX_BACKEND)
+#define GAME_TABLE_BYTES_PER_GAME_BUDGET 184
+#else
+#define GAME_TABLE_BYTES_PER_GAME_BUDGET 144
+#endif
+#endif
+
+enum MoveResult
+{
+  MOVE_APPLIED,
+  MOVE_ILLEGAL,
+  MOVE_GAME_OVER,
+  MOVE_NO_SUCH_GAME
+};
+
+class GameTable
+{
+public:
+  explicit GameTable(uint32_t capacity);
+
+  GameId createGame(); // Standard starting position; NO_GAME when full
+  GameId createGame(const Position &start);
+  void releaseGame(GameId id);
+
+  // Validates m for the side to move and plays it, then updates the game state
+  MoveResult applyMove(GameId id, Move m);
+  bool isMoveLegal(GameId id, Move m) const;
+
+  bool isLive(GameId id) const { return id < capacity && live[id]; }
+  GameState getGameState(GameId id) const { return (GameState)gameState[id]; }
+  Position getPosition(GameId id) const;
+  uint32_t getCapacity() const { return capacity; }
+  uint32_t getLiveCount() const { return liveCount; }
+
+  static constexpr size_t bytesPerGame()
+  {
+    return sizeof(BoardBackend) + 6 * sizeof(uint8_t) + 2 * sizeof(uint16_t) +
+           GAME_TABLE_HISTORY * sizeof(uint32_t) + sizeof(GameId);
+  }
+
+private:
+  uint32_t capacity;
+  uint32_t liveCount;
+
+  // One column per field, indexed by GameId
+  std::vector<BoardBackend> boards;
+  std::vector<uint8_t> sideToMove;
+  std::vector<uint8_t> castlingRights;
+  std::vector<uint8_t> epSquare;
+  std::vector<uint8_t> gameState;
+  std::vector<uint8_t> historyCount;
+  std::vector<uint8_t> live;
+  std::vector<uint16_t> halfMoveClock;
+  std::vector<uint16_t> fullMoveNumber;
+  std::vector<uint32_t> history; // GAME_TABLE_HISTORY entries per game
+  std::vector<GameId> freeIds;
+
+  void store(GameId id, const Position &p);
+  void pushHistory(GameId id, uint32_t key);
+  int countRepetitions(GameId id, uint32_t key) const;
+};
+
+static_assert(GameTable::bytesPerGame() <= GAME_TABLE_BYTES_PER_GAME_BUDGET, "game table exceeds its per-game budget");
+
+#endif
@@ -0,0 +1,265 @@
+#include "OpeningIndex.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <queue>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static bool entryLess(const OpeningIndexEntry &a, const OpeningIndexEntry &b)
+{
+    return a.key != b.key ? a.key < b.key : a.move < b.move;
+}
+
+static bool sameMove(const OpeningIndexEntry &a, const OpeningIndexEntry &b)
+{
+    return a.key == b.key && a.move == b.move;
+}
+
+static void addCounts(OpeningIndexEntry &to, const OpeningIndexEntry &from)
+{
+    to.whiteWins += from.whiteWins;
+    to.draws += from.draws;
+    to.blackWins += from.blackWins;
+}
+
+int indexGame(const PgnGame &game, int maxPlies, std::vector<OpeningIndexEntry> &out)
+{
+    OpeningIndexEntry counted = {0, NO_MOVE, 0, 0, 0, 0};
+    if (game.result == PGN_UNFINISHED)
+        return 0;
+    counted.whiteWins = game.result == PGN_WHITE_WINS;
+    counted.draws = game.result == PGN_DRAWN;
+    counted.blackWins = game.result == PGN_BLACK_WINS;
+
+    Position p;
+    if (game.fen.empty())
+        p.setStartPosition();
+    else if (!p.setFromFen(std::string(game.fen).c_str()))
+        return -1;
+
+    size_t cursor = 0;
+    std::string_view san;
+    int plies = 0;
+    while (plies < maxPlies && nextSan(game.movetext, cursor, san))
+    {
+        Move m = parseSan(p, san);
+        if (m == NO_MOVE)
+            return -1;
+        counted.key = p.key();
+        counted.move = m;
+        out.push_back(counted);
+        p.makeMove(m);
+        plies++;
+    }
+    return plies;
+}
+
+// Sorted, duplicates merged, in place; returns the new size
+static size_t collapse(std::vector<OpeningIndexEntry> &entries)
+{
+    std::sort(entries.begin(), entries.end(), entryLess);
+    size_t kept = 0;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (kept && sameMove(entries[kept - 1], entries[i]))
+            addCounts(entries[kept - 1], entries[i]);
+        else
+            entries[kept++] = entries[i];
+    }
+    entries.resize(kept);
+    return kept;
+}
+
+// A whole file mapped read-only; nullptr for an empty one
+static const void *mapWhole(const char *path, size_t &size, void *&mapping)
+{
+    mapping = nullptr;
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        perror(path);
+        if (fd >= 0)
+            close(fd);
+        return nullptr;
+    }
+    size = st.st_size;
+    if (size)
+    {
+        mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            perror(path);
+            mapping = nullptr;
+        }
+    }
+    close(fd);
+    return mapping;
+}
+
+OpeningIndexWriter::OpeningIndexWriter(const char *path, int maxPlies)
+    : path(path), maxPlies(maxPlies), runEntries(0), entries(0)
+{
+}
+
+OpeningIndexWriter::~OpeningIndexWriter()
+{
+    for (const std::string &run : runs)
+    {
+        remove(run.c_str());
+    }
+}
+
+bool OpeningIndexWriter::writeRun(std::vector<OpeningIndexEntry> &buffer)
+{
+    size_t count = collapse(buffer);
+    std::string runPath;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        runPath = path + ".run" + std::to_string(runs.size());
+        runs.push_back(runPath);
+    }
+    FILE *out = fopen(runPath.c_str(), "wb");
+    bool ok = out && fwrite(buffer.data(), sizeof(OpeningIndexEntry), count, out) == count;
+    if (out && fclose(out) != 0)
+        ok = false;
+    if (!ok)
+        perror(runPath.c_str());
+    runEntries += count;
+    buffer.clear();
+    return ok;
+}
+
+bool OpeningIndexWriter::finish()
+{
+    FILE *out = fopen(path.c_str(), "wb");
+    if (!out)
+    {
+        perror(path.c_str());
+        return false;
+    }
+    OpeningIndexHeader header;
+    memset(&header, 0, sizeof(header));
+    fwrite(&header, sizeof(header), 1, out); // rewritten once the count is known
+
+    // k-way merge: the smallest head of any run next, equal moves added up
+    struct Run
+    {
+        const OpeningIndexEntry *next, *end;
+        void *mapping;
+        size_t bytes;
+    };
+    std::vector<Run> sources(runs.size());
+    auto later = [&sources](int a, int b)
+    { return entryLess(*sources[b].next, *sources[a].next); };
+    std::priority_queue<int, std::vector<int>, decltype(later)> heads(later);
+    bool ok = true;
+    for (size_t r = 0; r < runs.size(); r++)
+    {
+        size_t bytes = 0;
+        const OpeningIndexEntry *first = (const OpeningIndexEntry *)mapWhole(runs[r].c_str(), bytes, sources[r].mapping);
+        sources[r].next = first;
+        sources[r].end = first + bytes / sizeof(OpeningIndexEntry);
+        sources[r].bytes = bytes;
+        if (bytes && !first)
+            ok = false;
+        else if (first)
+        {
+            madvise(sources[r].mapping, bytes, MADV_SEQUENTIAL);
+            heads.push((int)r);
+        }
+    }
+
+    std::vector<OpeningIndexEntry> pending;
+    pending.reserve(1 << 16);
+    entries = 0;
+    while (ok && !heads.empty())
+    {
+        int r = heads.top();
+        heads.pop();
+        const OpeningIndexEntry &e = *sources[r].next++;
+        if (!pending.empty() && sameMove(pending.back(), e))
+            addCounts(pending.back(), e);
+        else
+        {
+            if (pending.size() == pending.capacity())
+            {
+                // Keep the last one: the next run's head may add to it
+                ok = fwrite(pending.data(), sizeof(OpeningIndexEntry), pending.size() - 1, out) == pending.size() - 1;
+                entries += pending.size() - 1;
+                pending.erase(pending.begin(), pending.end() - 1);
+            }
+            pending.push_back(e);
+        }
+        if (sources[r].next != sources[r].end)
+            heads.push(r);
+    }
+    if (ok)
+        ok = fwrite(pending.data(), sizeof(OpeningIndexEntry), pending.size(), out) == pending.size();
+    entries += pending.size();
+
+    for (Run &run : sources)
+    {
+        if (run.mapping)
+            munmap(run.mapping, run.bytes);
+    }
+
+    memcpy(header.magic, OPENING_INDEX_MAGIC, sizeof(header.magic));
+    header.entries = entries;
+    header.entrySize = sizeof(OpeningIndexEntry);
+    header.maxPlies = maxPlies;
+    if (ok)
+        ok = fseek(out, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, out) == 1;
+    if (fclose(out) != 0)
+        ok = false;
+    if (!ok)
+        perror(path.c_str());
+    return ok;
+}
+
+OpeningIndex::OpeningIndex() : mapping(nullptr), mappedBytes(0), first(nullptr), count(0), maxPlies(0)
+{
+}
+
+OpeningIndex::~OpeningIndex()
+{
+    if (mapping)
+        munmap(mapping, mappedBytes);
+}
+
+bool OpeningIndex::open(const char *path)
+{
+    const OpeningIndexHeader *header = (const OpeningIndexHeader *)mapWhole(path, mappedBytes, mapping);
+    if (!header)
+        return false;
+    if (mappedBytes < sizeof(OpeningIndexHeader) || memcmp(header->magic, OPENING_INDEX_MAGIC, 8) != 0 ||
+        header->entrySize != sizeof(OpeningIndexEntry) ||
+        header->entries > (mappedBytes - sizeof(OpeningIndexHeader)) / sizeof(OpeningIndexEntry))
+    {
+        fprintf(stderr, "%s: not an opening index\n", path);
+        return false;
+    }
+    first = (const OpeningIndexEntry *)(header + 1);
+    count = header->entries;
+    maxPlies = header->maxPlies;
+    return true;
+}
+
+const OpeningIndexEntry *OpeningIndex::find(HashKey key, size_t &moves) const
+{
+    const OpeningIndexEntry *end = first + count;
+    const OpeningIndexEntry *at = std::lower_bound(first, end, key, [](const OpeningIndexEntry &e, HashKey k)
+                                                   { return e.key < k; });
+    const OpeningIndexEntry *last = at;
+    while (last != end && last->key == key)
+    {
+        last++;
+    }
+    moves = last - at;
+    return at;
+}
@@ -0,0 +1,99 @@
+#ifndef OPENINGINDEX_H
+#define OPENINGINDEX_H
+
+// Opening explorer index: for each position reached in the first plies of
+// an archive's games, every move played from it with how those games
+// ended. The file is one array of fixed-size entries sorted by position key
+// then move, behind a small header. A query maps the file and binary
+// searches for the key; the position's moves are the entries that follow.
+//
+// Building streams the games. Workers fill buffers of entries, and each
+// full buffer is sorted, its duplicates merged, and written out as a run
+// file. finish() then merges the runs into the index, so memory use does
+// not depend on the archive size.
+//
+// Keys are the host's 64-bit Position::key(). Two positions sharing a key
+// would share their entries; at 64 bits that doesn't happen in practice.
+
+#include <Arduino.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Pgn.h"
+
+struct OpeningIndexEntry
+{
+  HashKey key;
+  Move move;
+  uint16_t reserved;
+  uint32_t whiteWins, draws, blackWins; // unfinished games aren't counted
+};
+
+static_assert(sizeof(OpeningIndexEntry) == 24, "index entries are written as they are");
+
+struct OpeningIndexHeader
+{
+  char magic[8]; // OPENING_INDEX_MAGIC
+  uint64_t entries;
+  uint32_t entrySize;
+  uint32_t maxPlies; // positions after this many plies aren't indexed
+};
+
+#define OPENING_INDEX_MAGIC "SCXPLR01"
+
+// Entries for the first maxPlies moves of game, appended to out. Returns
+// the number added; -1 if a move can't be read (the moves before it are
+// kept).
+int indexGame(const PgnGame &game, int maxPlies, std::vector<OpeningIndexEntry> &out);
+
+class OpeningIndexWriter
+{
+public:
+  OpeningIndexWriter(const char *path, int maxPlies);
+  ~OpeningIndexWriter(); // removes runs left behind
+
+  // Sorts entries, merges duplicates and writes them as a run; empties
+  // entries. Safe to call from several threads at once.
+  bool writeRun(std::vector<OpeningIndexEntry> &entries);
+  // Merges the runs into the index file
+  bool finish();
+
+  uint64_t getRunEntries() const { return runEntries; } // after merging within runs
+  uint64_t getEntries() const { return entries; }       // in the index
+  int getRuns() const { return (int)runs.size(); }
+
+private:
+  std::string path;
+  int maxPlies;
+  std::mutex lock;
+  std::vector<std::string> runs;
+  std::atomic<uint64_t> runEntries;
+  uint64_t entries;
+};
+
+class OpeningIndex
+{
+public:
+  OpeningIndex();
+  ~OpeningIndex();
+
+  bool open(const char *path); // false (after printing why) if missing or not an index
+
+  // The moves played from the position with this key, count of them (0 if
+  // the position isn't in the index)
+  const OpeningIndexEntry *find(HashKey key, size_t &count) const;
+
+  uint64_t size() const { return count; }
+  int getMaxPlies() const { return maxPlies; }
+  const OpeningIndexEntry *entries() const { return first; }
+
+private:
+  void *mapping;
+  size_t mappedBytes;
+  const OpeningIndexEntry *first;
+  uint64_t count;
+  int maxPlies;
+};
+
+#endif
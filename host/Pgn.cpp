@@ -0,0 +1,471 @@
+#include "Pgn.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char PIECE_LETTERS[] = "PRNBQK"; // by PieceType
+
+static bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool isTokenEnd(const char *data, size_t size, size_t i)
+{
+    return i >= size || isSpace(data[i]) || strchr("{}();", data[i]);
+}
+
+// Length of the termination marker at i, 0 if there is none
+static size_t resultLength(const char *data, size_t size, size_t i)
+{
+    static const char *const markers[] = {"1-0", "0-1", "1/2-1/2", "*"};
+    for (const char *marker : markers)
+    {
+        size_t n = strlen(marker);
+        if (i + n <= size && memcmp(data + i, marker, n) == 0 && isTokenEnd(data, size, i + n))
+            return n;
+    }
+    return 0;
+}
+
+PgnResult parsePgnResult(std::string_view token)
+{
+    if (token == "1-0")
+        return PGN_WHITE_WINS;
+    if (token == "0-1")
+        return PGN_BLACK_WINS;
+    if (token == "1/2-1/2")
+        return PGN_DRAWN;
+    return PGN_UNFINISHED;
+}
+
+const char *pgnResultText(PgnResult result)
+{
+    switch (result)
+    {
+    case PGN_WHITE_WINS:
+        return "1-0";
+    case PGN_BLACK_WINS:
+        return "0-1";
+    case PGN_DRAWN:
+        return "1/2-1/2";
+    default:
+        return "*";
+    }
+}
+
+PgnReader::PgnReader(const char *data, size_t size) : data(data), size(size), pos(0)
+{
+}
+
+// Value of the tag starting at line (`[Name "value"]`), empty if malformed
+static std::string_view tagValue(const char *line, const char *end)
+{
+    const char *open = (const char *)memchr(line, '"', end - line);
+    if (!open)
+        return std::string_view();
+    const char *close = (const char *)memchr(open + 1, '"', end - open - 1);
+    return close ? std::string_view(open + 1, close - open - 1) : std::string_view();
+}
+
+bool PgnReader::next(PgnGame &game)
+{
+    while (pos < size && isSpace(data[pos]))
+    {
+        pos++;
+    }
+    if (pos >= size)
+        return false;
+
+    game.offset = pos;
+    game.fen = std::string_view();
+    PgnResult tagResult = PGN_UNFINISHED;
+
+    // Tag section: one tag pair per line
+    size_t tagsStart = pos;
+    while (pos < size && data[pos] == '[')
+    {
+        const char *line = data + pos;
+        const char *eol = (const char *)memchr(line, '\n', size - pos);
+        if (!eol)
+            eol = data + size;
+        if (size - pos > 5 && memcmp(line, "[FEN ", 5) == 0)
+            game.fen = tagValue(line, eol);
+        else if (size - pos > 8 && memcmp(line, "[Result ", 8) == 0)
+            tagResult = parsePgnResult(tagValue(line, eol));
+        pos = eol - data;
+        while (pos < size && isSpace(data[pos]))
+        {
+            pos++;
+        }
+    }
+    game.tags = std::string_view(data + tagsStart, pos - tagsStart);
+
+    // Movetext: up to the termination marker, or the next tag section
+    size_t movesStart = pos;
+    game.result = tagResult;
+    while (pos < size)
+    {
+        char c = data[pos];
+        if (c == '{')
+        {
+            const char *close = (const char *)memchr(data + pos, '}', size - pos);
+            pos = close ? close - data + 1 : size;
+        }
+        else if (c == ';')
+        {
+            const char *eol = (const char *)memchr(data + pos, '\n', size - pos);
+            pos = eol ? eol - data : size;
+        }
+        else if (c == '[' && pos > movesStart && data[pos - 1] == '\n')
+        {
+            break;
+        }
+        else if ((pos == movesStart || isSpace(data[pos - 1])) && resultLength(data, size, pos))
+        {
+            size_t n = resultLength(data, size, pos);
+            game.result = parsePgnResult(std::string_view(data + pos, n));
+            pos += n;
+            break;
+        }
+        else
+        {
+            pos++;
+        }
+    }
+    game.movetext = std::string_view(data + movesStart, pos - movesStart);
+    return true;
+}
+
+size_t pgnGameStart(const char *data, size_t size, size_t from)
+{
+    // Back to the start of the line (a tag line cut in half is seen whole),
+    // and whether the line before it is a tag line
+    while (from > 0 && data[from - 1] != '\n')
+    {
+        from--;
+    }
+    size_t previous = from > 0 ? from - 1 : 0;
+    while (previous > 0 && data[previous - 1] != '\n')
+    {
+        previous--;
+    }
+    bool previousWasTag = from > 0 && data[previous] == '[';
+
+    size_t line = from;
+    while (line < size)
+    {
+        bool tag = data[line] == '[';
+        if (tag && !previousWasTag)
+            return line;
+        previousWasTag = tag;
+        const char *eol = (const char *)memchr(data + line, '\n', size - line);
+        if (!eol)
+            break;
+        line = eol - data + 1;
+    }
+    return size;
+}
+
+bool mapPgnFile(const char *path, PgnFile &file)
+{
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        perror(path);
+        return false;
+    }
+    file.size = st.st_size;
+    file.data = "";
+    if (file.size)
+    {
+        void *p = mmap(nullptr, file.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            perror(path);
+            close(fd);
+            return false;
+        }
+        madvise(p, file.size, MADV_SEQUENTIAL);
+        file.data = (const char *)p;
+    }
+    close(fd);
+    return true;
+}
+
+std::vector<PgnChunk> pgnChunks(const std::vector<PgnFile> &files)
+{
+    std::vector<PgnChunk> chunks;
+    for (int f = 0; f < (int)files.size(); f++)
+    {
+        size_t begin = 0;
+        while (begin < files[f].size)
+        {
+            size_t end = files[f].size;
+            if (begin + PGN_CHUNK_BYTES < end)
+                end = pgnGameStart(files[f].data, files[f].size, begin + PGN_CHUNK_BYTES);
+            chunks.push_back({f, begin, end});
+            begin = end;
+        }
+    }
+    return chunks;
+}
+
+bool nextSan(std::string_view movetext, size_t &cursor, std::string_view &san)
+{
+    const char *data = movetext.data();
+    size_t size = movetext.size();
+    while (cursor < size)
+    {
+        char c = data[cursor];
+        if (isSpace(c) || c == '.')
+        {
+            cursor++;
+        }
+        else if (c == '{')
+        {
+            const char *close = (const char *)memchr(data + cursor, '}', size - cursor);
+            cursor = close ? close - data + 1 : size;
+        }
+        else if (c == ';')
+        {
+            const char *eol = (const char *)memchr(data + cursor, '\n', size - cursor);
+            cursor = eol ? eol - data : size;
+        }
+        else if (c == '(')
+        {
+            // Variations nest; comments inside them may hold parentheses
+            int depth = 0;
+            do
+            {
+                if (data[cursor] == '(')
+                    depth++;
+                else if (data[cursor] == ')')
+                    depth--;
+                else if (data[cursor] == '{')
+                {
+                    const char *close = (const char *)memchr(data + cursor, '}', size - cursor);
+                    cursor = close ? close - data : size - 1;
+                }
+                cursor++;
+            } while (depth > 0 && cursor < size);
+        }
+        else if (c == '$' || (c >= '0' && c <= '9' && !(cursor + 2 < size && memcmp(data + cursor, "0-0", 3) == 0)))
+        {
+            // NAG or move number; a result ends the moves
+            if (resultLength(data, size, cursor))
+            {
+                cursor = size;
+                return false;
+            }
+            cursor++;
+            while (cursor < size && data[cursor] >= '0' && data[cursor] <= '9')
+            {
+                cursor++;
+            }
+        }
+        else if (c == '*')
+        {
+            cursor = size;
+            return false;
+        }
+        else
+        {
+            size_t start = cursor;
+            while (!isTokenEnd(data, size, cursor))
+            {
+                cursor++;
+            }
+            san = std::string_view(data + start, cursor - start);
+            if (san == "e.p.")
+                continue; // en passant remark after the move
+            return true;
+        }
+    }
+    return false;
+}
+
+char sanCheckMark(std::string_view san)
+{
+    for (size_t i = san.size(); i > 0; i--)
+    {
+        char c = san[i - 1];
+        if (c == '+' || c == '#')
+            return c;
+        if (c != '!' && c != '?')
+            break;
+    }
+    return 0;
+}
+
+Move parseSan(const Position &p, std::string_view san)
+{
+    while (!san.empty() && strchr("+#!?", san.back()))
+    {
+        san.remove_suffix(1);
+    }
+    if (san.size() < 2)
+        return NO_MOVE;
+
+    Move found = NO_MOVE;
+    int matches = 0;
+    const BoardBackend &board = p.board;
+    PieceColor side = p.sideToMove;
+
+    if (san == "O-O" || san == "O-O-O" || san == "0-0" || san == "0-0-0")
+    {
+        Square home = side == WHITE ? 4 : 60;
+        Move m = makeMove(home, san.size() == 3 ? home + 2 : home - 2, MOVE_CASTLING);
+        return p.isLegal(m) ? m : NO_MOVE;
+    }
+
+    PieceType type = PAWN;
+    size_t i = 0;
+    const char *letter = strchr(PIECE_LETTERS + 1, san[0]);
+    if (san[0] && letter)
+    {
+        type = (PieceType)(letter - PIECE_LETTERS);
+        i = 1;
+    }
+
+    // Promotion: "e8=Q" (or "e8Q")
+    bool promotes = false;
+    PromotionType promotion = PROMOTE_QUEEN;
+    char last = san.back();
+    if (type == PAWN && strchr("QRBNqrbn", last) && san.size() >= 3)
+    {
+        switch (last | 0x20)
+        {
+        case 'r':
+            promotion = PROMOTE_ROOK;
+            break;
+        case 'b':
+            promotion = PROMOTE_BISHOP;
+            break;
+        case 'n':
+            promotion = PROMOTE_KNIGHT;
+            break;
+        }
+        promotes = true;
+        san.remove_suffix(1);
+        if (san.back() == '=')
+            san.remove_suffix(1);
+    }
+
+    if (san.size() < i + 2)
+        return NO_MOVE;
+    char toFile = san[san.size() - 2], toRank = san[san.size() - 1];
+    if (toFile < 'a' || toFile > 'h' || toRank < '1' || toRank > '8')
+        return NO_MOVE;
+    Square to = (toRank - '1') * 8 + (toFile - 'a');
+
+    // Disambiguation (or a long-algebraic from square) and capture marks
+    int fromFile = -1, fromRank = -1;
+    for (; i < san.size() - 2; i++)
+    {
+        char c = san[i];
+        if (c >= 'a' && c <= 'h')
+            fromFile = c - 'a';
+        else if (c >= '1' && c <= '8')
+            fromRank = c - '1';
+        else if (c != 'x' && c != '-' && c != ':')
+            return NO_MOVE;
+    }
+
+    // Each piece of the kind named that fits the disambiguation: the move
+    // it would make, checked on its own (no list of all moves)
+    PieceCode wanted = makePiece(type, side);
+#if defined(SMARTCHESS_MAILBOX_BACKEND)
+    BoardBackend::PieceIterator it = board.pieces(side);
+#else
+    BoardBackend::PieceIterator it(board.colorSet(side) & board.typeSet(type));
+#endif
+    Square from;
+    while (it.next(from))
+    {
+        if (board.pieceAt(from) != wanted)
+            continue;
+        if ((fromFile >= 0 && (from & 7) != fromFile) || (fromRank >= 0 && (from >> 3) != fromRank))
+            continue;
+        MoveFlag flag = MOVE_NORMAL;
+        if (promotes)
+            flag = MOVE_PROMOTION;
+        else if (type == PAWN && to == p.epSquare && (from & 7) != (to & 7))
+            flag = MOVE_EN_PASSANT;
+        Move m = makeMove(from, to, flag, promotes ? promotion : PROMOTE_QUEEN);
+        if (p.isLegal(m))
+        {
+            found = m;
+            matches++;
+        }
+    }
+    return matches == 1 ? found : NO_MOVE;
+}
+
+int formatSan(const Position &p, Move m, char *out)
+{
+    const BoardBackend &board = p.board;
+    Square from = moveFrom(m), to = moveTo(m);
+    PieceType type = pieceType(board.pieceAt(from));
+    int n = 0;
+
+    if (moveFlag(m) == MOVE_CASTLING)
+    {
+        memcpy(out, to > from ? "O-O" : "O-O-O", to > from ? 3 : 5);
+        n = to > from ? 3 : 5;
+    }
+    else
+    {
+        bool capture = board.pieceAt(to) != NO_PIECE || moveFlag(m) == MOVE_EN_PASSANT;
+        if (type == PAWN)
+        {
+            if (capture)
+                out[n++] = 'a' + (from & 7);
+        }
+        else
+        {
+            out[n++] = PIECE_LETTERS[type];
+            // Other pieces of the same kind that can go there too
+            bool others = false, sameFile = false, sameRank = false;
+            auto rival = [&](Move other)
+            {
+                Square f = moveFrom(other);
+                if (moveTo(other) == to && f != from && board.pieceAt(f) == board.pieceAt(from) &&
+                    !leavesKingInCheck(board, other, p.sideToMove))
+                {
+                    others = true;
+                    sameFile |= (f & 7) == (from & 7);
+                    sameRank |= (f >> 3) == (from >> 3);
+                }
+                return false;
+            };
+            generateMoves(board, p.sideToMove, p.castlingRights, p.epSquare, rival);
+            if (others && (!sameFile || sameRank))
+                out[n++] = 'a' + (from & 7);
+            if (others && sameFile)
+                out[n++] = '1' + (from >> 3);
+        }
+        if (capture)
+            out[n++] = 'x';
+        out[n++] = 'a' + (to & 7);
+        out[n++] = '1' + (to >> 3);
+        if (moveFlag(m) == MOVE_PROMOTION)
+        {
+            out[n++] = '=';
+            out[n++] = PIECE_LETTERS[promotionPieceType(movePromotion(m))];
+        }
+    }
+
+    Position after = p;
+    after.makeMove(m);
+    if (after.inCheck())
+        out[n++] = after.hasLegalMove() ? '+' : '#';
+    out[n] = 0;
+    return n;
+}
@@ -0,0 +1,87 @@
+#ifndef PGN_H
+#define PGN_H
+
+// PGN reading and writing for host tools. Reading is zero-copy: PgnReader
+// walks a buffer (typically a whole mmapped file) and hands out games as
+// views into it; nothing is copied or allocated per game or per move. SAN
+// moves are resolved against a Position by trying the pieces that could
+// have made them.
+
+#include <Arduino.h>
+#include <string_view>
+#include <vector>
+#include "Position.h"
+
+enum PgnResult
+{
+  PGN_WHITE_WINS,
+  PGN_BLACK_WINS,
+  PGN_DRAWN,
+  PGN_UNFINISHED // "*", or no termination marker
+};
+
+struct PgnGame
+{
+  size_t offset;              // of the game's first byte in the buffer
+  std::string_view tags;      // the tag pairs, as written
+  std::string_view movetext;  // from the first move to the end of the game
+  std::string_view fen;       // the FEN tag's value, empty if there is none
+  PgnResult result;           // the termination marker (the Result tag if it is missing)
+};
+
+class PgnReader
+{
+public:
+  PgnReader(const char *data, size_t size);
+
+  bool next(PgnGame &game); // false at the end of the buffer
+  size_t getOffset() const { return pos; }
+
+private:
+  const char *data;
+  size_t size;
+  size_t pos;
+};
+
+// A file mapped read-only, for PgnReader. False (after printing why) if it
+// can't be opened.
+struct PgnFile
+{
+  const char *data;
+  size_t size;
+};
+bool mapPgnFile(const char *path, PgnFile &file);
+
+// Pieces of files holding whole games, about PGN_CHUNK_BYTES each, for
+// worker threads to take one at a time
+#define PGN_CHUNK_BYTES (4 << 20)
+
+struct PgnChunk
+{
+  int file; // index into the files given
+  size_t begin, end;
+};
+std::vector<PgnChunk> pgnChunks(const std::vector<PgnFile> &files);
+
+// Where the next game starts at or after from (the first tag line of a tag
+// section), size if none: splits a buffer into pieces that hold whole games
+size_t pgnGameStart(const char *data, size_t size, size_t from);
+
+// Next move of movetext from cursor, skipping move numbers, comments,
+// variations, NAGs and the termination marker. False at the end.
+bool nextSan(std::string_view movetext, size_t &cursor, std::string_view &san);
+
+// The legal move san denotes in p; NO_MOVE if it is malformed, illegal or
+// ambiguous. Check marks and annotations ("+", "#", "!?") are allowed and
+// not checked here: sanCheckMark() reads them.
+Move parseSan(const Position &p, std::string_view san);
+char sanCheckMark(std::string_view san); // '+', '#' or 0
+
+// SAN of a legal move in p, with its check mark; returns the length written
+// (at most 8 characters plus the terminator)
+int formatSan(const Position &p, Move m, char *out);
+
+PgnResult parsePgnResult(std::string_view token); // PGN_UNFINISHED if not a result
+const char *pgnResultText(PgnResult result);
+
+#endif
@@ -0,0 +1,156 @@
+#include "ProtocolDecoder.h"
+
+static uint16_t read16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+ProtocolDecoder::ProtocolDecoder()
+    : start(0), synced(false), expected(0), frames(0), badFrames(0), skippedBytes(0), missedFrames(0)
+{
+    // Byte-at-a-time table for the device's bitwise crc16Update()
+    for (int i = 0; i < 256; i++)
+    {
+        crcTable[i] = crc16Update(0, (uint8_t)i);
+    }
+}
+
+void ProtocolDecoder::feed(const uint8_t *data, size_t size)
+{
+    buffer.erase(buffer.begin(), buffer.begin() + start);
+    start = 0;
+    buffer.insert(buffer.end(), data, data + size);
+}
+
+bool ProtocolDecoder::next(ProtocolFrame &frame)
+{
+    for (;;)
+    {
+        while (start < buffer.size() && buffer[start] != PROTOCOL_SYNC)
+        {
+            start++;
+            skippedBytes++;
+        }
+        if (buffer.size() - start < PROTOCOL_HEADER_BYTES)
+            return false;
+
+        const uint8_t *header = buffer.data() + start;
+        uint8_t length = header[3];
+        if (length > PROTOCOL_MAX_PAYLOAD)
+        {
+            // Not a frame: look for the next sync byte
+            badFrames++;
+            start++;
+            skippedBytes++;
+            continue;
+        }
+        size_t total = PROTOCOL_HEADER_BYTES + length + 2;
+        if (buffer.size() - start < total)
+            return false;
+
+        uint16_t crc = 0xFFFF;
+        for (size_t i = 1; i < (size_t)PROTOCOL_HEADER_BYTES + length; i++)
+        {
+            crc = (crc << 8) ^ crcTable[(crc >> 8) ^ header[i]];
+        }
+        if (crc != read16(header + PROTOCOL_HEADER_BYTES + length))
+        {
+            badFrames++;
+            start++;
+            skippedBytes++;
+            continue;
+        }
+
+        frame.type = (MessageType)header[1];
+        frame.sequence = header[2];
+        frame.missed = synced ? (uint8_t)(frame.sequence - expected) : 0;
+        frame.length = length;
+        frame.payload = header + PROTOCOL_HEADER_BYTES;
+        missedFrames += frame.missed;
+        synced = true;
+        expected = frame.sequence + 1;
+        frames++;
+        start += total;
+        return true;
+    }
+}
+
+GameMirror::GameMirror() : synced(false), gameState(GAME_ACTIVE), inCheck(false), mismatches(0), skippedMoves(0)
+{
+    position.clear();
+    memset(targets, 0, sizeof(targets));
+}
+
+bool GameMirror::apply(const ProtocolFrame &frame)
+{
+    if (frame.missed)
+        synced = false;
+
+    switch (frame.type)
+    {
+    case MSG_POSITION:
+    {
+        if (frame.length != 38)
+            return false;
+        PackedPosition packed;
+        memcpy(packed.squares, frame.payload, sizeof(packed.squares));
+        packed.sideAndRights = frame.payload[32];
+        packed.epSquare = frame.payload[33];
+        packed.halfMoveClock = read16(frame.payload + 34);
+        packed.fullMoveNumber = read16(frame.payload + 36);
+        unpackPosition(packed, position);
+        synced = true;
+        return true;
+    }
+    case MSG_MOVE:
+    {
+        if (frame.length != 4)
+            return false;
+        if (!synced)
+        {
+            skippedMoves++;
+            return false;
+        }
+        Move m = read16(frame.payload);
+        if (!position.isLegal(m))
+        {
+            mismatches++;
+            synced = false;
+            return false;
+        }
+        position.makeMove(m);
+        if (positionCheck(position) != read16(frame.payload + 2))
+        {
+            mismatches++;
+            synced = false;
+            return false;
+        }
+        return true;
+    }
+    case MSG_STATE:
+        if (frame.length != 3)
+            return false;
+        gameState = (GameState)frame.payload[0];
+        inCheck = frame.payload[2] != 0;
+        return true;
+    case MSG_LEGAL_MOVES:
+    {
+        if (frame.length % 9)
+            return false;
+        memset(targets, 0, sizeof(targets));
+        for (const uint8_t *entry = frame.payload; entry < frame.payload + frame.length; entry += 9)
+        {
+            if (entry[0] >= 64)
+                return false;
+            uint64_t bits = 0;
+            for (int i = 7; i >= 0; i--)
+            {
+                bits = (bits << 8) | entry[1 + i];
+            }
+            targets[entry[0]] = bits;
+        }
+        return true;
+    }
+    }
+    return false;
+}
@@ -0,0 +1,72 @@
+#ifndef PROTOCOLDECODER_H
+#define PROTOCOLDECODER_H
+
+// Host side of the binary protocol (Protocol.h), for the companion app and
+// tools: ProtocolDecoder picks frames out of received bytes, however they
+// are split up, and GameMirror keeps a copy of the game from them.
+
+#include <Arduino.h>
+#include <vector>
+#include "Protocol.h"
+
+struct ProtocolFrame
+{
+  MessageType type;
+  uint8_t sequence;
+  uint8_t missed; // frames lost just before this one, from the sequence numbers
+  uint8_t length;
+  const uint8_t *payload; // valid until the next feed()
+};
+
+class ProtocolDecoder
+{
+public:
+  ProtocolDecoder();
+
+  void feed(const uint8_t *data, size_t size);
+  bool next(ProtocolFrame &frame); // false: no complete frame buffered
+
+  uint64_t getFrames() const { return frames; }
+  uint64_t getBadFrames() const { return badFrames; }       // CRC or length wrong
+  uint64_t getSkippedBytes() const { return skippedBytes; } // outside any good frame
+  uint64_t getMissedFrames() const { return missedFrames; }
+
+private:
+  std::vector<uint8_t> buffer;
+  size_t start; // first byte not yet looked at
+  uint16_t crcTable[256];
+  bool synced; // a frame has been seen: its sequence number tells what comes next
+  uint8_t expected;
+  uint64_t frames, badFrames, skippedBytes, missedFrames;
+};
+
+// The receiver's copy of the game. After a lost or mismatching frame it
+// ignores moves until the next MSG_POSITION.
+class GameMirror
+{
+public:
+  GameMirror();
+
+  // False if the frame couldn't be applied: malformed, a move while out of
+  // step, or a move that doesn't fit the copy (which puts it out of step)
+  bool apply(const ProtocolFrame &frame);
+
+  bool isSynced() const { return synced; }
+  const Position &getPosition() const { return position; }
+  GameState getGameState() const { return gameState; }
+  bool isInCheck() const { return inCheck; }
+  uint64_t legalTargets(Square from) const { return targets[from]; } // from the last MSG_LEGAL_MOVES
+
+  uint64_t getMismatches() const { return mismatches; } // moves not fitting or failing the check
+  uint64_t getSkippedMoves() const { return skippedMoves; }
+
+private:
+  Position position;
+  bool synced;
+  GameState gameState;
+  bool inCheck;
+  uint64_t targets[64];
+  uint64_t mismatches, skippedMoves;
+};
+
+#endif
@@ -0,0 +1,133 @@
+// Batched move validation benchmark: the same (position, move) requests
+// checked by validateMoves() on each instruction set, by Position::isLegal()
+// one at a time, and by ChessBoard::movePiece() one at a time.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++17 -Ihost -I. host/batch_validate_bench.cpp host/BatchValidate.cpp *.cpp -o batch_validate_bench
+// Usage:
+//   ./batch_validate_bench [requests=1000000]
+//
+// movePiece needs the position loaded into a ChessBoard first; the time
+// setPosition() alone takes is measured separately and subtracted.
+
+#include "BatchValidate.h"
+#include "ChessBoard.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static uint32_t rngState = 0x2545F491;
+static uint32_t nextRandom()
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Requests taken from random games: mostly generated moves (some of which
+// leave the king in check), one in eight random squares like a misread
+// sensor would produce
+static void makeRequests(size_t count, std::vector<Position> &positions, std::vector<Move> &moves)
+{
+    Position game;
+    game.setStartPosition();
+    while (positions.size() < count)
+    {
+        Move pseudo[256], legal[256];
+        int pseudoCount = 0, legalCount = 0;
+        auto collect = [&](Move m)
+        {
+            pseudo[pseudoCount++] = m;
+            if (!leavesKingInCheck(game.board, m, game.sideToMove))
+                legal[legalCount++] = m;
+            return false;
+        };
+        generateMoves(game.board, game.sideToMove, game.castlingRights, game.epSquare, collect);
+        if (legalCount == 0 || game.halfMoveClock >= 100 || game.fullMoveNumber > 150)
+        {
+            game.setStartPosition();
+            continue;
+        }
+
+        positions.push_back(game);
+        if ((nextRandom() & 7) == 0)
+            moves.push_back(makeMove(nextRandom() & 63, nextRandom() & 63));
+        else
+            moves.push_back(pseudo[nextRandom() % pseudoCount]);
+        game.makeMove(legal[nextRandom() % legalCount]);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t count = argc > 1 ? (size_t)atol(argv[1]) : 1000000;
+    arduinoSerialMuted() = true;
+
+    std::vector<Position> positions;
+    std::vector<Move> moves;
+    positions.reserve(count);
+    moves.reserve(count);
+    makeRequests(count, positions, moves);
+
+    std::vector<char> expected(count);
+    auto start = std::chrono::steady_clock::now();
+    size_t legalCount = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        expected[i] = positions[i].isLegal(moves[i]);
+        legalCount += expected[i];
+    }
+    double isLegalSeconds = secondsSince(start);
+
+    printf("requests:           %zu (%zu legal)\n", count, legalCount);
+    printf("best instruction set: %s\n", batchIsaName(batchValidationIsa()));
+    printf("Position::isLegal:  %.1f M moves/s\n", count / isLegalSeconds / 1e6);
+
+    bool *results = new bool[count];
+    static const BatchIsa isas[] = {BATCH_SCALAR, BATCH_SSE2, BATCH_AVX2};
+    for (BatchIsa isa : isas)
+    {
+        if (isa > batchValidationIsa())
+            continue;
+        start = std::chrono::steady_clock::now();
+        validateMoves(positions.data(), moves.data(), results, count, isa);
+        double seconds = secondsSince(start);
+
+        size_t mismatches = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            mismatches += results[i] != (bool)expected[i];
+        }
+        printf("validateMoves %-6s %.1f M moves/s, %zu mismatches\n", batchIsaName(isa), count / seconds / 1e6, mismatches);
+    }
+    delete[] results;
+
+    // movePiece works on a live game, so each request loads its position first
+    size_t boardCount = count < 200000 ? count : 200000;
+    ChessBoard board;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < boardCount; i++)
+    {
+        board.setPosition(positions[i]);
+    }
+    double loadSeconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < boardCount; i++)
+    {
+        board.setPosition(positions[i]);
+        board.movePiece(moves[i]);
+    }
+    double moveSeconds = secondsSince(start) - loadSeconds;
+    printf("ChessBoard::movePiece: %.1f M moves/s (first %zu requests, setPosition excluded)\n",
+           boardCount / moveSeconds / 1e6, boardCount);
+    return 0;
+}
@@ -0,0 +1,295 @@
+// Endgame table check: reads an image written by egtb_gen through
+// EndgameTables, the board's own probe code, and checks
+//   - known KQK, KRK and KPK positions, with their colour-swapped and
+//     mirrored twins (one entry each after canonicalization),
+//   - random KQK, KRK, KPK and KQKR positions against their successors: a
+//     win has a reply that loses one ply sooner, a loss has only replies
+//     that win, a draw has no losing reply,
+//   - the hint search: a covered root is answered from the table, and a
+//     capture into a covered ending is scored as the table's mate.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++17 -Ihost -I. host/egtb_check.cpp *.cpp -o egtb_check
+// Usage:
+//   ./egtb_gen -o egtb.bin KQK KRK KPK
+//   ./egtb_check [egtb.bin] [random positions=100000]
+// Endings the image has no table for are skipped. Exits 1 on any mismatch.
+
+#include "Endgame.h"
+#include "Search.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static std::vector<uint8_t> image;
+
+static bool readImage(uint32_t offset, uint8_t *buf, uint8_t len)
+{
+    if (offset > image.size() || image.size() - offset < len)
+        return false;
+    memcpy(buf, image.data() + offset, len);
+    return true;
+}
+
+static uint32_t rngState = 0x2545F491;
+static uint32_t nextRandom()
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+static EndgameTables tables;
+static TranspositionTable table;
+static int failures = 0;
+static int skipped = 0;
+
+static const char *wdlName(EgtbWdl wdl)
+{
+    static const char *const names[4] = {"draw", "win", "loss", "illegal"};
+    return names[wdl & 3];
+}
+
+static void fail(const Position &p, const char *what)
+{
+    char board[65];
+    for (Square sq = 0; sq < 64; sq++)
+    {
+        PieceCode piece = p.board.pieceAt(sq);
+        board[sq] = piece == NO_PIECE ? '.' : "prnbqk"[pieceType(piece)] - (pieceColor(piece) == WHITE ? 32 : 0);
+    }
+    board[64] = 0;
+    printf("FAIL %s: %s to move, a1..h8 %s\n", what, p.sideToMove == WHITE ? "white" : "black", board);
+    failures++;
+}
+
+// p with the colours swapped (ranks flipped) and/or the files mirrored
+static Position twin(const Position &p, bool swapColours, bool mirror)
+{
+    Position out;
+    out.clear();
+    for (Square sq = 0; sq < 64; sq++)
+    {
+        PieceCode piece = p.board.pieceAt(sq);
+        if (piece == NO_PIECE)
+            continue;
+        Square to = sq ^ (swapColours ? 56 : 0) ^ (mirror ? 7 : 0);
+        out.board.put(to, swapColours ? makePiece(pieceType(piece), opponent(pieceColor(piece))) : piece);
+    }
+    out.sideToMove = swapColours ? opponent(p.sideToMove) : p.sideToMove;
+    return out;
+}
+
+struct Known
+{
+    const char *fen;
+    EgtbWdl wdl;
+    int dtm; // -1: any
+};
+
+static const Known known[] = {
+    {"7k/7Q/6K1/8/8/8/8/8 b - - 0 1", EGTB_LOSS, 0},     // mated
+    {"7k/8/6K1/8/8/8/8/5Q2 w - - 0 1", EGTB_WIN, 1},     // Qf8#
+    {"7k/5Q2/6K1/8/8/8/8/8 b - - 0 1", EGTB_DRAW, 0},    // stalemate
+    {"8/8/8/4k3/8/8/8/1Q2K3 w - - 0 1", EGTB_WIN, -1},
+    {"R6k/8/6K1/8/8/8/8/8 b - - 0 1", EGTB_LOSS, 0},     // mated
+    {"k7/1R6/8/8/8/8/8/7K b - - 0 1", EGTB_DRAW, 0},     // Kxb7
+    {"k7/1R6/8/8/8/8/8/7K w - - 0 1", EGTB_WIN, -1},
+    {"4k3/8/4K3/4P3/8/8/8/8 w - - 0 1", EGTB_WIN, -1},   // king on the sixth
+    {"4k3/8/4K3/4P3/8/8/8/8 b - - 0 1", EGTB_LOSS, -1},
+    {"4k3/4P3/4K3/8/8/8/8/8 b - - 0 1", EGTB_DRAW, 0},   // stalemate
+    {"k7/8/K7/P7/8/8/8/8 w - - 0 1", EGTB_DRAW, 0},      // rook pawn
+};
+
+static void checkKnown()
+{
+    for (const Known &k : known)
+    {
+        Position p;
+        p.setFromFen(k.fen);
+        for (int t = 0; t < 4; t++)
+        {
+            Position q = twin(p, t & 1, t & 2);
+            EgtbResult r;
+            if (!tables.probe(q, r))
+            {
+                if (t == 0)
+                {
+                    skipped++;
+                    break;
+                }
+                fail(q, "twin of a covered position not covered");
+            }
+            else if (r.wdl != k.wdl || (k.dtm >= 0 && r.dtm != k.dtm && r.dtm != EGTB_DTM_UNKNOWN))
+            {
+                char what[64];
+                snprintf(what, sizeof(what), "%s dtm %u, expected %s", wdlName(r.wdl), r.dtm, wdlName(k.wdl));
+                fail(q, what);
+            }
+        }
+    }
+}
+
+// A random legal position with the kings and extra, false if the draw
+// didn't give one
+static bool randomPosition(const PieceCode *extra, int count, Position &p)
+{
+    p.clear();
+    p.sideToMove = nextRandom() & 1 ? BLACK : WHITE;
+    p.board.put(nextRandom() % 64, makePiece(KING, WHITE));
+    Square sq = nextRandom() % 64;
+    if (p.board.pieceAt(sq) != NO_PIECE)
+        return false;
+    p.board.put(sq, makePiece(KING, BLACK));
+    for (int i = 0; i < count; i++)
+    {
+        sq = nextRandom() % 64;
+        if (p.board.pieceAt(sq) != NO_PIECE || (pieceType(extra[i]) == PAWN && (sq < 8 || sq >= 56)))
+            return false;
+        p.board.put(sq, extra[i]);
+    }
+    Square kings[2] = {p.board.kingSquare(WHITE), p.board.kingSquare(BLACK)};
+    int fileGap = abs((kings[0] & 7) - (kings[1] & 7)), rankGap = abs((kings[0] >> 3) - (kings[1] >> 3));
+    if (fileGap <= 1 && rankGap <= 1)
+        return false;
+    // The side that just moved can't be in check
+    return !p.board.isAttacked(p.board.kingSquare(opponent(p.sideToMove)), p.sideToMove);
+}
+
+// p's probe against the probes of every position it leads to
+static void checkSuccessors(const Position &p, uint64_t &checked)
+{
+    EgtbResult r;
+    if (!tables.probe(p, r))
+        return; // no table for the ending
+    if (r.wdl == EGTB_ILLEGAL)
+    {
+        fail(p, "legal position stored as illegal");
+        return;
+    }
+    bool anyMove = false, anyLoss = false, allWin = true;
+    uint16_t fastestLoss = 0xFFFF, slowestWin = 0;
+    bool known = true;
+    auto visit = [&](Move m)
+    {
+        if (leavesKingInCheck(p.board, m, p.sideToMove))
+            return false;
+        Position next = p;
+        next.makeMove(m);
+        EgtbResult c;
+        if (!tables.probe(next, c) || c.wdl == EGTB_ILLEGAL)
+        {
+            fail(next, "successor not covered");
+            return true;
+        }
+        anyMove = true;
+        known = known && c.dtm != EGTB_DTM_UNKNOWN;
+        if (c.wdl == EGTB_LOSS)
+        {
+            anyLoss = true;
+            fastestLoss = c.dtm < fastestLoss ? c.dtm : fastestLoss;
+        }
+        allWin = allWin && c.wdl == EGTB_WIN;
+        if (c.wdl == EGTB_WIN && c.dtm > slowestWin)
+            slowestWin = c.dtm;
+        return false;
+    };
+    generateMoves(p.board, p.sideToMove, p.castlingRights, p.epSquare, visit);
+    checked++;
+
+    known = known && r.dtm != EGTB_DTM_UNKNOWN;
+    bool ok;
+    if (!anyMove)
+        ok = p.inCheck() ? r.wdl == EGTB_LOSS && (!known || r.dtm == 0) : r.wdl == EGTB_DRAW;
+    else if (r.wdl == EGTB_WIN)
+        ok = anyLoss && (!known || fastestLoss + 1 == r.dtm);
+    else if (r.wdl == EGTB_LOSS)
+        ok = allWin && (!known || slowestWin + 1 == r.dtm);
+    else
+        ok = !anyLoss && !allWin;
+    if (!ok)
+    {
+        char what[64];
+        snprintf(what, sizeof(what), "%s dtm %u disagrees with its successors", wdlName(r.wdl), r.dtm);
+        fail(p, what);
+    }
+}
+
+static void checkSearch()
+{
+    Search search(table);
+    search.setEndgameTables(&tables);
+    search.setSliceMicros(0);
+    Position p;
+
+    // Root covered: answered without searching, the move keeps the mate
+    p.setFromFen("8/8/8/4k3/8/8/8/1Q2K3 w - - 0 1");
+    EgtbResult root, after;
+    tables.probe(p, root);
+    search.startHint(p, 0xFFFFFFFFUL, 6);
+    Position next = p;
+    next.makeMove(search.bestMove());
+    if (search.pollHint() != HINT_READY || search.getNodes() > 256 || !tables.probe(next, after) ||
+        after.wdl != EGTB_LOSS || (root.dtm != EGTB_DTM_UNKNOWN && after.dtm + 1 != root.dtm))
+        fail(p, "hint at a covered root");
+
+    // Not covered (KQKN), but taking the knight is: a mate score at depth 2
+    p.setFromFen("7k/8/8/8/8/8/3n4/K2Q4 w - - 0 1");
+    search.startHint(p, 0xFFFFFFFFUL, 2);
+    while (search.pollHint() == HINT_THINKING)
+    {
+    }
+    if (moveTo(search.bestMove()) != 11 || search.bestScore() < MATE_BOUND)
+        fail(p, "hint into a covered ending");
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : "egtb.bin";
+    long randomCount = argc > 2 ? atol(argv[2]) : 100000;
+
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        printf("cannot open %s (write it with: egtb_gen -o %s KQK KRK KPK)\n", path, path);
+        return 1;
+    }
+    int c;
+    while ((c = fgetc(f)) != EOF)
+    {
+        image.push_back((uint8_t)c);
+    }
+    fclose(f);
+    if (!tables.begin(readImage))
+    {
+        printf("%s: not an endgame table image\n", path);
+        return 1;
+    }
+
+    checkKnown();
+    printf("known positions:   %d failures, %d not in the image\n", failures, skipped);
+
+    const PieceCode endings[4][2] = {{makePiece(QUEEN, WHITE)},
+                                     {makePiece(ROOK, WHITE)},
+                                     {makePiece(PAWN, WHITE)},
+                                     {makePiece(QUEEN, WHITE), makePiece(ROOK, BLACK)}};
+    static const int extras[4] = {1, 1, 1, 2};
+    uint64_t checked = 0;
+    int before = failures;
+    for (long i = 0; i < randomCount && failures - before < 20; i++)
+    {
+        Position p;
+        if (randomPosition(endings[i % 4], extras[i % 4], p))
+            checkSuccessors(p, checked);
+    }
+    printf("random positions:  %llu checked against their successors, %d failures\n", (unsigned long long)checked,
+           failures - before);
+
+    before = failures;
+    checkSearch();
+    printf("hint search:       %d failures\n", failures - before);
+    return failures != 0;
+}
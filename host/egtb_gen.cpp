@@ -0,0 +1,678 @@
+// Retrograde endgame table generator for 3- and 4-man endings.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++17 -Ihost -I. host/egtb_gen.cpp *.cpp -o egtb_gen
+// Usage:
+//   ./egtb_gen [-o egtb.bin] [--wdl-only] KQK KRK KPK KQKR
+//
+// Pawnless 4-man tables take 1.3 MB of WDL data each, pawn tables 4 MB;
+// DTM adds 6-7 bits per entry. --wdl-only drops DTM from the 4-man tables
+// so a full set fits a 16 MB SPI flash; 3-man tables always keep DTM.
+//
+// Every requested ending is solved by retrograde analysis; endings reached by
+// captures and promotions are solved first and included in the image as
+// well, so the board can keep probing after a conversion. The image format
+// and indexing are shared with the probe code in Endgame.h.
+
+#include "Endgame.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+static const uint8_t UNKNOWN = 4;
+static const uint8_t NO_EXIT = 0xFF;
+static const int MAX_PLIES = 255;
+
+static const int knightSteps[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+static const int kingSteps[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+static const PieceType promotions[4] = {QUEEN, ROOK, BISHOP, KNIGHT};
+
+static int fileOf(int sq) { return sq & 7; }
+static int rankOf(int sq) { return sq >> 3; }
+static bool onBoard(int f, int r) { return f >= 0 && f < 8 && r >= 0 && r < 8; }
+static PieceColor opposite(PieceColor c) { return c == WHITE ? BLACK : WHITE; }
+
+struct GenPos
+{
+    uint8_t count;
+    uint8_t pieces[EGTB_MAX_PIECES];
+    uint8_t squares[EGTB_MAX_PIECES];
+    PieceColor sideToMove;
+    int8_t board[64]; // piece index per square, -1 = empty
+
+    void rebuild()
+    {
+        memset(board, -1, sizeof(board));
+        for (uint8_t i = 0; i < count; i++)
+            board[squares[i]] = i;
+    }
+};
+
+struct GenMove
+{
+    uint8_t piece;
+    uint8_t to;
+    int8_t captured;
+    int8_t promotion; // PieceType or -1
+};
+
+struct Value
+{
+    uint8_t wdl;
+    uint8_t dtm;
+};
+
+struct GenTable
+{
+    std::string name;
+    EgtbPosition shape; // canonical piece list (squares unused)
+    bool pawns;
+    uint32_t entries;
+    std::vector<uint8_t> wdl; // [stm * entries + index]
+    std::vector<uint8_t> dtm;
+};
+
+static std::map<std::string, GenTable *> tablesByName;
+static std::vector<GenTable *> tableOrder; // dependencies first
+
+static std::string materialName(const EgtbPosition &pos)
+{
+    static const char letters[6] = {'P', 'R', 'N', 'B', 'Q', 'K'};
+    std::string name[2];
+    for (uint8_t i = 0; i < pos.count; i++)
+    {
+        PieceType type = egtbPieceType(pos.pieces[i]);
+        PieceColor color = egtbPieceColor(pos.pieces[i]);
+        if (type == KING)
+            name[color].insert(name[color].begin(), 'K');
+        else
+            name[color] += letters[type];
+    }
+    return name[WHITE] + name[BLACK];
+}
+
+static bool isAttacked(const GenPos &pos, int sq, PieceColor by)
+{
+    for (uint8_t i = 0; i < pos.count; i++)
+    {
+        if (egtbPieceColor(pos.pieces[i]) != by)
+            continue;
+        int from = pos.squares[i];
+        int df = fileOf(sq) - fileOf(from);
+        int dr = rankOf(sq) - rankOf(from);
+        int adf = abs(df), adr = abs(dr);
+        switch (egtbPieceType(pos.pieces[i]))
+        {
+        case PAWN:
+            if (dr == (by == WHITE ? 1 : -1) && adf == 1)
+                return true;
+            break;
+        case KNIGHT:
+            if ((adf == 1 && adr == 2) || (adf == 2 && adr == 1))
+                return true;
+            break;
+        case KING:
+            if (adf <= 1 && adr <= 1 && adf + adr > 0)
+                return true;
+            break;
+        default:
+        {
+            PieceType type = egtbPieceType(pos.pieces[i]);
+            bool diagonal = adf == adr && adf > 0;
+            bool straight = (adf == 0) != (adr == 0);
+            if ((diagonal && type != ROOK) || (straight && type != BISHOP))
+            {
+                int step = (dr > 0 ? 8 : dr < 0 ? -8 : 0) + (df > 0 ? 1 : df < 0 ? -1 : 0);
+                int s = from + step;
+                while (s != sq && pos.board[s] < 0)
+                    s += step;
+                if (s == sq)
+                    return true;
+            }
+            break;
+        }
+        }
+    }
+    return false;
+}
+
+static int kingIndex(const GenPos &pos, PieceColor color)
+{
+    for (uint8_t i = 0; i < pos.count; i++)
+    {
+        if (pos.pieces[i] == egtbPiece(KING, color))
+            return i;
+    }
+    return -1;
+}
+
+static bool inCheck(const GenPos &pos, PieceColor color)
+{
+    return isAttacked(pos, pos.squares[kingIndex(pos, color)], opposite(color));
+}
+
+static GenPos makeMove(const GenPos &pos, const GenMove &m)
+{
+    GenPos next = pos;
+    uint8_t piece = m.piece;
+    next.squares[piece] = m.to;
+    if (m.promotion >= 0)
+        next.pieces[piece] = egtbPiece((PieceType)m.promotion, egtbPieceColor(pos.pieces[piece]));
+    if (m.captured >= 0)
+    {
+        for (uint8_t i = m.captured; i + 1 < next.count; i++)
+        {
+            next.pieces[i] = next.pieces[i + 1];
+            next.squares[i] = next.squares[i + 1];
+        }
+        next.count--;
+    }
+    next.sideToMove = opposite(pos.sideToMove);
+    next.rebuild();
+    return next;
+}
+
+static void addMove(const GenPos &pos, uint8_t piece, int to, std::vector<GenMove> &moves)
+{
+    int target = pos.board[to];
+    if (target >= 0 && (egtbPieceColor(pos.pieces[target]) == pos.sideToMove ||
+                        egtbPieceType(pos.pieces[target]) == KING))
+        return;
+
+    GenMove m = {piece, (uint8_t)to, (int8_t)target, -1};
+    bool promote = egtbPieceType(pos.pieces[piece]) == PAWN && (rankOf(to) == 0 || rankOf(to) == 7);
+    for (int p = 0; p < (promote ? 4 : 1); p++)
+    {
+        if (promote)
+            m.promotion = promotions[p];
+        GenPos next = makeMove(pos, m);
+        if (!inCheck(next, pos.sideToMove))
+            moves.push_back(m);
+    }
+}
+
+static void generateMoves(const GenPos &pos, std::vector<GenMove> &moves)
+{
+    moves.clear();
+    for (uint8_t i = 0; i < pos.count; i++)
+    {
+        if (egtbPieceColor(pos.pieces[i]) != pos.sideToMove)
+            continue;
+        int from = pos.squares[i];
+        int f = fileOf(from), r = rankOf(from);
+        PieceType type = egtbPieceType(pos.pieces[i]);
+
+        if (type == PAWN)
+        {
+            int dir = pos.sideToMove == WHITE ? 1 : -1;
+            int startRank = pos.sideToMove == WHITE ? 1 : 6;
+            if (pos.board[from + 8 * dir] < 0)
+            {
+                addMove(pos, i, from + 8 * dir, moves);
+                if (r == startRank && pos.board[from + 16 * dir] < 0)
+                    addMove(pos, i, from + 16 * dir, moves);
+            }
+            for (int df = -1; df <= 1; df += 2)
+            {
+                if (onBoard(f + df, r + dir) && pos.board[from + 8 * dir + df] >= 0)
+                    addMove(pos, i, from + 8 * dir + df, moves);
+            }
+            continue;
+        }
+
+        if (type == KING || type == KNIGHT)
+        {
+            const int(*steps)[2] = type == KING ? kingSteps : knightSteps;
+            for (int s = 0; s < 8; s++)
+            {
+                if (onBoard(f + steps[s][0], r + steps[s][1]))
+                    addMove(pos, i, (r + steps[s][1]) * 8 + f + steps[s][0], moves);
+            }
+            continue;
+        }
+
+        for (int d = 0; d < 8; d++)
+        {
+            bool diagonal = d & 1;
+            if ((diagonal && type == ROOK) || (!diagonal && type == BISHOP))
+                continue;
+            int tf = f + kingSteps[d][0], tr = r + kingSteps[d][1];
+            while (onBoard(tf, tr))
+            {
+                addMove(pos, i, tr * 8 + tf, moves);
+                if (pos.board[tr * 8 + tf] >= 0)
+                    break;
+                tf += kingSteps[d][0];
+                tr += kingSteps[d][1];
+            }
+        }
+    }
+}
+
+// Positions the side that just moved could have come from (no uncaptures,
+// no unpromotions: those belong to other tables)
+static void generateUnmoves(const GenPos &pos, std::vector<GenPos> &preds)
+{
+    preds.clear();
+    PieceColor mover = opposite(pos.sideToMove);
+    for (uint8_t i = 0; i < pos.count; i++)
+    {
+        if (egtbPieceColor(pos.pieces[i]) != mover)
+            continue;
+        int from = pos.squares[i];
+        int f = fileOf(from), r = rankOf(from);
+        PieceType type = egtbPieceType(pos.pieces[i]);
+        std::vector<int> targets;
+
+        if (type == PAWN)
+        {
+            int dir = mover == WHITE ? 1 : -1;
+            int back = from - 8 * dir;
+            int backRank = rankOf(back);
+            if (backRank >= 1 && backRank <= 6 && pos.board[back] < 0)
+            {
+                targets.push_back(back);
+                int doubleRank = mover == WHITE ? 3 : 4;
+                if (r == doubleRank && pos.board[back - 8 * dir] < 0)
+                    targets.push_back(back - 8 * dir);
+            }
+        }
+        else if (type == KING || type == KNIGHT)
+        {
+            const int(*steps)[2] = type == KING ? kingSteps : knightSteps;
+            for (int s = 0; s < 8; s++)
+            {
+                int tf = f + steps[s][0], tr = r + steps[s][1];
+                if (onBoard(tf, tr) && pos.board[tr * 8 + tf] < 0)
+                    targets.push_back(tr * 8 + tf);
+            }
+        }
+        else
+        {
+            for (int d = 0; d < 8; d++)
+            {
+                bool diagonal = d & 1;
+                if ((diagonal && type == ROOK) || (!diagonal && type == BISHOP))
+                    continue;
+                int tf = f + kingSteps[d][0], tr = r + kingSteps[d][1];
+                while (onBoard(tf, tr) && pos.board[tr * 8 + tf] < 0)
+                {
+                    targets.push_back(tr * 8 + tf);
+                    tf += kingSteps[d][0];
+                    tr += kingSteps[d][1];
+                }
+            }
+        }
+
+        for (size_t t = 0; t < targets.size(); t++)
+        {
+            GenPos prev = pos;
+            prev.squares[i] = targets[t];
+            prev.sideToMove = mover;
+            prev.rebuild();
+            preds.push_back(prev);
+        }
+    }
+}
+
+static GenTable *getTable(const EgtbPosition &shape);
+
+static uint32_t entryKey(const GenTable &table, const EgtbPosition &pos)
+{
+    return (uint32_t)pos.sideToMove * table.entries + egtbIndex(pos);
+}
+
+static bool leavesTable(const GenMove &m)
+{
+    return m.captured >= 0 || m.promotion >= 0;
+}
+
+// Value after a move, from the point of view of the side to move next
+static Value lookup(const GenTable &self, const GenPos &pos, const GenMove &m)
+{
+    GenPos next = makeMove(pos, m);
+    EgtbPosition canon;
+    egtbCanonicalize(next.pieces, next.squares, next.count, next.sideToMove, canon);
+    const GenTable *table = &self;
+    if (leavesTable(m))
+    {
+        if (egtbIsTrivialDraw(canon))
+            return Value{EGTB_DRAW, 0};
+        table = getTable(canon);
+    }
+    uint32_t key = entryKey(*table, canon);
+    return Value{table->wdl[key], table->dtm[key]};
+}
+
+static void decode(const GenTable &table, uint32_t key, GenPos &pos)
+{
+    static const uint8_t triangleSquares[10] = {0, 1, 2, 3, 9, 10, 11, 18, 19, 27};
+    uint32_t index = key % table.entries;
+    pos.count = table.shape.count;
+    pos.sideToMove = key >= table.entries ? BLACK : WHITE;
+    for (int i = pos.count - 1; i >= 1; i--)
+    {
+        pos.squares[i] = index & 63;
+        index >>= 6;
+    }
+    pos.squares[0] = table.pawns ? (index / 4) * 8 + index % 4 : triangleSquares[index];
+    memcpy(pos.pieces, table.shape.pieces, sizeof(pos.pieces));
+    pos.rebuild();
+}
+
+static bool isLegalEntry(const GenTable &table, uint32_t key, const GenPos &pos)
+{
+    for (uint8_t i = 0; i < pos.count; i++)
+    {
+        if (pos.board[pos.squares[i]] != i)
+            return false; // two pieces on one square
+        if (egtbPieceType(pos.pieces[i]) == PAWN && (rankOf(pos.squares[i]) == 0 || rankOf(pos.squares[i]) == 7))
+            return false;
+    }
+    if (inCheck(pos, opposite(pos.sideToMove)))
+        return false;
+
+    EgtbPosition canon;
+    egtbCanonicalize(pos.pieces, pos.squares, pos.count, pos.sideToMove, canon);
+    return entryKey(table, canon) == key;
+}
+
+static void solve(GenTable &t)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint32_t total = t.entries * 2;
+    t.wdl.assign(total, UNKNOWN);
+    t.dtm.assign(total, 0);
+
+    std::vector<std::vector<uint32_t>> decided(MAX_PLIES + 1);
+    std::vector<std::vector<uint32_t>> exitWins(MAX_PLIES + 1);
+    std::vector<GenMove> moves;
+    std::vector<GenPos> preds;
+    GenPos pos;
+
+    // Initial pass: illegal entries, mates, stalemates, and the values of
+    // captures and promotions that leave this table
+    for (uint32_t key = 0; key < total; key++)
+    {
+        decode(t, key, pos);
+        if (!isLegalEntry(t, key, pos))
+        {
+            t.wdl[key] = EGTB_ILLEGAL;
+            continue;
+        }
+
+        generateMoves(pos, moves);
+        if (moves.empty())
+        {
+            t.wdl[key] = inCheck(pos, pos.sideToMove) ? EGTB_LOSS : EGTB_DRAW;
+            if (t.wdl[key] == EGTB_LOSS)
+                decided[0].push_back(key);
+            continue;
+        }
+
+        int bestWin = NO_EXIT, worstLoss = -1;
+        bool exitDraw = false, internal = false;
+        for (size_t m = 0; m < moves.size(); m++)
+        {
+            if (!leavesTable(moves[m]))
+            {
+                internal = true;
+                continue;
+            }
+            Value v = lookup(t, pos, moves[m]);
+            if (v.wdl == EGTB_LOSS && v.dtm + 1 < bestWin)
+                bestWin = v.dtm + 1;
+            else if (v.wdl == EGTB_WIN && v.dtm + 1 > worstLoss)
+                worstLoss = v.dtm + 1;
+            else if (v.wdl == EGTB_DRAW)
+                exitDraw = true;
+        }
+
+        if (bestWin != NO_EXIT)
+        {
+            exitWins[bestWin].push_back(key);
+        }
+        else if (!internal)
+        {
+            t.wdl[key] = exitDraw ? EGTB_DRAW : EGTB_LOSS;
+            if (!exitDraw)
+            {
+                t.dtm[key] = worstLoss;
+                decided[worstLoss].push_back(key);
+            }
+        }
+    }
+
+    // Retrograde passes, one ply at a time
+    for (int ply = 1; ply <= MAX_PLIES; ply++)
+    {
+        for (size_t k = 0; k < exitWins[ply].size(); k++)
+        {
+            uint32_t key = exitWins[ply][k];
+            if (t.wdl[key] == UNKNOWN)
+            {
+                t.wdl[key] = EGTB_WIN;
+                t.dtm[key] = ply;
+                decided[ply].push_back(key);
+            }
+        }
+
+        for (size_t k = 0; k < decided[ply - 1].size(); k++)
+        {
+            uint32_t key = decided[ply - 1][k];
+            uint8_t result = t.wdl[key];
+            decode(t, key, pos);
+            generateUnmoves(pos, preds);
+
+            for (size_t p = 0; p < preds.size(); p++)
+            {
+                EgtbPosition canon;
+                egtbCanonicalize(preds[p].pieces, preds[p].squares, preds[p].count, preds[p].sideToMove, canon);
+                uint32_t predKey = entryKey(t, canon);
+                if (t.wdl[predKey] != UNKNOWN)
+                    continue;
+
+                if (result == EGTB_LOSS)
+                {
+                    t.wdl[predKey] = EGTB_WIN;
+                    t.dtm[predKey] = ply;
+                    decided[ply].push_back(predKey);
+                    continue;
+                }
+
+                // The predecessor is lost only if every reply loses
+                generateMoves(preds[p], moves);
+                int worst = 0;
+                bool lost = true;
+                for (size_t m = 0; m < moves.size() && lost; m++)
+                {
+                    Value v = lookup(t, preds[p], moves[m]);
+                    lost = v.wdl == EGTB_WIN;
+                    if (v.dtm + 1 > worst)
+                        worst = v.dtm + 1;
+                }
+                if (lost)
+                {
+                    if (worst > MAX_PLIES)
+                    {
+                        fprintf(stderr, "%s: distance to mate overflows\n", t.name.c_str());
+                        exit(1);
+                    }
+                    t.wdl[predKey] = EGTB_LOSS;
+                    t.dtm[predKey] = worst;
+                    decided[worst].push_back(predKey);
+                }
+            }
+        }
+    }
+
+    uint32_t counts[4] = {0, 0, 0, 0};
+    int maxDtm = 0;
+    for (uint32_t key = 0; key < total; key++)
+    {
+        if (t.wdl[key] == UNKNOWN)
+            t.wdl[key] = EGTB_DRAW;
+        counts[t.wdl[key]]++;
+        if (t.dtm[key] > maxDtm)
+            maxDtm = t.dtm[key];
+    }
+
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%-6s %9u wins %9u draws %9u losses, longest mate %d plies (%.1fs)\n",
+           t.name.c_str(), counts[EGTB_WIN], counts[EGTB_DRAW], counts[EGTB_LOSS], maxDtm, secs);
+}
+
+static GenTable *getTable(const EgtbPosition &shape)
+{
+    std::string name = materialName(shape);
+    std::map<std::string, GenTable *>::iterator it = tablesByName.find(name);
+    if (it != tablesByName.end())
+    {
+        if (it->second->wdl.empty())
+        {
+            fprintf(stderr, "%s: circular table dependency\n", name.c_str());
+            exit(1);
+        }
+        return it->second;
+    }
+
+    GenTable *t = new GenTable();
+    t->name = name;
+    t->shape = shape;
+    t->pawns = egtbHasPawns(shape);
+    t->entries = egtbEntryCount(shape.count, t->pawns);
+    tablesByName[name] = t;
+    solve(*t);
+    tableOrder.push_back(t);
+    return t;
+}
+
+static bool parseMaterial(const char *text, EgtbPosition &shape)
+{
+    static const char letters[] = "PRNBQK";
+    uint8_t pieces[EGTB_MAX_PIECES], squares[EGTB_MAX_PIECES];
+    uint8_t count = 0;
+    int kings = 0;
+    for (const char *c = text; *c; c++)
+    {
+        const char *letter = strchr(letters, toupper(*c));
+        if (!letter || count == EGTB_MAX_PIECES)
+            return false;
+        if (*letter == 'K')
+            kings++;
+        if (kings == 0)
+            return false;
+        pieces[count] = egtbPiece((PieceType)(letter - letters), kings == 1 ? WHITE : BLACK);
+        squares[count] = count;
+        count++;
+    }
+    return kings == 2 && egtbCanonicalize(pieces, squares, count, WHITE, shape);
+}
+
+static void put32(std::vector<uint8_t> &out, uint32_t v)
+{
+    for (int i = 0; i < 4; i++)
+        out.push_back((v >> (8 * i)) & 0xFF);
+}
+
+static void appendTable(const GenTable &t, bool withDtm, std::vector<uint8_t> &out)
+{
+    uint32_t total = t.entries * 2;
+    int maxDtm = 0;
+    for (uint32_t key = 0; key < total && withDtm; key++)
+    {
+        if (t.dtm[key] > maxDtm)
+            maxDtm = t.dtm[key];
+    }
+    uint8_t dtmBits = 0;
+    while ((1 << dtmBits) <= maxDtm)
+        dtmBits++;
+
+    put32(out, EGTB_TABLE_MAGIC);
+    out.push_back(EGTB_VERSION);
+    out.push_back(t.shape.count);
+    out.push_back(dtmBits);
+    out.push_back(t.pawns ? 1 : 0);
+    for (uint8_t i = 0; i < EGTB_MAX_PIECES; i++)
+        out.push_back(i < t.shape.count ? t.shape.pieces[i] : EGTB_NO_PIECE);
+    put32(out, t.entries);
+
+    size_t wdlBase = out.size();
+    out.resize(wdlBase + (total * 2 + 7) / 8, 0);
+    for (uint32_t key = 0; key < total; key++)
+        out[wdlBase + key / 4] |= t.wdl[key] << ((key % 4) * 2);
+
+    size_t dtmBase = out.size();
+    out.resize(dtmBase + ((uint64_t)total * dtmBits + 7) / 8 + 2, 0);
+    for (uint32_t key = 0; key < total; key++)
+    {
+        uint64_t bit = (uint64_t)key * dtmBits;
+        uint32_t v = (uint32_t)t.dtm[key] << (bit & 7);
+        for (int b = 0; v; b++, v >>= 8)
+            out[dtmBase + bit / 8 + b] |= v & 0xFF;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *outPath = "egtb.bin";
+    bool wdlOnly = false;
+    std::vector<EgtbPosition> requested;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            outPath = argv[++i];
+            continue;
+        }
+        if (strcmp(argv[i], "--wdl-only") == 0)
+        {
+            wdlOnly = true;
+            continue;
+        }
+        EgtbPosition shape;
+        if (!parseMaterial(argv[i], shape) || shape.count < 3)
+        {
+            fprintf(stderr, "bad material '%s' (expected e.g. KQK, KRKN, KPKP)\n", argv[i]);
+            return 1;
+        }
+        requested.push_back(shape);
+    }
+    if (requested.empty())
+    {
+        fprintf(stderr, "usage: %s [-o egtb.bin] [--wdl-only] KQK KRK KPK ...\n", argv[0]);
+        return 1;
+    }
+
+    for (size_t i = 0; i < requested.size(); i++)
+    {
+        if (!egtbIsTrivialDraw(requested[i]))
+            getTable(requested[i]);
+    }
+
+    std::vector<uint8_t> image;
+    put32(image, EGTB_IMAGE_MAGIC);
+    image.push_back((uint8_t)tableOrder.size());
+    image.resize(8 + 4 * tableOrder.size(), 0);
+    for (size_t i = 0; i < tableOrder.size(); i++)
+    {
+        uint32_t offset = image.size();
+        for (int b = 0; b < 4; b++)
+            image[8 + 4 * i + b] = (offset >> (8 * b)) & 0xFF;
+        appendTable(*tableOrder[i], !wdlOnly || tableOrder[i]->shape.count < 4, image);
+    }
+
+    FILE *f = fopen(outPath, "wb");
+    if (!f || fwrite(image.data(), 1, image.size(), f) != image.size())
+    {
+        fprintf(stderr, "cannot write %s\n", outPath);
+        return 1;
+    }
+    fclose(f);
+    printf("wrote %zu tables, %zu bytes to %s\n", tableOrder.size(), image.size(), outPath);
+    return 0;
+}
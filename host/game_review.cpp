@@ -0,0 +1,223 @@
+// Game review (GameReview.h): grades every move of a finished game, and
+// with -sweep times the same review on 1, 2, 4 ... threads.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++17 -Ihost -I. host/game_review.cpp host/GameReview.cpp host/Pgn.cpp *.cpp -o game_review -pthread
+// add -DTT_ENTRIES=1048576 for a table to match a long game at depth.
+// Usage:
+//   ./game_review [-depth 5] [-j threads] [-sweep] [-game n] game.pgn
+//   ./game_review [-depth 5] [-j threads] [-sweep] -store game.bin
+// -game picks the nth game of the file (default the first); -store reads
+// the game a GameStore image holds (the board's compact move record): a
+// host tool's store file, or the board's EEPROM read out raw (avrdude
+// -U eeprom:r:game.bin:r), with -DGAME_STORE_BASE to match the sketch's.
+// Each sweep run starts from an empty table; it reports wall-clock time,
+// speed-up over one thread, and how many grades differ from the one-thread
+// review.
+
+#include "GameReview.h"
+#include "GameStore.h"
+#include "Pgn.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+static TranspositionTable table;
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool loadPgn(const char *path, int number, Position &start, std::vector<Move> &moves)
+{
+    PgnFile file;
+    if (!mapPgnFile(path, file))
+        return false;
+    PgnReader reader(file.data, file.size);
+    PgnGame game;
+    for (int n = 0; n < number; n++)
+    {
+        if (!reader.next(game))
+        {
+            fprintf(stderr, "%s: no game %d\n", path, number);
+            return false;
+        }
+    }
+    if (game.fen.empty())
+        start.setStartPosition();
+    else if (!start.setFromFen(std::string(game.fen).c_str()))
+    {
+        fprintf(stderr, "%s: bad FEN tag\n", path);
+        return false;
+    }
+
+    Position p = start;
+    size_t cursor = 0;
+    std::string_view san;
+    while (nextSan(game.movetext, cursor, san))
+    {
+        Move m = parseSan(p, san);
+        if (m == NO_MOVE)
+        {
+            fprintf(stderr, "%s: \"%.*s\" is not a legal move at ply %zu\n", path, (int)san.size(), san.data(),
+                    moves.size() + 1);
+            return false;
+        }
+        moves.push_back(m);
+        p.makeMove(m);
+    }
+    return true;
+}
+
+static bool loadStore(const char *path, Position &start, std::vector<Move> &moves)
+{
+    GameStore store;
+    if (!store.openFile(path) || !store.load(start))
+    {
+        fprintf(stderr, "%s: no game stored\n", path);
+        return false;
+    }
+    for (uint16_t i = 0; i < store.moveCount(); i++)
+    {
+        moves.push_back(store.moveAt(i));
+    }
+    return true;
+}
+
+static void printScore(int16_t score)
+{
+    if (score == MATE_SCORE)
+        printf(" mate  ");
+    else if (score > MATE_BOUND)
+        printf("   #%-3d", (MATE_SCORE - score + 1) / 2);
+    else if (score < -MATE_BOUND)
+        printf("  -#%-3d", (MATE_SCORE + score + 1) / 2);
+    else
+        printf(" %+6.2f", score / 100.0);
+}
+
+static void printReview(const Position &start, const std::vector<MoveReview> &reviews)
+{
+    Position p = start;
+    int counts[2][GRADE_COUNT] = {};
+    long loss[2] = {0, 0};
+    printf("  move       played   best     best  played  loss\n");
+    for (const MoveReview &r : reviews)
+    {
+        char played[16], best[16] = "-";
+        formatSan(p, r.played, played);
+        if (r.best != NO_MOVE)
+            formatSan(p, r.best, best);
+        printf("%4d%s %-9s %-8s", p.fullMoveNumber, p.sideToMove == WHITE ? ". " : "..", played, best);
+        printScore(r.bestScore);
+        printScore(r.playedScore);
+        printf(" %5d  %s\n", r.loss, r.grade > GRADE_GOOD ? moveGradeName(r.grade) : "");
+        counts[p.sideToMove][r.grade]++;
+        loss[p.sideToMove] += r.loss;
+        p.makeMove(r.played);
+    }
+    for (int side = WHITE; side <= BLACK; side++)
+    {
+        int moves = 0;
+        printf("%s:", side == WHITE ? "white" : "black");
+        for (int g = 0; g < GRADE_COUNT; g++)
+        {
+            printf(" %d %s,", counts[side][g], moveGradeName((MoveGrade)g));
+            moves += counts[side][g];
+        }
+        printf(" average loss %.0f\n", moves ? (double)loss[side] / moves : 0.0);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int depth = 5;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    int number = 1;
+    bool sweep = false;
+    const char *pgnPath = nullptr, *storePath = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-depth") == 0 && i + 1 < argc)
+            depth = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+            threads = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "-game") == 0 && i + 1 < argc)
+            number = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "-store") == 0 && i + 1 < argc)
+            storePath = argv[++i];
+        else if (strcmp(argv[i], "-sweep") == 0)
+            sweep = true;
+        else
+            pgnPath = argv[i];
+    }
+    if (!pgnPath && !storePath)
+    {
+        fprintf(stderr, "usage: %s [-depth 5] [-j threads] [-sweep] [-game n] game.pgn\n"
+                        "       %s [-depth 5] [-j threads] [-sweep] -store game.bin\n",
+                argv[0], argv[0]);
+        return 2;
+    }
+    depth = std::max(1, std::min(depth, SEARCH_MAX_DEPTH));
+
+    Position start;
+    std::vector<Move> moves;
+    if (storePath ? !loadStore(storePath, start, moves) : !loadPgn(pgnPath, number, start, moves))
+        return 2;
+
+    std::vector<MoveReview> reviews;
+    GameReview review(table, threads);
+    auto begin = std::chrono::steady_clock::now();
+    if (!review.review(start, moves.data(), (int)moves.size(), depth, reviews))
+    {
+        fprintf(stderr, "the game has an illegal move\n");
+        return 2;
+    }
+    double seconds = secondsSince(begin);
+    printReview(start, reviews);
+    printf("%zu moves, %zu positions at depth %d on %d threads: %.2f s, %.1f M nodes/s\n", moves.size(),
+           moves.size() + 1, depth, threads, seconds, review.getNodes() / seconds / 1e6);
+
+    if (sweep)
+    {
+        int cores = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<int> counts;
+        for (int n = 1; n < cores; n *= 2)
+        {
+            counts.push_back(n);
+        }
+        counts.push_back(cores);
+
+        std::vector<MoveReview> single;
+        double singleSeconds = 0;
+        printf("threads   wall s  speed-up  M nodes  grades differing from 1 thread\n");
+        for (int n : counts)
+        {
+            table.clear();
+            GameReview run(table, n);
+            std::vector<MoveReview> result;
+            auto t = std::chrono::steady_clock::now();
+            run.review(start, moves.data(), (int)moves.size(), depth, result);
+            double s = secondsSince(t);
+            if (n == 1)
+            {
+                single = result;
+                singleSeconds = s;
+            }
+            int differing = 0;
+            for (size_t i = 0; i < result.size(); i++)
+            {
+                differing += result[i].grade != single[i].grade;
+            }
+            printf("%7d %8.2f %8.2fx %8.1f  %d\n", n, s, singleSeconds / s, run.getNodes() / 1e6, differing);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+// Multi-game relay benchmark: N concurrent games in a GameTable, every game
+// advanced one ply per round, with a share of illegal moves mixed in.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++17 -Ihost -I. host/game_table_bench.cpp host/GameTable.cpp *.cpp -o game_table_bench
+// Usage:
+//   ./game_table_bench [games=100000] [plies=60]
+//
+// Only GameTable::applyMove (validation, make-move, game state) is timed;
+// picking the moves to send is not.
+
+#include "GameTable.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+static uint32_t rngState = 0x2545F491;
+static uint32_t nextRandom()
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+// A random legal move, or (one time in eight) a random move that is most
+// likely illegal, like a misread sensor would produce
+static Move pickMove(const Position &p)
+{
+    if ((nextRandom() & 7) == 0)
+        return makeMove(nextRandom() & 63, nextRandom() & 63);
+
+    Move moves[256];
+    int count = 0;
+    auto collect = [&](Move m)
+    {
+        if (!leavesKingInCheck(p.board, m, p.sideToMove))
+            moves[count++] = m;
+        return false;
+    };
+    generateMoves(p.board, p.sideToMove, p.castlingRights, p.epSquare, collect);
+    return count ? moves[nextRandom() % count] : NO_MOVE;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t games = argc > 1 ? (uint32_t)atol(argv[1]) : 100000;
+    int plies = argc > 2 ? atoi(argv[2]) : 60;
+
+    GameTable table(games);
+    std::vector<GameId> ids(games);
+    for (uint32_t i = 0; i < games; i++)
+    {
+        ids[i] = table.createGame();
+    }
+
+    std::vector<Move> batch(games);
+    double seconds = 0;
+    uint64_t applied = 0, rejected = 0, finished = 0;
+    for (int ply = 0; ply < plies; ply++)
+    {
+        for (uint32_t i = 0; i < games; i++)
+        {
+            batch[i] = table.getGameState(ids[i]) == GAME_ACTIVE ? pickMove(table.getPosition(ids[i])) : NO_MOVE;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < games; i++)
+        {
+            MoveResult r = table.applyMove(ids[i], batch[i]);
+            if (r == MOVE_APPLIED)
+                applied++;
+            else
+                rejected++;
+        }
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    for (uint32_t i = 0; i < games; i++)
+    {
+        finished += table.getGameState(ids[i]) != GAME_ACTIVE;
+    }
+
+    uint64_t requests = applied + rejected;
+    printf("games:              %u concurrent, %d rounds\n", games, plies);
+    printf("bytes per game:     %zu (budget %d; ChessBoard object: %zu)\n",
+           GameTable::bytesPerGame(), GAME_TABLE_BYTES_PER_GAME_BUDGET, sizeof(ChessBoard));
+    printf("table storage:      %.1f MB\n", GameTable::bytesPerGame() * (double)games / 1e6);
+    printf("move requests:      %llu (%llu applied, %llu rejected as illegal or after the end)\n",
+           (unsigned long long)requests, (unsigned long long)applied, (unsigned long long)rejected);
+    printf("games finished:     %llu\n", (unsigned long long)finished);
+    printf("throughput:         %.0f move requests/s\n", requests / seconds);
+    printf("round over all games: %.1f ms\n", seconds * 1000 / plies);
+    return 0;
+}
@@ -0,0 +1,113 @@
+// Hint search benchmark: runs startHint()/pollHint() the way loop() does
+// and reports the depth each budget buys, and how long the longest slice
+// kept loop() away from the sensors.
+//
+// A slice more than 10% over its time counts as an overrun. The host's
+// scheduler alone stalls a thread for milliseconds now and then, so a few
+// are expected; the run fails if more than 5% of the slices overrun, which
+// means the search itself is reading the clock too seldom.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++17 -Ihost -I. host/hint_bench.cpp *.cpp -o hint_bench
+// add -DSMARTCHESS_MAILBOX_BACKEND -DTT_ENTRIES=64 for the AVR's backend and
+// table size.
+// Usage:
+//   ./hint_bench [slice us=5000] [budgets ms=50,200,1000]
+
+#include "Search.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+struct HintCase
+{
+    const char *name;
+    const char *fen;
+    const char *expected; // move the hint must find at every budget, or null
+};
+
+static const HintCase cases[] = {
+    {"opening", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", nullptr},
+    {"italian", "r1bqk2r/pppp1ppp/2n2n2/2b1p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4", nullptr},
+    {"hanging queen", "rnb1kbnr/pppp1ppp/8/4p1q1/3P4/2N5/PPP1PPPP/R1BQKBNR w KQkq - 0 3", "c1g5"},
+    {"back rank", "6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", "a1a8"},
+    {"fork", "r3k3/8/8/8/8/8/8/4K1N1 w - - 0 1", nullptr},
+    {"endgame", "8/5k2/8/3KP3/8/8/8/8 w - - 0 1", nullptr},
+    {"one move", "k7/8/2K5/8/8/8/8/1R6 b - - 0 1", "a8a7"},
+};
+
+static TranspositionTable table;
+
+static void formatMove(Move m, char *text)
+{
+    if (m == NO_MOVE)
+    {
+        strcpy(text, "none");
+        return;
+    }
+    snprintf(text, 6, "%c%c%c%c", 'a' + (moveFrom(m) & 7), '1' + (moveFrom(m) >> 3), 'a' + (moveTo(m) & 7), '1' + (moveTo(m) >> 3));
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t slice = argc > 1 ? atoi(argv[1]) : SEARCH_DEFAULT_SLICE_MICROS;
+    char list[64] = "50,200,1000";
+    if (argc > 2)
+        snprintf(list, sizeof(list), "%s", argv[2]);
+    std::vector<uint32_t> budgets;
+    for (char *token = strtok(list, ","); token; token = strtok(nullptr, ","))
+        budgets.push_back(atoi(token));
+
+    Search search(table);
+    search.setSliceMicros(slice);
+    bool allPassed = true;
+    double overrunLimit = slice * 1.1, worstSlice = 0;
+    long totalSlices = 0, overruns = 0;
+
+    printf("%-14s %7s %6s %5s %9s %7s %10s %10s %7s\n", "case", "budget", "move", "depth", "nodes", "slices", "max slice", "ready at", "score");
+    for (const HintCase &hint : cases)
+    {
+        Position position;
+        position.setFromFen(hint.fen);
+        for (uint32_t budget : budgets)
+        {
+            table.clear();
+            auto start = std::chrono::steady_clock::now();
+            search.startHint(position, budget);
+            double longest = 0;
+            int slices = 0;
+            // What loop() does: one slice per pass, then the sensors and LEDs
+            while (search.getStatus() == HINT_THINKING)
+            {
+                auto sliceStart = std::chrono::steady_clock::now();
+                search.pollHint();
+                double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sliceStart).count();
+                longest = us > longest ? us : longest;
+                slices++;
+                overruns += slice && us > overrunLimit;
+            }
+            totalSlices += slices;
+            worstSlice = longest > worstSlice ? longest : worstSlice;
+            double readyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            char move[6];
+            formatMove(search.bestMove(), move);
+            bool passed = position.isLegal(search.bestMove()) && (!hint.expected || strcmp(move, hint.expected) == 0);
+            allPassed = allPassed && passed;
+            printf("%-14s %5u ms %6s %5u %9u %7d %7.0f us %7.1f ms %7d%s\n", hint.name, budget, move, search.completedDepth(),
+                   search.getNodes(), slices, longest, readyMs, search.bestScore(), passed ? "" : "  FAILED");
+        }
+    }
+    printf("slice: %u us, time checks every %d nodes, table: %d entries\n", slice, SEARCH_TIME_CHECK_NODES, TT_ENTRIES);
+    if (slice)
+    {
+        bool tooMany = overruns * 20 > totalSlices;
+        printf("overruns: %ld of %ld slices over %.0f us, longest %.0f us%s\n", overruns, totalSlices, overrunLimit,
+               worstSlice, tooMany ? "  FAILED" : "");
+        allPassed = allPassed && !tooMany;
+    }
+    return allPassed ? 0 : 1;
+}
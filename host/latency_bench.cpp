@@ -0,0 +1,34 @@
+// Worst-case movePiece() latency over the adversarial corpus in
+// LatencyBench.cpp; the same code runs on the AVR (see LatencyBench.h).
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++17 -Ihost -I. host/latency_bench.cpp *.cpp -o latency_bench
+// add -DSMARTCHESS_PERF_CYCLES for TSC cycles instead of microseconds.
+// Usage:
+//   ./latency_bench [repeats=2000]
+//
+// Exits non-zero if any case ends in the wrong game state.
+
+#include "LatencyBench.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+int main(int argc, char **argv)
+{
+    uint16_t repeats = argc > 1 ? (uint16_t)atoi(argv[1]) : 2000;
+
+    static LatencyReport report;
+    arduinoSerialMuted() = true;
+    runLatencyBench(report, repeats);
+    arduinoSerialMuted() = false;
+
+    printf("repeats: %u\n", repeats);
+    printLatencyReport(report);
+    for (uint8_t i = 0; i < report.caseCount; i++)
+    {
+        if (!report.cases[i].passed)
+            return 1;
+    }
+    return 0;
+}
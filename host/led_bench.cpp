@@ -0,0 +1,142 @@
+// LED update check and timing: random games are played through movePiece()
+// and after every move two emulated strips are brought up to date, one the
+// old way (every square redrawn, all 64 pixels sent) and one from the
+// board's dirty squares. The dirty squares must be exactly the squares
+// whose contents changed (castling and en passant included), and the delta
+// strip must show the same as the full redraw. Reports pixels sent and wire
+// time per move for both.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++17 -Ihost -I. host/led_bench.cpp *.cpp -o led_bench
+// Add -DLED_SEGMENT_LENGTH=8 for one chain per rank.
+// Usage:
+//   ./led_bench [games=200]
+
+#include "ChessBoard.h"
+#include "LedFrame.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+static uint32_t rngState = 0x2545F491;
+static uint32_t nextRandom()
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+static Move randomLegalMove(const Position &p)
+{
+    Move moves[256];
+    int count = 0;
+    auto collect = [&](Move m)
+    {
+        if (!leavesKingInCheck(p.board, m, p.sideToMove))
+            moves[count++] = m;
+        return false;
+    };
+    generateMoves(p.board, p.sideToMove, p.castlingRights, p.epSquare, collect);
+    return count ? moves[nextRandom() % count] : NO_MOVE;
+}
+
+static uint64_t changedSquares(const Position &before, const Position &after)
+{
+    uint64_t bits = 0;
+    for (Square sq = 0; sq < 64; sq++)
+    {
+        if (before.board.pieceAt(sq) != after.board.pieceAt(sq))
+            bits |= 1ULL << sq;
+    }
+    return bits;
+}
+
+static uint32_t expectedColor(const Position &p, Square sq)
+{
+    PieceCode piece = p.board.pieceAt(sq);
+    if (piece == NO_PIECE)
+        return LED_COLOR_EMPTY;
+    return pieceColor(piece) == WHITE ? LED_COLOR_WHITE : LED_COLOR_BLACK;
+}
+
+int main(int argc, char **argv)
+{
+    int games = argc > 1 ? atoi(argv[1]) : 200;
+    arduinoSerialMuted() = true;
+
+    ChessBoard board;
+    LedFrame full, delta;
+    full.begin();
+    delta.begin();
+
+    uint64_t moves = 0, castles = 0, enPassants = 0, promotions = 0;
+    uint64_t wrongDirty = 0, wrongStrip = 0;
+    uint64_t fullPixels = 0, deltaPixels = 0, deltaWorst = 0;
+    double fullSeconds = 0, deltaSeconds = 0;
+    for (int g = 0; g < games; g++)
+    {
+        board.initializeStandardGame();
+        // New game: everything is dirty, both strips redraw completely
+        full.drawSquares(board.getBackend(), ~0ULL);
+        full.invalidate();
+        full.show();
+        delta.drawSquares(board.getBackend(), board.takeDirtySquares());
+        delta.invalidate();
+        delta.show();
+
+        for (int ply = 0; ply < 300 && board.getGameState() == GAME_ACTIVE; ply++)
+        {
+            Position before = board.getPosition();
+            Move m = randomLegalMove(before);
+            board.movePiece(m);
+            const Position &after = board.getPosition();
+            moves++;
+            castles += moveFlag(m) == MOVE_CASTLING;
+            enPassants += moveFlag(m) == MOVE_EN_PASSANT;
+            promotions += moveFlag(m) == MOVE_PROMOTION;
+
+            auto start = std::chrono::steady_clock::now();
+            full.drawSquares(board.getBackend(), ~0ULL);
+            full.invalidate();
+            fullPixels += full.show();
+            auto middle = std::chrono::steady_clock::now();
+            uint64_t dirty = board.takeDirtySquares();
+            delta.drawSquares(board.getBackend(), dirty);
+            uint8_t sent = delta.show();
+            auto end = std::chrono::steady_clock::now();
+            fullSeconds += std::chrono::duration<double>(middle - start).count();
+            deltaSeconds += std::chrono::duration<double>(end - middle).count();
+            deltaPixels += sent;
+            deltaWorst = sent > deltaWorst ? sent : deltaWorst;
+
+            if (dirty != changedSquares(before, after) || dirty != moveSquares(m))
+                wrongDirty++;
+            for (Square sq = 0; sq < 64; sq++)
+            {
+                if (delta.stripSquare(sq) != expectedColor(after, sq) || full.stripSquare(sq) != delta.stripSquare(sq))
+                {
+                    wrongStrip++;
+                    break;
+                }
+            }
+        }
+    }
+    // Game starts left out: both strips sent all 64 pixels then
+    unsigned long startWire = (unsigned long)games * (64 * LED_PIXEL_MICROS + LED_LATCH_MICROS);
+    unsigned long fullWire = full.wireMicros() - startWire;
+    unsigned long deltaWire = delta.wireMicros() - startWire;
+
+    printf("%d chain(s) of %d pixels, %llu moves (%llu castling, %llu en passant, %llu promotions)\n", LED_SEGMENTS,
+           LED_SEGMENT_LENGTH, (unsigned long long)moves, (unsigned long long)castles,
+           (unsigned long long)enPassants, (unsigned long long)promotions);
+    printf("dirty squares wrong: %llu, strip differing from a full redraw: %llu\n", (unsigned long long)wrongDirty,
+           (unsigned long long)wrongStrip);
+    printf("full redraw:  %5.1f pixels, %7.1f us on the wire per move (host %.2f us)\n",
+           (double)fullPixels / moves, (double)fullWire / moves, fullSeconds * 1e6 / moves);
+    printf("dirty only:   %5.1f pixels, %7.1f us on the wire per move (host %.2f us), worst %llu pixels\n",
+           (double)deltaPixels / moves, (double)deltaWire / moves, deltaSeconds * 1e6 / moves,
+           (unsigned long long)deltaWorst);
+    return wrongDirty || wrongStrip ? 1 : 0;
+}
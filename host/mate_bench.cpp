@@ -0,0 +1,102 @@
+// Mate-in-N solver benchmark: solves a set of puzzles, then checks every
+// legal first move the way puzzle mode checks a player's answer.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++17 -Ihost -I. host/mate_bench.cpp *.cpp -o mate_bench
+// add -DSMARTCHESS_MAILBOX_BACKEND -DTT_ENTRIES=64 for the AVR's backend and
+// table size.
+// Usage:
+//   ./mate_bench [repeats=20]
+//
+// Nodes are the figure to carry over to the AVR: time there is roughly
+// nodes x the per-node cost measured on the target.
+
+#include "MateSearch.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+struct Puzzle
+{
+    const char *name;
+    const char *fen;
+    uint8_t mateIn; // 0: no mate by checks within MATE_MAX_MOVES
+};
+
+static const Puzzle puzzles[] = {
+    {"back rank", "6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", 1},
+    {"legal trap", "r2qkb1r/pp2nppp/3p4/2pNN1B1/2BnP3/3P4/PPP2PPP/R2bK2R w KQkq - 1 1", 2},
+    {"queen sacrifice", "4kb1r/p2n1ppp/4q3/4p1B1/4P3/1Q6/PPP2PPP/2KR4 w k - 1 1", 2},
+    {"rook lift", "r5rk/5p1p/5R2/4B3/8/8/7P/7K w - - 0 1", 3},
+    {"black queen hunt", "2r3k1/p4p2/3Rp2p/1p2P1pK/8/1P4P1/P3Q2P/1q6 b - - 0 1", 3},
+    {"philidor's legacy", "5r1k/6pp/8/3Q2N1/8/8/8/6K1 w - - 0 1", 4},
+    {"bishop pair", "1r2k1r1/pbppnp1p/1b3P2/8/Q7/B1PB1q2/P4PPP/3R2K1 w - - 1 1", 4},
+    {"two queens", "8/8/8/4k3/8/8/8/QQ2K3 w - - 0 1", 4},
+    {"no mate", "r1bqk2r/pppp1ppp/2n2n2/2b1p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4", 0},
+};
+
+static TranspositionTable table;
+
+static void printMove(Move m)
+{
+    printf(" %c%c%c%c", 'a' + (moveFrom(m) & 7), '1' + (moveFrom(m) >> 3), 'a' + (moveTo(m) & 7), '1' + (moveTo(m) >> 3));
+}
+
+int main(int argc, char **argv)
+{
+    int repeats = argc > 1 ? atoi(argv[1]) : 20;
+    MateSearch search(table);
+    bool allPassed = true;
+
+    printf("%-18s %6s %8s %10s %9s  %s\n", "puzzle", "mate", "nodes", "solve us", "keys", "line");
+    for (const Puzzle &puzzle : puzzles)
+    {
+        Position position;
+        position.setFromFen(puzzle.fen);
+
+        // Cold table each time: the figure the board sees for a new puzzle
+        MateResult result;
+        double seconds = 0;
+        for (int r = 0; r < repeats; r++)
+        {
+            table.clear();
+            auto start = std::chrono::steady_clock::now();
+            search.solve(position, MATE_MAX_MOVES, result);
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        // Puzzle mode: which first moves keep a mate in the same number of moves
+        int keys = 0, legal = 0;
+        bool solutionAccepted = result.mateIn == 0;
+        Move moves[256];
+        int count = 0;
+        auto collect = [&](Move m)
+        {
+            if (!leavesKingInCheck(position.board, m, position.sideToMove))
+                moves[count++] = m;
+            return false;
+        };
+        generateMoves(position.board, position.sideToMove, position.castlingRights, position.epSquare, collect);
+        for (int i = 0; i < count && puzzle.mateIn; i++)
+        {
+            legal++;
+            if (search.forcesMate(position, moves[i], puzzle.mateIn))
+            {
+                keys++;
+                solutionAccepted = solutionAccepted || moves[i] == result.line[0];
+            }
+        }
+
+        bool passed = result.mateIn == puzzle.mateIn && solutionAccepted && (puzzle.mateIn == 0 || keys > 0);
+        allPassed = allPassed && passed;
+        printf("%-18s %6u %8u %10.0f %4d/%-4d ", puzzle.name, result.mateIn, result.nodes, seconds * 1e6 / repeats, keys, legal);
+        for (uint8_t i = 0; i < result.lineLength; i++)
+        {
+            printMove(result.line[i]);
+        }
+        printf("%s\n", passed ? "" : "  FAILED");
+    }
+    printf("table: %d entries, %zu bytes\n", TT_ENTRIES, sizeof(TranspositionTable));
+    return allPassed ? 0 : 1;
+}
@@ -0,0 +1,340 @@
+// Move generation check, for whichever backend it is built with:
+//   - perft counts of the standard test positions (the start position,
+//     kiwipete and the rest of the usual suite) and of positions built
+//     around en passant, promotion, castling and discovered-check edge
+//     cases,
+//   - on every position of the first plies of those, givesCheck() against
+//     making the move and looking, and isPseudoLegal() against the
+//     generator's list for every from/to/flag combination,
+//   - random games on a ChessBoard, with hand edits mixed in: after every
+//     move and edit its incremental AttackMap must equal one rebuilt from
+//     scratch, and ChessBoard::givesCheck() must agree with the move made;
+//     a piece placed on a side that has 16 already must be refused,
+//   - a 16th piece of one type (a side without a king) is refused and leaves
+//     the other material counts alone.
+//
+// Build (from the repository root), once per backend:
+//   g++ -O2 -std=c++17 -Ihost -I. host/movegen_check.cpp *.cpp -o movegen_check
+//   g++ -O2 -std=c++17 -DSMARTCHESS_MAILBOX_BACKEND -Ihost -I. host/movegen_check.cpp *.cpp -o movegen_check_mailbox
+// Usage:
+//   ./movegen_check [games=200]
+// Exits 1 on any mismatch.
+
+#include "ChessBoard.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+static uint32_t rngState = 0x2545F491;
+static uint32_t nextRandom()
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+struct PerftCase
+{
+    const char *fen;
+    int depth;
+    uint64_t nodes;
+};
+
+static const PerftCase perftCases[] = {
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5, 4865609},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603}, // kiwipete
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487},
+    {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594},
+    // En passant: pinned capturer, capture along the king's rank, capture giving check
+    {"3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1", 6, 1134888},
+    {"8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1", 6, 1015133},
+    {"8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 6, 1440467},
+    // Castling: giving check, through attacked squares, rights lost to captures
+    {"5k2/8/8/8/8/8/8/4K2R w K - 0 1", 6, 661072},
+    {"3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", 6, 803711},
+    {"r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1", 4, 1274206},
+    {"r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", 4, 1720476},
+    // Promotion: out of check, giving check, underpromotion
+    {"2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1", 6, 3821001},
+    {"4k3/1P6/8/8/8/8/K7/8 w - - 0 1", 6, 217342},
+    {"8/P1k5/K7/8/8/8/8/8 w - - 0 1", 6, 92683},
+    // Discovered check, stalemate and mate at the leaves
+    {"8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1", 5, 1004658},
+    {"K1k5/8/P7/8/8/8/8/8 w - - 0 1", 6, 2217},
+    {"8/k1P5/8/1K6/8/8/8/8 w - - 0 1", 7, 567584},
+    {"8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", 4, 23527},
+};
+
+// Leaf nodes depth plies below p
+static uint64_t perft(const Position &p, int depth)
+{
+    uint64_t count = 0;
+    auto visit = [&](Move m)
+    {
+        if (leavesKingInCheck(p.board, m, p.sideToMove))
+            return false;
+        if (depth == 1)
+            count++;
+        else
+        {
+            Position next = p;
+            next.makeMove(m);
+            count += perft(next, depth - 1);
+        }
+        return false;
+    };
+    generateMoves(p.board, p.sideToMove, p.castlingRights, p.epSquare, visit);
+    return count;
+}
+
+static int failures = 0;
+
+static void fail(const char *fen, const char *what, Move m)
+{
+    if (failures++ < 20)
+        printf("FAIL %s: %s, move %d-%d flag %d promotion %d\n", fen, what, moveFrom(m), moveTo(m), moveFlag(m),
+               movePromotion(m));
+}
+
+// givesCheck() and isPseudoLegal() on p and the positions plies below it
+static void checkNode(const char *fen, const Position &p, int plies, int pseudoPlies, uint64_t &moves)
+{
+    Move list[256];
+    int count = 0;
+    auto collect = [&](Move m)
+    {
+        list[count++] = m;
+        return false;
+    };
+    generateMoves(p.board, p.sideToMove, p.castlingRights, p.epSquare, collect);
+
+    CheckInfo info;
+    computeCheckInfo(p.board, p.sideToMove, info);
+    for (int i = 0; i < count; i++)
+    {
+        // A king moving next to the other one "checks" it, but never legally
+        if (leavesKingInCheck(p.board, list[i], p.sideToMove))
+            continue;
+        Position next = p;
+        next.makeMove(list[i]);
+        bool checks = next.inCheck();
+        if (givesCheck(p.board, info, list[i]) != checks || givesCheck(p.board, list[i]) != checks)
+            fail(fen, checks ? "givesCheck() misses a check" : "givesCheck() reports a check", list[i]);
+        moves++;
+        if (plies > 0)
+            checkNode(fen, next, plies - 1, pseudoPlies - 1, moves);
+    }
+
+    if (pseudoPlies < 0)
+        return;
+    // Every encoding the generator could produce: normal, en passant and
+    // castling moves without promotion bits, promotions with each piece
+    for (Square from = 0; from < 64; from++)
+    {
+        for (Square to = 0; to < 64; to++)
+        {
+            for (int kind = 0; kind < 7; kind++)
+            {
+                Move m = kind < 4 ? makeMove(from, to, MOVE_PROMOTION, (PromotionType)kind)
+                                  : makeMove(from, to, (MoveFlag)(kind == 4 ? MOVE_NORMAL : kind == 5 ? MOVE_EN_PASSANT : MOVE_CASTLING));
+                bool listed = false;
+                for (int i = 0; i < count && !listed; i++)
+                {
+                    listed = list[i] == m;
+                }
+                if (isPseudoLegal(p.board, p.sideToMove, p.castlingRights, p.epSquare, m) != listed)
+                    fail(fen, listed ? "isPseudoLegal() rejects a generated move" : "isPseudoLegal() accepts a move never generated", m);
+            }
+        }
+    }
+}
+
+static void checkPerft()
+{
+    uint64_t totalNodes = 0, checkedMoves = 0;
+    double seconds = 0;
+    for (const PerftCase &c : perftCases)
+    {
+        Position p;
+        if (!p.setFromFen(c.fen))
+        {
+            printf("FAIL %s: bad FEN\n", c.fen);
+            failures++;
+            continue;
+        }
+        auto start = std::chrono::steady_clock::now();
+        uint64_t nodes = perft(p, c.depth);
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        totalNodes += nodes;
+        if (nodes != c.nodes)
+        {
+            printf("FAIL %s: perft(%d) = %llu, expected %llu\n", c.fen, c.depth, (unsigned long long)nodes,
+                   (unsigned long long)c.nodes);
+            failures++;
+        }
+        checkNode(c.fen, p, 2, 1, checkedMoves);
+    }
+    printf("perft:             %zu positions, %llu nodes, %.1f M nodes/s\n", sizeof(perftCases) / sizeof(perftCases[0]),
+           (unsigned long long)totalNodes, totalNodes / seconds / 1e6);
+    printf("givesCheck, isPseudoLegal: %llu moves checked\n", (unsigned long long)checkedMoves);
+}
+
+// The board's incremental attack state against the same state rebuilt
+static bool attacksMatch(ChessBoard &board)
+{
+    const BoardBackend &backend = board.getBackend();
+#if SMARTCHESS_ATTACK_MAPS
+    AttackMap rebuilt;
+    rebuilt.rebuild(backend);
+#endif
+    for (PieceColor by = WHITE; by <= BLACK; by = (PieceColor)(by + 1))
+    {
+        for (Square sq = 0; sq < 64; sq++)
+        {
+            bool attacked = backend.isAttacked(sq, by);
+            if (board.isSquareAttacked(sq, by) != attacked || ((board.getThreatRank((sq >> 3) + 1, by) >> (sq & 7)) & 1) != attacked)
+                return false;
+#if SMARTCHESS_ATTACK_MAPS
+            if (board.getAttackerCount(sq, by) != rebuilt.attackers(sq, by))
+                return false;
+#endif
+        }
+    }
+    return true;
+}
+
+// Removes a piece other than a king, or places a random one on an empty
+// square (often refused in the opening: a side has all 16 pieces)
+static void handEdit(ChessBoard &board)
+{
+    Square sq = nextRandom() % 64;
+    PieceCode piece = board.getBackend().pieceAt(sq);
+    if (piece != NO_PIECE)
+    {
+        if (pieceType(piece) != KING)
+            board.removePiece(sq);
+        return;
+    }
+    PieceType type = (PieceType)(nextRandom() % 5); // PAWN .. QUEEN
+    PieceColor color = (PieceColor)(nextRandom() & 1);
+    if (type == PAWN && (sq < 8 || sq >= 56))
+        return;
+    // A side with all its pieces, or all of a type, has no room: nothing may change
+    bool full = board.getBackend().pieceCount(color) >= MAX_PIECES_PER_SIDE ||
+                !materialHasRoom(board.getBackend().materialKey(), makePiece(type, color));
+    HashKey before = board.getPosition().key();
+    board.takeDirtySquares();
+    if (board.placePiece(type, color, sq) == full ||
+        (full && (board.getPosition().key() != before || board.takeDirtySquares() != 0)))
+        fail("random game", "a placement on a full side changed the board", NO_MOVE);
+}
+
+// Sixteen white knights, no king: the material count of a type is a nibble
+static void checkTypeLimit()
+{
+    BoardBackend board;
+    board.clear();
+    board.put(63, makePiece(KING, BLACK));
+    bool ok = true;
+    for (Square sq = 0; sq < 15; sq++)
+    {
+        ok = ok && board.put(sq, makePiece(KNIGHT, WHITE));
+    }
+    MaterialKey before = board.materialKey();
+    HashKey hash = board.pieceHash();
+    ok = ok && !board.put(15, makePiece(KNIGHT, WHITE)) && board.pieceAt(15) == NO_PIECE &&
+         board.materialKey() == before && board.pieceHash() == hash && board.pieceCount(WHITE) == 15 &&
+         materialCount(before, WHITE, KNIGHT) == 15 && materialCount(before, WHITE, BISHOP) == 0 &&
+         board.put(15, makePiece(BISHOP, WHITE)) && materialCount(board.materialKey(), WHITE, KNIGHT) == 15;
+    if (!ok)
+        fail("16 white knights", "a 16th piece of one type was not refused cleanly", NO_MOVE);
+
+    // Through the board too: placing it is refused, the rest still works
+    ChessBoard chess;
+    chess.clearBoard();
+    chess.placePiece(KING, BLACK, 63);
+    for (Square sq = 0; sq < 15; sq++)
+    {
+        chess.placePiece(QUEEN, WHITE, sq);
+    }
+    if (chess.placePiece(QUEEN, WHITE, 15) || !chess.placePiece(QUEEN, WHITE, 0) ||
+        materialCount(chess.getBackend().materialKey(), WHITE, QUEEN) != 15)
+        fail("15 white queens", "ChessBoard placed a 16th queen, or refused a replacement", NO_MOVE);
+}
+
+static void checkGames(int games)
+{
+    uint64_t moves = 0, edits = 0, bad = 0;
+    for (int g = 0; g < games; g++)
+    {
+        ChessBoard board;
+        board.initializeStandardGame();
+        for (int ply = 0; ply < 300 && board.getGameState() == GAME_ACTIVE; ply++)
+        {
+            Position p = board.getPosition();
+            Move list[256];
+            int count = 0;
+            auto collect = [&](Move m)
+            {
+                if (!leavesKingInCheck(p.board, m, p.sideToMove))
+                    list[count++] = m;
+                return false;
+            };
+            generateMoves(p.board, p.sideToMove, p.castlingRights, p.epSquare, collect);
+            if (!count)
+                break;
+            Move m = list[nextRandom() % count];
+
+            // A hand edit can leave the side not to move in check already
+            Square theirKing = p.board.kingSquare(opponent(p.sideToMove));
+            bool checkedBefore = theirKing != NO_SQUARE && p.board.isAttacked(theirKing, p.sideToMove);
+            Position next = p;
+            next.makeMove(m);
+            if (!checkedBefore && board.givesCheck(moveFrom(m), moveTo(m), movePromotion(m)) != next.inCheck())
+            {
+                fail("random game", "ChessBoard::givesCheck() disagrees with the move made", m);
+                bad++;
+            }
+            board.movePiece(m);
+            moves++;
+            if (!attacksMatch(board))
+            {
+                fail("random game", "attack map differs from a rebuilt one after a move", m);
+                bad++;
+            }
+            if (nextRandom() % 16 == 0)
+            {
+                handEdit(board);
+                edits++;
+                if (!attacksMatch(board))
+                {
+                    fail("random game", "attack map differs from a rebuilt one after a hand edit", NO_MOVE);
+                    bad++;
+                }
+            }
+        }
+    }
+    printf("random games:      %d games, %llu moves, %llu hand edits, %llu mismatches\n", games,
+           (unsigned long long)moves, (unsigned long long)edits, (unsigned long long)bad);
+}
+
+int main(int argc, char **argv)
+{
+    int games = argc > 1 ? atoi(argv[1]) : 200;
+    arduinoSerialMuted() = true;
+#if defined(SMARTCHESS_MAILBOX_BACKEND)
+    printf("backend:           mailbox\n");
+#else
+    printf("backend:           bitboard\n");
+#endif
+
+    checkPerft();
+    checkTypeLimit();
+    checkGames(games);
+    printf("%s\n", failures ? "FAILED" : "all checks passed");
+    return failures != 0;
+}
@@ -0,0 +1,285 @@
+// Opening explorer index (OpeningIndex.h): builds the index from PGN
+// archives, answers a query for a position, and benchmarks queries.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++17 -Ihost -I. host/opening_index.cpp host/OpeningIndex.cpp host/Pgn.cpp *.cpp -o opening_index -pthread
+// Usage:
+//   ./opening_index build index.bin [-j threads] [-plies 30] [-run entries=4000000] file.pgn...
+//   ./opening_index query index.bin [move...]
+//   ./opening_index bench index.bin [queries=1000000]
+//
+// build reads the files as pgn_replay does (mmapped, chunks of whole games
+// per thread); -run is the total number of entries the workers buffer
+// between runs. query takes SAN moves from the starting position. bench
+// times lookups of positions picked by walking the index from the start
+// (more played moves picked more often, as an explorer user would), with
+// one query in ten for a position that isn't there.
+
+#include "OpeningIndex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+static uint32_t rngState = 0x2545F491;
+static uint32_t nextRandom()
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+typedef std::chrono::steady_clock Clock;
+
+static double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static uint32_t gamesOf(const OpeningIndexEntry &e)
+{
+    return e.whiteWins + e.draws + e.blackWins;
+}
+
+static int build(int argc, char **argv)
+{
+    const char *indexPath = argv[0];
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    int maxPlies = 30;
+    size_t runSize = 4000000;
+    std::vector<PgnFile> files;
+    uint64_t bytes = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+            threads = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "-plies") == 0 && i + 1 < argc)
+            maxPlies = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-run") == 0 && i + 1 < argc)
+            runSize = strtoull(argv[++i], nullptr, 10);
+        else
+        {
+            files.emplace_back();
+            if (!mapPgnFile(argv[i], files.back()))
+                return 2;
+            bytes += files.back().size;
+        }
+    }
+
+    Clock::time_point start = Clock::now();
+    OpeningIndexWriter writer(indexPath, maxPlies);
+    std::vector<PgnChunk> chunks = pgnChunks(files);
+    std::atomic<size_t> nextChunk(0);
+    std::atomic<uint64_t> games(0), plies(0), unreadable(0);
+    std::atomic<bool> failed(false);
+    size_t perThread = std::max<size_t>(runSize / threads, maxPlies);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++)
+    {
+        workers.emplace_back(
+            [&]()
+            {
+                std::vector<OpeningIndexEntry> buffer;
+                buffer.reserve(perThread + maxPlies);
+                uint64_t myGames = 0, myPlies = 0, myUnreadable = 0;
+                for (size_t c; (c = nextChunk++) < chunks.size();)
+                {
+                    const PgnFile &file = files[chunks[c].file];
+                    PgnReader reader(file.data + chunks[c].begin, chunks[c].end - chunks[c].begin);
+                    PgnGame game;
+                    while (reader.next(game))
+                    {
+                        size_t before = buffer.size();
+                        myGames++;
+                        if (indexGame(game, maxPlies, buffer) < 0)
+                            myUnreadable++;
+                        myPlies += buffer.size() - before;
+                        if (buffer.size() >= perThread && !writer.writeRun(buffer))
+                            failed = true;
+                    }
+                }
+                if (!buffer.empty() && !writer.writeRun(buffer))
+                    failed = true;
+                games += myGames;
+                plies += myPlies;
+                unreadable += myUnreadable;
+            });
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    double runSeconds = secondsSince(start);
+
+    Clock::time_point mergeStart = Clock::now();
+    if (failed || !writer.finish())
+        return 1;
+    double mergeSeconds = secondsSince(mergeStart);
+
+    printf("%llu games (%llu with a move that can't be read, indexed up to it), %llu positions and moves, "
+           "%.0f MB of PGN\n",
+           (unsigned long long)games.load(), (unsigned long long)unreadable.load(),
+           (unsigned long long)plies.load(), bytes / 1e6);
+    printf("read and sort on %d threads: %.2f s, %d runs, %llu entries; merge: %.2f s; total %.2f s, %.0f games/s\n",
+           threads, runSeconds, writer.getRuns(), (unsigned long long)writer.getRunEntries(), mergeSeconds,
+           runSeconds + mergeSeconds, games / (runSeconds + mergeSeconds));
+    printf("%s: %llu entries, %.1f MB\n", indexPath, (unsigned long long)writer.getEntries(),
+           (sizeof(OpeningIndexHeader) + writer.getEntries() * sizeof(OpeningIndexEntry)) / 1e6);
+    return 0;
+}
+
+static int query(int argc, char **argv)
+{
+    OpeningIndex index;
+    if (!index.open(argv[0]))
+        return 2;
+    Position p;
+    p.setStartPosition();
+    for (int i = 1; i < argc; i++)
+    {
+        Move m = parseSan(p, argv[i]);
+        if (m == NO_MOVE)
+        {
+            fprintf(stderr, "%s: not a legal move here\n", argv[i]);
+            return 2;
+        }
+        p.makeMove(m);
+    }
+
+    size_t count;
+    const OpeningIndexEntry *found = index.find(p.key(), count);
+    std::vector<OpeningIndexEntry> moves(found, found + count);
+    std::sort(moves.begin(), moves.end(), [](const OpeningIndexEntry &a, const OpeningIndexEntry &b)
+              { return gamesOf(a) > gamesOf(b); });
+    uint64_t total = 0;
+    for (const OpeningIndexEntry &e : moves)
+    {
+        total += gamesOf(e);
+    }
+    printf("%llu games, %zu moves\n", (unsigned long long)total, moves.size());
+    for (const OpeningIndexEntry &e : moves)
+    {
+        char san[16];
+        formatSan(p, e.move, san);
+        double n = gamesOf(e);
+        printf("  %-8s %9u  %5.1f%%   white %5.1f%%  draw %5.1f%%  black %5.1f%%\n", san, gamesOf(e),
+               100.0 * n / total, 100.0 * e.whiteWins / n, 100.0 * e.draws / n, 100.0 * e.blackWins / n);
+    }
+    return 0;
+}
+
+// A move out of the position, picked in proportion to how often it was played
+static const OpeningIndexEntry *pickPlayed(const OpeningIndexEntry *moves, size_t count)
+{
+    uint64_t total = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        total += gamesOf(moves[i]);
+    }
+    uint64_t pick = total ? ((uint64_t)nextRandom() << 32 | nextRandom()) % total : 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (pick < gamesOf(moves[i]))
+            return &moves[i];
+        pick -= gamesOf(moves[i]);
+    }
+    return &moves[count - 1];
+}
+
+static int bench(int argc, char **argv)
+{
+    OpeningIndex index;
+    if (!index.open(argv[0]))
+        return 2;
+    size_t queries = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+
+    // Positions an explorer user would reach, and some that aren't there
+    std::vector<HashKey> keys;
+    keys.reserve(queries);
+    uint64_t hits = 0;
+    while (keys.size() < queries)
+    {
+        if (keys.size() % 10 == 9)
+        {
+            keys.push_back((HashKey)nextRandom() << 32 | nextRandom());
+            continue;
+        }
+        Position p;
+        p.setStartPosition();
+        int depth = nextRandom() % (index.getMaxPlies() + 1);
+        for (int ply = 0; ply < depth; ply++)
+        {
+            size_t count;
+            const OpeningIndexEntry *moves = index.find(p.key(), count);
+            if (!count)
+                break;
+            p.makeMove(pickPlayed(moves, count)->move);
+        }
+        keys.push_back(p.key());
+    }
+
+    // Throughput with nothing else in the loop
+    uint64_t entries = 0;
+    Clock::time_point start = Clock::now();
+    for (HashKey key : keys)
+    {
+        size_t count;
+        index.find(key, count);
+        entries += count;
+        hits += count != 0;
+    }
+    double seconds = secondsSince(start);
+
+    // Latency of each query, binary search plus the range scan, including
+    // reading the counts as the explorer would
+    std::vector<double> nanos(keys.size());
+    uint64_t games = 0;
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        Clock::time_point t = Clock::now();
+        size_t count;
+        const OpeningIndexEntry *moves = index.find(keys[i], count);
+        for (size_t m = 0; m < count; m++)
+        {
+            games += gamesOf(moves[m]);
+        }
+        nanos[i] = std::chrono::duration<double, std::nano>(Clock::now() - t).count();
+    }
+    std::sort(nanos.begin(), nanos.end());
+    double mean = 0;
+    for (double ns : nanos)
+    {
+        mean += ns;
+    }
+    mean /= nanos.size();
+
+    printf("%llu entries (%.1f MB); %zu queries, %llu found, %.1f moves per position found\n",
+           (unsigned long long)index.size(), index.size() * sizeof(OpeningIndexEntry) / 1e6, keys.size(),
+           (unsigned long long)hits, hits ? (double)entries / hits : 0.0);
+    printf("%.2f M queries/s (%.0f ns each); one at a time: mean %.0f ns, median %.0f, p99 %.0f, max %.0f "
+           "(%llu games summed)\n",
+           keys.size() / seconds / 1e6, seconds * 1e9 / keys.size(), mean, nanos[nanos.size() / 2],
+           nanos[nanos.size() * 99 / 100], nanos.back(), (unsigned long long)games);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc >= 3 && strcmp(argv[1], "build") == 0)
+        return build(argc - 2, argv + 2);
+    if (argc >= 3 && strcmp(argv[1], "query") == 0)
+        return query(argc - 2, argv + 2);
+    if (argc >= 3 && strcmp(argv[1], "bench") == 0)
+        return bench(argc - 2, argv + 2);
+    fprintf(stderr, "usage: %s build index.bin [-j threads] [-plies 30] [-run entries] file.pgn...\n"
+                    "       %s query index.bin [move...]\n"
+                    "       %s bench index.bin [queries]\n",
+            argv[0], argv[0], argv[0]);
+    return 2;
+}
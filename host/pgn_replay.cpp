@@ -0,0 +1,392 @@
+// Archive audit: replays every game of the given PGN files and reports
+// where a game departs from the rules or from its recorded result. Files
+// are mmapped and parsed in place (Pgn.h); the buffer is cut into chunks at
+// game boundaries and worker threads take chunks as they go. Moves are
+// played on a copied Position (Position::makeMove), with no ChessBoard,
+// Serial output or per-move game-state update.
+//
+// A game diverges when:
+//   - a move can't be read, is illegal or is ambiguous (or the FEN tag is bad)
+//   - a move's check mark ("+", "#") doesn't match the position it leads to
+//   - it ends in checkmate or stalemate and the recorded result says otherwise
+// Other results (resignations, agreed draws, flags) can't be checked from
+// the moves and are accepted.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++17 -Ihost -I. host/pgn_replay.cpp host/Pgn.cpp *.cpp -o pgn_replay -pthread
+// Usage:
+//   ./pgn_replay [-j threads] [-baseline games] file.pgn...
+//   ./pgn_replay -write games file.pgn
+// -baseline also replays the first games through ChessBoard::movePiece()
+// (Serial muted) and with this tool's path on one thread, for comparison.
+// -write makes a corpus of random games to try it on; one game in a
+// thousand is corrupted on purpose, and the count is printed.
+
+#include "Pgn.h"
+#include "ChessBoard.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static uint32_t rngState = 0x2545F491;
+static uint32_t nextRandom()
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+enum DivergenceKind
+{
+    DIVERGE_MOVE,
+    DIVERGE_CHECK_MARK,
+    DIVERGE_RESULT,
+    DIVERGE_KINDS
+};
+
+static const char *const KIND_NAMES[DIVERGE_KINDS] = {"bad move", "wrong check mark", "wrong result"};
+
+struct Divergence
+{
+    int file;
+    size_t offset; // of the game in its file
+    int ply;       // 1-based; 0 for the setup, plies + 1 for the result
+    DivergenceKind kind;
+    std::string text;
+};
+
+struct Tally
+{
+    uint64_t games = 0, plies = 0, divergentGames = 0;
+    uint64_t kinds[DIVERGE_KINDS] = {};
+    std::vector<Divergence> divergences; // the first few
+};
+
+#define MAX_REPORTED 1000
+
+static void diverge(Tally &tally, int file, size_t offset, int ply, DivergenceKind kind, std::string_view text)
+{
+    tally.kinds[kind]++;
+    if (tally.divergences.size() < MAX_REPORTED)
+        tally.divergences.push_back({file, offset, ply, kind, std::string(text)});
+}
+
+// Replays one game; false if it diverged
+static bool replayGame(const PgnGame &game, int file, size_t offset, Tally &tally)
+{
+    tally.games++;
+    Position p;
+    if (game.fen.empty())
+        p.setStartPosition();
+    else if (!p.setFromFen(std::string(game.fen).c_str()))
+    {
+        diverge(tally, file, offset, 0, DIVERGE_MOVE, game.fen);
+        return false;
+    }
+
+    size_t cursor = 0;
+    std::string_view san;
+    int ply = 0;
+    while (nextSan(game.movetext, cursor, san))
+    {
+        ply++;
+        Move m = parseSan(p, san);
+        if (m == NO_MOVE)
+        {
+            diverge(tally, file, offset, ply, DIVERGE_MOVE, san);
+            tally.plies += ply - 1;
+            return false;
+        }
+        p.makeMove(m);
+        char mark = p.inCheck() ? (p.hasLegalMove() ? '+' : '#') : 0;
+        if (mark != sanCheckMark(san))
+        {
+            diverge(tally, file, offset, ply, DIVERGE_CHECK_MARK, san);
+            tally.plies += ply;
+            return false;
+        }
+    }
+    tally.plies += ply;
+
+    if (!p.hasLegalMove())
+    {
+        PgnResult ended = !p.inCheck() ? PGN_DRAWN : p.sideToMove == WHITE ? PGN_BLACK_WINS : PGN_WHITE_WINS;
+        if (game.result != ended)
+        {
+            diverge(tally, file, offset, ply + 1, DIVERGE_RESULT, pgnResultText(game.result));
+            return false;
+        }
+    }
+    return true;
+}
+
+static void replayChunk(const PgnFile &file, const PgnChunk &chunk, Tally &tally)
+{
+    PgnReader reader(file.data + chunk.begin, chunk.end - chunk.begin);
+    PgnGame game;
+    while (reader.next(game))
+    {
+        if (!replayGame(game, chunk.file, chunk.begin + game.offset, tally))
+            tally.divergentGames++;
+    }
+}
+
+// The same games through the sketch's ChessBoard, one at a time
+static double baselineSeconds(const PgnFile &file, uint64_t games, uint64_t &plies)
+{
+    ChessBoard board;
+    arduinoSerialMuted() = true;
+    PgnReader reader(file.data, file.size);
+    PgnGame game;
+    plies = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t g = 0; g < games && reader.next(game); g++)
+    {
+        board.initializeStandardGame();
+        if (!game.fen.empty())
+        {
+            Position setup;
+            setup.setFromFen(std::string(game.fen).c_str());
+            board.setPosition(setup);
+        }
+        size_t cursor = 0;
+        std::string_view san;
+        while (nextSan(game.movetext, cursor, san))
+        {
+            Move m = parseSan(board.getPosition(), san);
+            if (m == NO_MOVE || !board.movePiece(m))
+                break;
+            plies++;
+        }
+    }
+    double seconds = secondsSince(start);
+    arduinoSerialMuted() = false;
+    return seconds;
+}
+
+// --- Random corpus ---
+
+static Move randomLegalMove(const Position &p)
+{
+    Move moves[256];
+    int count = 0;
+    auto collect = [&](Move m)
+    {
+        if (!leavesKingInCheck(p.board, m, p.sideToMove))
+            moves[count++] = m;
+        return false;
+    };
+    generateMoves(p.board, p.sideToMove, p.castlingRights, p.epSquare, collect);
+    return count ? moves[nextRandom() % count] : NO_MOVE;
+}
+
+static int writeCorpus(uint64_t games, const char *path)
+{
+    FILE *out = fopen(path, "w");
+    if (!out)
+    {
+        perror(path);
+        return 1;
+    }
+    uint64_t corrupted = 0;
+    std::vector<std::string> moves;
+    for (uint64_t g = 0; g < games; g++)
+    {
+        Position p;
+        p.setStartPosition();
+        moves.clear();
+        PgnResult result;
+        for (;;)
+        {
+            Move m = randomLegalMove(p);
+            if (m == NO_MOVE)
+            {
+                result = !p.inCheck() ? PGN_DRAWN : p.sideToMove == WHITE ? PGN_BLACK_WINS : PGN_WHITE_WINS;
+                break;
+            }
+            if (p.halfMoveClock >= 100)
+            {
+                result = PGN_DRAWN;
+                break;
+            }
+            if (moves.size() >= 200)
+            {
+                result = (PgnResult)(nextRandom() % 3); // resigned, or agreed
+                break;
+            }
+            char san[16];
+            formatSan(p, m, san);
+            moves.push_back(san);
+            p.makeMove(m);
+        }
+
+        // One game in a thousand: a wrong check mark, or a mate's result reversed
+        if (nextRandom() % 1000 == 0 && !moves.empty())
+        {
+            corrupted++;
+            if (result != PGN_DRAWN && !p.hasLegalMove())
+                result = result == PGN_WHITE_WINS ? PGN_BLACK_WINS : PGN_WHITE_WINS;
+            else
+            {
+                std::string &san = moves[nextRandom() % moves.size()];
+                if (sanCheckMark(san))
+                    san.pop_back();
+                else
+                    san += '+';
+            }
+        }
+
+        fprintf(out, "[Event \"Random game\"]\n[Round \"%llu\"]\n[Result \"%s\"]\n\n", (unsigned long long)g + 1,
+                pgnResultText(result));
+        int column = 0;
+        for (size_t i = 0; i < moves.size(); i++)
+        {
+            char text[32];
+            int n = i % 2 == 0 ? snprintf(text, sizeof(text), "%zu. %s", i / 2 + 1, moves[i].c_str())
+                               : snprintf(text, sizeof(text), "%s", moves[i].c_str());
+            if (column + n + 1 > 79)
+            {
+                fputc('\n', out);
+                column = 0;
+            }
+            else if (column)
+            {
+                fputc(' ', out);
+                column++;
+            }
+            fputs(text, out);
+            column += n;
+        }
+        fprintf(out, "%s%s\n\n", column ? " " : "", pgnResultText(result));
+    }
+    fclose(out);
+    printf("wrote %llu games to %s, %llu of them corrupted\n", (unsigned long long)games, path,
+           (unsigned long long)corrupted);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t baselineGames = 0;
+    std::vector<const char *> paths;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-write") == 0 && i + 2 < argc)
+            return writeCorpus(strtoull(argv[i + 1], nullptr, 10), argv[i + 2]);
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+            threads = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "-baseline") == 0 && i + 1 < argc)
+            baselineGames = strtoull(argv[++i], nullptr, 10);
+        else
+            paths.push_back(argv[i]);
+    }
+    if (paths.empty())
+    {
+        fprintf(stderr, "usage: %s [-j threads] [-baseline games] file.pgn...\n"
+                        "       %s -write games file.pgn\n",
+                argv[0], argv[0]);
+        return 2;
+    }
+
+    std::vector<PgnFile> files(paths.size());
+    uint64_t bytes = 0;
+    for (size_t f = 0; f < paths.size(); f++)
+    {
+        if (!mapPgnFile(paths[f], files[f]))
+            return 2;
+        bytes += files[f].size;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<PgnChunk> chunks = pgnChunks(files);
+    std::vector<Tally> tallies(threads);
+    std::atomic<size_t> nextChunk(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++)
+    {
+        workers.emplace_back(
+            [&, t]()
+            {
+                for (size_t c; (c = nextChunk++) < chunks.size();)
+                {
+                    replayChunk(files[chunks[c].file], chunks[c], tallies[t]);
+                }
+            });
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    double seconds = secondsSince(start);
+
+    Tally total;
+    for (Tally &tally : tallies)
+    {
+        total.games += tally.games;
+        total.plies += tally.plies;
+        total.divergentGames += tally.divergentGames;
+        for (int k = 0; k < DIVERGE_KINDS; k++)
+        {
+            total.kinds[k] += tally.kinds[k];
+        }
+        total.divergences.insert(total.divergences.end(), tally.divergences.begin(), tally.divergences.end());
+    }
+    std::sort(total.divergences.begin(), total.divergences.end(), [](const Divergence &a, const Divergence &b)
+              { return a.file != b.file ? a.file < b.file : a.offset < b.offset; });
+
+    for (size_t i = 0; i < total.divergences.size() && i < 20; i++)
+    {
+        const Divergence &d = total.divergences[i];
+        printf("%s, game at byte %zu, ply %d: %s \"%s\"\n", paths[d.file], d.offset, d.ply, KIND_NAMES[d.kind],
+               d.text.c_str());
+    }
+    if (total.divergences.size() > 20)
+        printf("...\n");
+    printf("%llu games, %llu plies in %.2f s on %d threads: %.0f games/s, %.1f M plies/s, %.0f MB/s\n",
+           (unsigned long long)total.games, (unsigned long long)total.plies, seconds, threads, total.games / seconds,
+           total.plies / seconds / 1e6, bytes / seconds / 1e6);
+    printf("%llu games diverge:", (unsigned long long)total.divergentGames);
+    for (int k = 0; k < DIVERGE_KINDS; k++)
+    {
+        printf(" %llu %s%s", (unsigned long long)total.kinds[k], KIND_NAMES[k], k + 1 < DIVERGE_KINDS ? "," : "\n");
+    }
+
+    if (baselineGames)
+    {
+        uint64_t plies = 0;
+        double board = baselineSeconds(files[0], baselineGames, plies);
+        Tally one;
+        PgnReader reader(files[0].data, files[0].size);
+        PgnGame game;
+        auto oneStart = std::chrono::steady_clock::now();
+        for (uint64_t g = 0; g < baselineGames && reader.next(game); g++)
+        {
+            replayGame(game, 0, game.offset, one);
+        }
+        double fast = secondsSince(oneStart);
+        printf("first %llu games, one thread: ChessBoard::movePiece %.0f games/s (%llu plies), this replay %.0f "
+               "games/s: %.1fx\n",
+               (unsigned long long)one.games, one.games / board, (unsigned long long)plies, one.games / fast,
+               board / fast);
+    }
+    return total.divergentGames ? 1 : 0;
+}
@@ -0,0 +1,149 @@
+// Pondering benchmark: the board plays games against a scripted opponent
+// and times its reply once the opponent's move is in, with and without
+// pondering on the opponent's time.
+//
+// Each game is played once without pondering; the pondering run then
+// replays the same moves on both sides, so the two modes time the board on
+// the same positions. The opponent is the same search one ply shallower
+// with its own table, so it often (not always) plays the reply the board
+// expects; its think time is what the board gets to ponder.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++17 -Ihost -I. host/ponder_bench.cpp *.cpp -o ponder_bench
+// add -DSMARTCHESS_MAILBOX_BACKEND -DTT_ENTRIES=64 for the AVR's backend and
+// table size.
+// Usage:
+//   ./ponder_bench [depth=4] [opponent think ms=100] [moves per game=16]
+
+#include "Search.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static const char *openings[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+    "rnbqkb1r/pp2pppp/3p1n2/8/3NP3/8/PPP2PPP/RNBQKB1R w KQkq - 1 5",
+    "rnbqkbnr/pp3ppp/4p3/2ppP3/3P4/8/PPP2PPP/RNBQKBNR w KQkq - 0 4",
+};
+
+static TranspositionTable boardTable;
+static TranspositionTable opponentTable;
+
+struct ModeResult
+{
+    std::vector<double> responseMs;
+    int ponders = 0;
+    int hits = 0;
+    int expectations = 0; // ponders with a predicted reply
+};
+
+static Move think(Search &search, const Position &position, uint8_t depth)
+{
+    search.startHint(position, 0xFFFFFFFF, depth);
+    while (search.pollHint() == HINT_THINKING)
+    {
+    }
+    return search.bestMove();
+}
+
+struct GameMove
+{
+    Move board;
+    Move reply;
+};
+
+// Times the board's reply to every opponent move. Without pondering the
+// game is played out and recorded; with it, the recorded game is replayed.
+static void playGame(const char *fen, bool ponder, uint8_t depth, double opponentMs, int moves,
+                     std::vector<GameMove> &game, ModeResult &result)
+{
+    Search board(boardTable);
+    Search opponent(opponentTable);
+    boardTable.clear();
+    opponentTable.clear();
+
+    Position position;
+    position.setFromFen(fen);
+    if (!ponder)
+    {
+        game.clear();
+        Move m = think(board, position, depth);
+        for (int i = 0; i < moves && m != NO_MOVE; i++)
+        {
+            Position after = position;
+            after.makeMove(m);
+            Move reply = think(opponent, after, depth - 1);
+            if (reply == NO_MOVE)
+                break;
+            game.push_back({m, reply});
+            position = after;
+            position.makeMove(reply);
+
+            Clock::time_point start = Clock::now();
+            m = think(board, position, depth);
+            result.responseMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+        return;
+    }
+
+    think(board, position, depth);
+    for (const GameMove &move : game)
+    {
+        position.makeMove(move.board);
+        board.startPonder(position);
+        result.ponders++;
+        result.expectations += board.ponderMove() != NO_MOVE;
+        Clock::time_point until = Clock::now() + std::chrono::microseconds((long)(opponentMs * 1000));
+        while (Clock::now() < until)
+            board.pollHint();
+        position.makeMove(move.reply);
+
+        Clock::time_point start = Clock::now();
+        result.hits += board.ponderHit(position, 0xFFFFFFFF, depth);
+        while (board.pollHint() == HINT_THINKING)
+        {
+        }
+        result.responseMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+}
+
+static void report(const char *mode, ModeResult &result)
+{
+    std::vector<double> &ms = result.responseMs;
+    std::sort(ms.begin(), ms.end());
+    double total = 0;
+    for (double t : ms)
+        total += t;
+    printf("%-10s %6zu %9.2f %9.2f %9.2f %9.2f", mode, ms.size(), total / ms.size(), ms[ms.size() / 2],
+           ms[ms.size() * 9 / 10], ms.back());
+    if (result.ponders)
+        printf("   %d/%d hits, %d predicted", result.hits, result.ponders, result.expectations);
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    uint8_t depth = argc > 1 ? atoi(argv[1]) : 4;
+    double opponentMs = argc > 2 ? atof(argv[2]) : 100;
+    int moves = argc > 3 ? atoi(argv[3]) : 16;
+
+    ModeResult plain, pondering;
+    std::vector<GameMove> game;
+    for (const char *fen : openings)
+    {
+        playGame(fen, false, depth, opponentMs, moves, game, plain);
+        playGame(fen, true, depth, opponentMs, moves, game, pondering);
+    }
+
+    printf("depth %u, opponent thinks %.0f ms; response times in ms\n", depth, opponentMs);
+    printf("%-10s %6s %9s %9s %9s %9s\n", "mode", "moves", "mean", "median", "p90", "max");
+    report("no ponder", plain);
+    report("ponder", pondering);
+    return 0;
+}
@@ -0,0 +1,187 @@
+// Binary protocol check and throughput: random games are played through
+// movePiece() and sent as the board would (a position at the start and
+// every few plies, then per move MSG_MOVE, MSG_STATE and MSG_LEGAL_MOVES).
+// The stream is decoded in 64-byte reads into a GameMirror, which must
+// follow every position exactly; then again with random bit errors, where
+// the mirror may lose step but must never silently diverge. Reports bytes
+// per move against printBoard() text and the decoder's throughput.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++17 -Ihost -I. host/protocol_bench.cpp host/ProtocolDecoder.cpp *.cpp -o protocol_bench
+// Usage:
+//   ./protocol_bench [games=500] [plies between positions=16] [bit errors per byte=0.0001]
+
+#include "ChessBoard.h"
+#include "Protocol.h"
+#include "ProtocolDecoder.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// printBoard() on the device: 8 ranks of "n " plus 8 "x " and CR LF, then
+// "  A B C D E F G H" and CR LF
+#define PRINT_BOARD_BYTES (8 * 20 + 19)
+
+static uint32_t rngState = 0x2545F491;
+static uint32_t nextRandom()
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+static Move randomLegalMove(const Position &p)
+{
+    Move moves[256];
+    int count = 0;
+    auto collect = [&](Move m)
+    {
+        if (!leavesKingInCheck(p.board, m, p.sideToMove))
+            moves[count++] = m;
+        return false;
+    };
+    generateMoves(p.board, p.sideToMove, p.castlingRights, p.epSquare, collect);
+    return count ? moves[nextRandom() % count] : NO_MOVE;
+}
+
+struct Stream
+{
+    std::vector<uint8_t> bytes;
+    std::vector<HashKey> keys; // the board's position after each frame
+    ProtocolEncoder encoder;
+
+    void take(ChessBoard &board)
+    {
+        bytes.insert(bytes.end(), encoder.data(), encoder.data() + encoder.size());
+        keys.push_back(board.getPosition().key());
+    }
+};
+
+struct DecodeResult
+{
+    double seconds;
+    uint64_t frames, badFrames, missedFrames, mismatches, skippedMoves, movesApplied, diverged;
+};
+
+// Decodes as the app would; checks the mirror against the board after every
+// frame it is in step for. Frame numbers count on from the sequence numbers.
+static DecodeResult decode(const std::vector<uint8_t> &bytes, const std::vector<HashKey> &keys)
+{
+    DecodeResult result = {};
+    ProtocolDecoder decoder;
+    GameMirror mirror;
+    int64_t index = -1;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t at = 0; at < bytes.size(); at += 64)
+    {
+        decoder.feed(bytes.data() + at, bytes.size() - at < 64 ? bytes.size() - at : 64);
+        ProtocolFrame frame;
+        while (decoder.next(frame))
+        {
+            index += 1 + frame.missed;
+            bool applied = mirror.apply(frame);
+            if (applied && frame.type == MSG_MOVE)
+                result.movesApplied++;
+            if (mirror.isSynced() && (index >= (int64_t)keys.size() || mirror.getPosition().key() != keys[index]))
+                result.diverged++;
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.frames = decoder.getFrames();
+    result.badFrames = decoder.getBadFrames();
+    result.missedFrames = decoder.getMissedFrames();
+    result.mismatches = mirror.getMismatches();
+    result.skippedMoves = mirror.getSkippedMoves();
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    int games = argc > 1 ? atoi(argv[1]) : 500;
+    int keyframe = argc > 2 ? atoi(argv[2]) : 16;
+    double errorRate = argc > 3 ? atof(argv[3]) : 0.0001;
+    arduinoSerialMuted() = true;
+
+    // Device side
+    ChessBoard board;
+    Stream stream;
+    uint64_t moves = 0, moveBytes = 0, stateBytes = 0, legalBytes = 0, positionBytes = 0, frames = 0;
+    double encodeSeconds = 0;
+    for (int g = 0; g < games; g++)
+    {
+        board.initializeStandardGame();
+        stream.encoder.position(board.getPosition());
+        stream.take(board);
+        positionBytes += stream.encoder.size();
+        frames++;
+        for (int ply = 1; ply <= 300 && board.getGameState() == GAME_ACTIVE; ply++)
+        {
+            board.movePiece(randomLegalMove(board.getPosition()));
+            moves++;
+
+            auto start = std::chrono::steady_clock::now();
+            stream.encoder.move(board.getLastMove(), board.getPosition());
+            uint8_t moveSize = stream.encoder.size();
+            stream.take(board);
+            stream.encoder.state(board.getGameState(), board.getPosition());
+            uint8_t stateSize = stream.encoder.size();
+            stream.take(board);
+            stream.encoder.legalMoves(board.getPosition());
+            uint8_t legalSize = stream.encoder.size();
+            stream.take(board);
+            frames += 3;
+            if (ply % keyframe == 0)
+            {
+                stream.encoder.position(board.getPosition());
+                positionBytes += stream.encoder.size();
+                stream.take(board);
+                frames++;
+            }
+            encodeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            moveBytes += moveSize;
+            stateBytes += stateSize;
+            legalBytes += legalSize;
+        }
+    }
+
+    // 9600 baud, 8N1: 960 bytes a second
+    double perMove = (double)(moveBytes + stateBytes) / moves;
+    printf("%d games, %llu moves, %llu frames, %zu bytes\n", games, (unsigned long long)moves,
+           (unsigned long long)frames, stream.bytes.size());
+    printf("per move: printBoard %d bytes (%.0f ms at 9600 baud); move + state %.1f bytes (%.1f ms), "
+           "legal moves %.1f more, positions %.1f more\n",
+           PRINT_BOARD_BYTES, PRINT_BOARD_BYTES / 0.96, perMove, perMove / 0.96, (double)legalBytes / moves,
+           (double)positionBytes / moves);
+    printf("encode: %.2f us per move (host)\n", encodeSeconds * 1e6 / moves);
+
+    bool passed = true;
+    DecodeResult clean = decode(stream.bytes, stream.keys);
+    bool cleanOk = clean.frames == frames && !clean.badFrames && !clean.missedFrames && !clean.mismatches &&
+                   !clean.diverged && clean.movesApplied == moves;
+    passed = passed && cleanOk;
+    printf("decode: %.1f MB/s, %.2f M frames/s; %llu frames, %llu moves followed%s\n",
+           stream.bytes.size() / clean.seconds / 1e6, clean.frames / clean.seconds / 1e6,
+           (unsigned long long)clean.frames, (unsigned long long)clean.movesApplied, cleanOk ? "" : "  FAILED");
+
+    std::vector<uint8_t> noisy = stream.bytes;
+    uint64_t flipped = 0;
+    for (size_t i = 0; i < noisy.size(); i++)
+    {
+        if (nextRandom() < errorRate * 4294967296.0)
+        {
+            noisy[i] ^= 1 << (nextRandom() & 7);
+            flipped++;
+        }
+    }
+    DecodeResult dirty = decode(noisy, stream.keys);
+    passed = passed && !dirty.diverged;
+    printf("with %llu bit errors: %llu bad frames, %llu frames lost, %llu moves not matching, %llu skipped until "
+           "the next position, %.2f%% of moves followed, diverged silently: %llu%s\n",
+           (unsigned long long)flipped, (unsigned long long)dirty.badFrames, (unsigned long long)dirty.missedFrames,
+           (unsigned long long)dirty.mismatches, (unsigned long long)dirty.skippedMoves,
+           100.0 * dirty.movesApplied / moves, (unsigned long long)dirty.diverged, dirty.diverged ? "  FAILED" : "");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,261 @@
+// Sensor driver check against simulated switches. Three threads play the
+// parts: a timer calling scanRow() every SENSOR_ROW_MICROS (the ISR), a
+// player lifting and placing pieces for random games with contact bounce,
+// and loop() draining events while it stalls now and then as a slow
+// movePiece() would. Every lift and place must arrive once, in order, with
+// no event for a bounce or a blip; occupancy() must end equal to the
+// switches. A last phase stalls loop() through a burst bigger than the
+// queue: the overflow must be reported and occupancy() must resynchronise.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++17 -DSMARTCHESS_SENSOR_BOARD -Ihost -I. host/sensor_bench.cpp *.cpp -o sensor_bench -pthread
+// Usage:
+//   ./sensor_bench [games=3] [plies per game=40] [stall ms=200]
+
+#include "SensorMatrix.h"
+#include "Position.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static uint32_t rngState = 0x2545F491;
+static uint32_t nextRandom()
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+static Move randomLegalMove(const Position &p)
+{
+    Move moves[256];
+    int count = 0;
+    auto collect = [&](Move m)
+    {
+        if (!leavesKingInCheck(p.board, m, p.sideToMove))
+            moves[count++] = m;
+        return false;
+    };
+    generateMoves(p.board, p.sideToMove, p.castlingRights, p.epSquare, collect);
+    return count ? moves[nextRandom() % count] : NO_MOVE;
+}
+
+static uint64_t occupiedSquares(const Position &p)
+{
+    uint64_t bits = 0;
+    for (Square sq = 0; sq < 64; sq++)
+    {
+        if (p.board.pieceAt(sq) != NO_PIECE)
+            bits |= 1ULL << sq;
+    }
+    return bits;
+}
+
+struct Action
+{
+    Square square;
+    bool placed;
+};
+
+// What a player's hands do for a move: captured piece off first, castling
+// king before rook
+static void movesToActions(Position &p, Move m, std::vector<Action> &actions)
+{
+    Square from = moveFrom(m), to = moveTo(m);
+    if (moveFlag(m) == MOVE_EN_PASSANT)
+        actions.push_back({enPassantVictim(m), false});
+    else if (moveFlag(m) != MOVE_CASTLING && p.board.pieceAt(to) != NO_PIECE)
+        actions.push_back({to, false});
+    actions.push_back({from, false});
+    actions.push_back({to, true});
+    if (moveFlag(m) == MOVE_CASTLING)
+    {
+        bool kingSide = (to & 7) == 6;
+        Square rank = from & 0x38;
+        actions.push_back({(Square)(rank + (kingSide ? 7 : 0)), false});
+        actions.push_back({(Square)(rank + (kingSide ? 5 : 3)), true});
+    }
+    p.makeMove(m);
+}
+
+static std::atomic<bool> timerRunning;
+static uint32_t tickMicros = SENSOR_ROW_MICROS;
+
+static void timerThread()
+{
+    Clock::time_point next = Clock::now();
+    while (timerRunning.load())
+    {
+        sensors.scanRow();
+        next += std::chrono::microseconds(tickMicros);
+        std::this_thread::sleep_until(next);
+    }
+}
+
+static void sleepMs(double ms)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds((long)(ms * 1000)));
+}
+
+static const double scanMs = 8 * SENSOR_ROW_MICROS / 1000.0;
+
+// Sets one switch with bounce: a few flickers shorter than a scan first
+static void touch(uint64_t &closed, Square sq, bool placed)
+{
+    int bounces = nextRandom() % 4;
+    for (int b = 0; b < bounces; b++)
+    {
+        sensors.setSwitches(closed ^ (1ULL << sq));
+        sleepMs(0.3);
+        sensors.setSwitches(closed);
+        sleepMs(0.3);
+    }
+    closed = placed ? closed | (1ULL << sq) : closed & ~(1ULL << sq);
+    sensors.setSwitches(closed);
+}
+
+struct Received
+{
+    SensorEvent event;
+    Clock::time_point at;
+};
+
+int main(int argc, char **argv)
+{
+    int games = argc > 1 ? atoi(argv[1]) : 3;
+    int plies = argc > 2 ? atoi(argv[2]) : 40;
+    double stallMs = argc > 3 ? atof(argv[3]) : 200;
+    bool passed = true;
+
+    Position start;
+    start.setStartPosition();
+    uint64_t closed = occupiedSquares(start);
+    sensors.setSwitches(closed);
+    sensors.begin();
+    timerRunning = true;
+    std::thread timer(timerThread);
+
+    // Phase 1: games, with loop() stalling after some events
+    std::vector<Action> expected;
+    std::vector<Clock::time_point> actedAt;
+    std::vector<Received> received;
+    std::atomic<bool> playing(true);
+    uint8_t deepest = 0;
+    std::thread player(
+        [&]()
+        {
+            for (int g = 0; g < games; g++)
+            {
+                Position p = start;
+                for (int i = 0; i < plies; i++)
+                {
+                    Move m = randomLegalMove(p);
+                    if (m == NO_MOVE)
+                        break;
+                    size_t first = expected.size();
+                    movesToActions(p, m, expected);
+                    for (size_t a = first; a < expected.size(); a++)
+                    {
+                        touch(closed, expected[a].square, expected[a].placed);
+                        actedAt.push_back(Clock::now());
+                        // A hand takes a while; longer than the debounce
+                        sleepMs(5 * scanMs + nextRandom() % 20);
+                    }
+                    // A blip: one scan's worth of a lifted piece is bounce
+                    Square blip = moveTo(m);
+                    sensors.setSwitches(closed ^ (1ULL << blip));
+                    sleepMs(scanMs);
+                    sensors.setSwitches(closed);
+                    sleepMs(2 * scanMs);
+                }
+                // Back to the start position, as a player resetting the board
+                uint64_t target = occupiedSquares(start);
+                for (Square sq = 0; sq < 64; sq++)
+                {
+                    if (((closed ^ target) >> sq) & 1)
+                    {
+                        expected.push_back({sq, (bool)((target >> sq) & 1)});
+                        touch(closed, sq, (target >> sq) & 1);
+                        actedAt.push_back(Clock::now());
+                        sleepMs(5 * scanMs);
+                    }
+                }
+            }
+            sleepMs(10 * scanMs);
+            playing = false;
+        });
+
+    int sinceStall = 0;
+    while (playing.load() || sensors.pending())
+    {
+        deepest = std::max(deepest, sensors.pending());
+        SensorEvent event;
+        if (sensors.poll(event))
+        {
+            received.push_back({event, Clock::now()});
+            // Every few events, a slow validation
+            if (++sinceStall == 5)
+            {
+                sinceStall = 0;
+                sleepMs(stallMs);
+            }
+        }
+        else
+        {
+            sleepMs(0.2);
+        }
+    }
+    player.join();
+
+    size_t matched = 0;
+    double totalLatency = 0, worstLatency = 0;
+    for (; matched < expected.size() && matched < received.size(); matched++)
+    {
+        const SensorEvent &e = received[matched].event;
+        if (e.square != expected[matched].square || e.placed != expected[matched].placed)
+            break;
+        double ms = std::chrono::duration<double, std::milli>(received[matched].at - actedAt[matched]).count();
+        totalLatency += ms;
+        worstLatency = std::max(worstLatency, ms);
+    }
+    bool overflowed = sensors.takeOverflow();
+    bool inOrder = matched == expected.size() && received.size() == expected.size();
+    bool settled = sensors.occupancy() == sensors.switches();
+    passed = passed && inOrder && settled && !overflowed;
+    printf("events: %zu expected, %zu received, %zu in order%s\n", expected.size(), received.size(), matched,
+           inOrder ? "" : "  FAILED");
+    printf("latency action -> loop(): mean %.1f ms, max %.1f ms (debounce %.0f ms, stalls %.0f ms)\n",
+           matched ? totalLatency / matched : 0.0, worstLatency, 4 * scanMs, stallMs);
+    printf("deepest queue: %u of %d, overflow: %s, occupancy matches switches: %s\n", deepest, SENSOR_QUEUE_SIZE,
+           overflowed ? "yes  FAILED" : "no", settled ? "yes" : "no  FAILED");
+
+    // Phase 2: loop() away while the board is cleared and set up again
+    uint64_t setUp = closed;
+    closed = 0;
+    sensors.setSwitches(0);
+    sleepMs(10 * scanMs);
+    closed = setUp;
+    sensors.setSwitches(setUp);
+    sleepMs(10 * scanMs);
+    bool reported = sensors.takeOverflow();
+    bool resynced = sensors.occupancy() == setUp;
+    SensorEvent stale;
+    while (sensors.poll(stale))
+    {
+    }
+    passed = passed && reported && resynced;
+    printf("burst of %d changes with loop() stalled: overflow reported: %s, occupancy resynchronised: %s\n",
+           2 * __builtin_popcountll(setUp), reported ? "yes" : "no  FAILED", resynced ? "yes" : "no  FAILED");
+
+    timerRunning = false;
+    timer.join();
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+// Time-slicing benchmark for the hint search: the same fixed-depth search
+// run in one piece and in slices of N nodes or M microseconds, the way
+// loop() interleaves it with the sensor scan. Reports what slicing costs
+// (extra time per slice) and the sensor polling period it leaves, and
+// checks that the sliced search visits exactly the same nodes.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++17 -Ihost -I. host/slice_bench.cpp *.cpp -o slice_bench
+// add -DSMARTCHESS_MAILBOX_BACKEND -DTT_ENTRIES=64 for the AVR's backend and
+// table size.
+// Usage:
+//   ./slice_bench [depth=5] [runs=3]
+//
+// On the AVR, per-node time is roughly 100x the host's: scale a slice's
+// node count accordingly to get the same polling period there.
+
+#include "Search.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+typedef std::chrono::steady_clock Clock;
+
+struct SliceCase
+{
+    const char *name;
+    const char *fen;
+};
+
+static const SliceCase cases[] = {
+    {"opening", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"},
+    {"italian", "r1bqk2r/pppp1ppp/2n2n2/2b1p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4"},
+    {"hanging queen", "rnb1kbnr/pppp1ppp/8/4p1q1/3P4/2N5/PPP1PPPP/R1BQKBNR w KQkq - 0 3"},
+    {"rook endgame", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"},
+};
+
+struct SliceConfig
+{
+    uint32_t nodes;
+    uint32_t micros;
+};
+
+static const SliceConfig configs[] = {
+    {0, 0}, // one piece: the reference
+    {64, 0},
+    {256, 0},
+    {1024, 0},
+    {4096, 0},
+    {0, 250},
+    {0, 1000},
+    {0, 5000},
+};
+
+struct SliceRun
+{
+    double ms;
+    int slices;
+    double meanGapUs; // between sensor scans
+    double maxGapUs;
+    uint32_t nodes;
+    Move best;
+};
+
+static TranspositionTable table;
+
+static SliceRun runSliced(Search &search, const Position &position, uint8_t depth, const SliceConfig &config)
+{
+    search.setSliceNodes(config.nodes);
+    search.setSliceMicros(config.micros);
+    table.clear();
+
+    SliceRun run = {};
+    Clock::time_point start = Clock::now();
+    Clock::time_point lastScan = start;
+    double totalGap = 0;
+    search.startHint(position, 0xFFFFFFFF, depth);
+    while (search.pollHint() == HINT_THINKING)
+    {
+        // loop() would scan the sensors here
+        Clock::time_point now = Clock::now();
+        double gap = std::chrono::duration<double, std::micro>(now - lastScan).count();
+        totalGap += gap;
+        run.maxGapUs = std::max(run.maxGapUs, gap);
+        lastScan = now;
+        run.slices++;
+    }
+    Clock::time_point end = Clock::now();
+    double gap = std::chrono::duration<double, std::micro>(end - lastScan).count();
+    run.maxGapUs = std::max(run.maxGapUs, gap);
+    run.slices++;
+    run.meanGapUs = (totalGap + gap) / run.slices;
+    run.ms = std::chrono::duration<double, std::milli>(end - start).count();
+    run.nodes = search.getNodes();
+    run.best = search.bestMove();
+    return run;
+}
+
+int main(int argc, char **argv)
+{
+    uint8_t depth = argc > 1 ? atoi(argv[1]) : 5;
+    int runs = argc > 2 ? atoi(argv[2]) : 3;
+    Search search(table);
+    bool allExact = true;
+
+    printf("%-14s %6s %6s %8s %9s %8s %9s %10s %10s %s\n", "case", "nodes", "us", "slices", "ms", "cost us", "overhead",
+           "mean poll", "max poll", "exact");
+    for (const SliceCase &sliceCase : cases)
+    {
+        Position position;
+        position.setFromFen(sliceCase.fen);
+        SliceRun reference = {};
+        for (const SliceConfig &config : configs)
+        {
+            // Fastest of the runs: the others carry scheduler noise
+            SliceRun best = runSliced(search, position, depth, config);
+            for (int r = 1; r < runs; r++)
+            {
+                SliceRun run = runSliced(search, position, depth, config);
+                if (run.ms < best.ms)
+                    best = run;
+            }
+            if (config.nodes == 0 && config.micros == 0)
+                reference = best;
+
+            bool exact = best.nodes == reference.nodes && best.best == reference.best;
+            allExact = allExact && exact;
+            double extra = best.ms - reference.ms;
+            printf("%-14s %6u %6u %8d %9.2f %8.3f %8.1f%% %7.0f us %7.0f us %s\n", sliceCase.name, config.nodes,
+                   config.micros, best.slices, best.ms, best.slices > 1 ? extra * 1000 / (best.slices - 1) : 0.0,
+                   extra * 100 / reference.ms, best.meanGapUs, best.maxGapUs, exact ? "yes" : "NO");
+        }
+    }
+    printf("depth %u, search state (all frames) %zu bytes\n", depth, sizeof(Search));
+    return allExact ? 0 : 1;
+}
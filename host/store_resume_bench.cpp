@@ -0,0 +1,159 @@
+// Save/resume check and timing: random games are played with a GameStore
+// (backed by a file) attached, and after every ply a fresh board resumes
+// from the file, as after a power cut, and must match the live game.
+// After each game (and after a fool's mate and an opening) the board boots the way the
+// sketch's setup() does: an unfinished game carries on, a finished one gives
+// way to a new game, which the file must then hold.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++17 -Ihost -I. host/store_resume_bench.cpp *.cpp -o store_resume_bench
+// Usage:
+//   ./store_resume_bench [games=20] [file=smartchess_store.bin]
+
+#include "ChessBoard.h"
+#include "GameStore.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+static uint32_t rngState = 0x2545F491;
+static uint32_t nextRandom()
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+static Move randomLegalMove(const Position &p)
+{
+    Move moves[256];
+    int count = 0;
+    auto collect = [&](Move m)
+    {
+        if (!leavesKingInCheck(p.board, m, p.sideToMove))
+            moves[count++] = m;
+        return false;
+    };
+    generateMoves(p.board, p.sideToMove, p.castlingRights, p.epSquare, collect);
+    return count ? moves[nextRandom() % count] : NO_MOVE;
+}
+
+// What setup() does at power-on: carry on with the stored game only if it
+// is still being played
+static void boot(ChessBoard &board, GameStore &store)
+{
+    if (!board.resume(store) || board.getGameState() != GAME_ACTIVE)
+    {
+        board.attachStore(&store);
+        board.initializeStandardGame();
+    }
+}
+
+// Boots from the file after live's game: true if the board and the file
+// then hold the right game
+static bool checkBoot(const char *path, ChessBoard &live)
+{
+    ChessBoard fresh;
+    fresh.initializeStandardGame();
+    bool finished = live.getGameState() != GAME_ACTIVE;
+    HashKey expected = finished ? fresh.getPosition().key() : live.getPosition().key();
+
+    GameStore store;
+    store.openFile(path);
+    ChessBoard booted;
+    boot(booted, store);
+    if (booted.getPosition().key() != expected || booted.getGameState() != GAME_ACTIVE)
+        return false;
+
+    // The next boot must find the same game: a new one is in the file now
+    GameStore again;
+    again.openFile(path);
+    ChessBoard rebooted;
+    return rebooted.resume(again) && rebooted.getPosition().key() == expected &&
+           (!finished || again.moveCount() == 0);
+}
+
+int main(int argc, char **argv)
+{
+    int games = argc > 1 ? atoi(argv[1]) : 20;
+    const char *path = argc > 2 ? argv[2] : "smartchess_store.bin";
+    arduinoSerialMuted() = true;
+    remove(path);
+
+    GameStore store;
+    if (!store.openFile(path))
+    {
+        printf("cannot open %s\n", path);
+        return 1;
+    }
+    ChessBoard live;
+    live.attachStore(&store);
+
+    uint64_t checks = 0, mismatches = 0, plies = 0;
+    double totalSeconds = 0, worstSeconds = 0;
+    uint16_t longestLog = 0;
+    int boots = 0, finishedBoots = 0, bootMismatches = 0;
+    for (int g = 0; g < games; g++)
+    {
+        live.initializeStandardGame();
+        // Long enough for the log to wrap around the ring now and then
+        for (int ply = 0; ply < 600 && live.getGameState() == GAME_ACTIVE; ply++)
+        {
+            live.movePiece(randomLegalMove(live.getPosition()));
+            plies++;
+
+            GameStore reopened;
+            reopened.openFile(path);
+            ChessBoard resumed;
+            auto start = std::chrono::steady_clock::now();
+            bool ok = resumed.resume(reopened);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            totalSeconds += seconds;
+            worstSeconds = seconds > worstSeconds ? seconds : worstSeconds;
+            longestLog = reopened.moveCount() > longestLog ? reopened.moveCount() : longestLog;
+
+            checks++;
+            if (!ok || resumed.getPosition().key() != live.getPosition().key() ||
+                resumed.getGameState() != live.getGameState() ||
+                resumed.countMoveRepetitions() != live.countMoveRepetitions())
+                mismatches++;
+        }
+
+        boots++;
+        finishedBoots += live.getGameState() != GAME_ACTIVE;
+        if (!checkBoot(path, live))
+            bootMismatches++;
+    }
+
+    // A game surely over: fool's mate
+    live.initializeStandardGame();
+    live.movePiece(13, 21); // f3
+    live.movePiece(52, 36); // e5
+    live.movePiece(14, 30); // g4
+    live.movePiece(59, 31); // Qh4#
+    boots++;
+    finishedBoots += live.getGameState() != GAME_ACTIVE;
+    if (live.getGameState() != GAME_CHECKMATE_WHITE || !checkBoot(path, live))
+        bootMismatches++;
+
+    // And one surely not: 1. e4 e5
+    live.initializeStandardGame();
+    live.movePiece(12, 28);
+    live.movePiece(52, 36);
+    boots++;
+    if (live.getGameState() != GAME_ACTIVE || !checkBoot(path, live))
+        bootMismatches++;
+
+    printf("store size:       %d bytes, ring of %u moves, 4 bytes written per move\n",
+           GAME_STORE_BYTES, store.capacity());
+    printf("games, plies:     %d, %llu\n", games, (unsigned long long)plies);
+    printf("resumes checked:  %llu, mismatches %llu\n", (unsigned long long)checks, (unsigned long long)mismatches);
+    printf("longest log:      %u moves\n", longestLog);
+    printf("boots checked:    %d (%d after a finished game), mismatches %d\n", boots, finishedBoots, bootMismatches);
+    printf("resume time:      mean %.1f us, worst %.1f us (host, file reads included)\n",
+           totalSeconds / checks * 1e6, worstSeconds * 1e6);
+    remove(path);
+    return mismatches != 0 || bootMismatches != 0;
+}
@@ -0,0 +1,404 @@
+// Virtual smart board: the sketch itself (built with SMARTCHESS_SENSOR_BOARD)
+// runs its setup() and loop() against simulated hardware, and a player
+// plays recorded games on it, end to end:
+//
+//   player thread -> switches -> timer thread (scanRow(), the ISR) -> loop():
+//   MoveDetector -> movePiece() -> LEDs (emulated strip) and frames on the
+//   serial port -> ProtocolDecoder/GameMirror, as the companion app
+//
+// Each move's pieces are moved with contact bounce and the odd blip (a
+// piece nudged for less than the debounce time). The player waits for the
+// board to take each move, as a person watching the LEDs would. Every move
+// must come out on the serial port in order, with the LEDs showing the
+// position. Reports latency from the last hand movement to the move's
+// frame and LEDs being out, and the loop() rate.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++17 -DSMARTCHESS_SENSOR_BOARD -Ihost -I. host/virtual_board.cpp host/ProtocolDecoder.cpp *.cpp -o virtual_board -pthread
+// Usage:
+//   ./virtual_board [games=2] [hand ms=100] [max bounces=3] [blip chance per move=0.5] [games file]
+// A games file has one game per line, moves in coordinate notation
+// (e2e4 e7e5 g1f3 ... e7e8q); without one, random games are played.
+
+#include "Sah_Strgar_Oreskovic_Kovac.ino"
+#include "ProtocolDecoder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static uint32_t rngState = 0x2545F491;
+static uint32_t nextRandom()
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+static double seconds(Clock::time_point from, Clock::time_point to)
+{
+    return std::chrono::duration<double>(to - from).count();
+}
+
+static void sleepMs(double ms)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds((long)(ms * 1000)));
+}
+
+// Random games through a ChessBoard, so they end where the sketch's board
+// ends them. Queens only: the sensors can't tell promotions apart.
+static std::vector<Move> randomGame(int plies)
+{
+    std::vector<Move> game;
+    ChessBoard referee;
+    arduinoSerialMuted() = true;
+    referee.initializeStandardGame();
+    while ((int)game.size() < plies && referee.getGameState() == GAME_ACTIVE)
+    {
+        const Position &p = referee.getPosition();
+        Move moves[256];
+        int count = 0;
+        auto collect = [&](Move m)
+        {
+            if (!leavesKingInCheck(p.board, m, p.sideToMove) &&
+                (moveFlag(m) != MOVE_PROMOTION || movePromotion(m) == PROMOTE_QUEEN))
+                moves[count++] = m;
+            return false;
+        };
+        generateMoves(p.board, p.sideToMove, p.castlingRights, p.epSquare, collect);
+        Move m = moves[nextRandom() % count];
+        referee.movePiece(m);
+        game.push_back(referee.getLastMove());
+    }
+    arduinoSerialMuted() = false;
+    return game;
+}
+
+// One game per line in coordinate notation; stops a game at a move that
+// isn't legal
+static std::vector<std::vector<Move>> readGames(const char *path)
+{
+    std::vector<std::vector<Move>> games;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream words(line);
+        std::string word;
+        std::vector<Move> game;
+        Position p;
+        p.setStartPosition();
+        while (words >> word)
+        {
+            if (word.size() < 4)
+                break;
+            Square from = (word[1] - '1') * 8 + (word[0] - 'a');
+            Square to = (word[3] - '1') * 8 + (word[2] - 'a');
+            Move found = NO_MOVE;
+            auto match = [&](Move m)
+            {
+                if (moveFrom(m) == from && moveTo(m) == to &&
+                    (moveFlag(m) != MOVE_PROMOTION || movePromotion(m) == PROMOTE_QUEEN))
+                    found = m;
+                return found != NO_MOVE;
+            };
+            generateMoves(p.board, p.sideToMove, p.castlingRights, p.epSquare, match);
+            if (found == NO_MOVE || !p.isLegal(found))
+                break;
+            game.push_back(found);
+            p.makeMove(found);
+        }
+        if (!game.empty())
+            games.push_back(game);
+    }
+    return games;
+}
+
+// --- The hand ---
+
+static double handMs = 100;
+static int maxBounces = 3;
+static double blipsPerMove = 0.5;
+static uint64_t closed;
+static Clock::time_point lastTouch;
+static const double scanMs = 8 * SENSOR_ROW_MICROS / 1000.0;
+
+// Time to the next square; a real hand takes longer than the debounce
+static void reach()
+{
+    sleepMs(handMs * (0.5 + (nextRandom() % 1000) / 1000.0));
+}
+
+static void touch(Square sq, bool placed)
+{
+    reach();
+    int bounces = maxBounces ? nextRandom() % (maxBounces + 1) : 0;
+    for (int b = 0; b < bounces; b++)
+    {
+        sensors.setSwitches(closed ^ (1ULL << sq));
+        sleepMs(0.3);
+        sensors.setSwitches(closed);
+        sleepMs(0.3);
+    }
+    closed = placed ? closed | (1ULL << sq) : closed & ~(1ULL << sq);
+    sensors.setSwitches(closed);
+    lastTouch = Clock::now();
+}
+
+// Captured piece off first, castling king before rook
+static void playByHand(Position &p, Move m)
+{
+    Square from = moveFrom(m), to = moveTo(m);
+    if (moveFlag(m) == MOVE_EN_PASSANT)
+        touch(enPassantVictim(m), false);
+    else if (moveFlag(m) != MOVE_CASTLING && p.board.pieceAt(to) != NO_PIECE)
+        touch(to, false);
+    touch(from, false);
+    touch(to, true);
+    if (moveFlag(m) == MOVE_CASTLING)
+    {
+        bool kingSide = to > from;
+        Square rank = from & 0x38;
+        touch(rank + (kingSide ? 7 : 0), false);
+        touch(rank + (kingSide ? 5 : 3), true);
+    }
+    p.makeMove(m);
+}
+
+// A piece nudged off its switch for one scan: bounce, not a move
+static void blip()
+{
+    uint64_t pieces = closed;
+    int count = __builtin_popcountll(pieces);
+    int pick = nextRandom() % count;
+    for (Square sq = 0; sq < 64; sq++)
+    {
+        if ((pieces >> sq & 1) && pick-- == 0)
+        {
+            sensors.setSwitches(closed & ~(1ULL << sq));
+            sleepMs(scanMs);
+            sensors.setSwitches(closed);
+            return;
+        }
+    }
+}
+
+// --- The companion app, on the far end of the serial port ---
+
+static ProtocolDecoder decoder;
+static GameMirror mirror;
+static std::vector<Move> expected; // every game's moves, in order
+static std::atomic<int> movesOut(0), gamesOut(0);
+static int wrongMoves = 0;
+
+static void serialReceived(const uint8_t *data, size_t size)
+{
+    decoder.feed(data, size);
+    ProtocolFrame frame;
+    while (decoder.next(frame))
+    {
+        bool applied = mirror.apply(frame);
+        if (frame.type == MSG_POSITION)
+            gamesOut++;
+        if (frame.type == MSG_MOVE)
+        {
+            int index = movesOut.load();
+            Move m = (Move)(frame.payload[0] | (frame.payload[1] << 8));
+            if (!applied || index >= (int)expected.size() || m != expected[index])
+                wrongMoves++;
+            movesOut++;
+        }
+    }
+}
+
+static uint32_t paletteColor(const Position &p, Square sq)
+{
+    PieceCode piece = p.board.pieceAt(sq);
+    if (piece == NO_PIECE)
+        return LED_COLOR_EMPTY;
+    return pieceColor(piece) == WHITE ? LED_COLOR_WHITE : LED_COLOR_BLACK;
+}
+
+int main(int argc, char **argv)
+{
+    int gameCount = argc > 1 ? atoi(argv[1]) : 2;
+    handMs = argc > 2 ? atof(argv[2]) : 100;
+    maxBounces = argc > 3 ? atoi(argv[3]) : 3;
+    blipsPerMove = argc > 4 ? atof(argv[4]) : 0.5;
+
+    std::vector<std::vector<Move>> games;
+    if (argc > 5)
+    {
+        games = readGames(argv[5]);
+        if (games.size() > (size_t)gameCount)
+            games.resize(gameCount);
+    }
+    else
+    {
+        for (int g = 0; g < gameCount; g++)
+        {
+            games.push_back(randomGame(120));
+        }
+    }
+    std::vector<size_t> gameStart;
+    for (const std::vector<Move> &game : games)
+    {
+        gameStart.push_back(expected.size());
+        expected.insert(expected.end(), game.begin(), game.end());
+    }
+    // Written by the player and the main loop respectively, read after both are done
+    std::vector<Clock::time_point> handDone(expected.size()), movedOut(expected.size());
+
+    Position start;
+    start.setStartPosition();
+    closed = occupancyOf(start);
+    sensors.setSwitches(closed);
+    arduinoSerialTap() = serialReceived;
+    setup();
+
+    std::atomic<bool> running(true);
+    std::thread timer(
+        [&]()
+        {
+            Clock::time_point next = Clock::now();
+            while (running.load())
+            {
+                sensors.scanRow();
+                next += std::chrono::microseconds(SENSOR_ROW_MICROS);
+                std::this_thread::sleep_until(next);
+            }
+        });
+
+    std::atomic<bool> playing(true);
+    int timeouts = 0;
+    std::thread player(
+        [&]()
+        {
+            for (size_t g = 0; g < games.size(); g++)
+            {
+                // A new game: everything off, then set up
+                if (g > 0)
+                {
+                    for (Square sq = 0; sq < 64; sq++)
+                    {
+                        if (closed >> sq & 1)
+                            touch(sq, false);
+                    }
+                    int before = gamesOut.load();
+                    for (Square sq = 0; sq < 64; sq++)
+                    {
+                        if (start.board.pieceAt(sq) != NO_PIECE)
+                            touch(sq, true);
+                    }
+                    for (int wait = 0; wait < 300 && gamesOut.load() == before; wait++)
+                    {
+                        sleepMs(10);
+                    }
+                }
+
+                Position p = start;
+                for (size_t i = 0; i < games[g].size(); i++)
+                {
+                    size_t index = gameStart[g] + i;
+                    if (nextRandom() % 1000 < blipsPerMove * 1000)
+                        blip();
+                    playByHand(p, games[g][i]);
+                    handDone[index] = lastTouch;
+                    // Watch the board take it
+                    int wait = 0;
+                    for (; wait < 300 && movesOut.load() <= (int)index; wait++)
+                    {
+                        sleepMs(10);
+                    }
+                    if (wait == 300)
+                    {
+                        // Out of step from here on: stop
+                        printf("move %zu (game %zu, ply %zu) not taken\n", index, g + 1, i + 1);
+                        timeouts++;
+                        g = games.size();
+                        break;
+                    }
+                }
+            }
+            sleepMs(100);
+            playing = false;
+        });
+
+    uint64_t loops = 0, ledMismatches = 0;
+    double loopSeconds = 0, worstLoop = 0;
+    int seen = 0;
+    Clock::time_point started = Clock::now();
+    while (playing.load())
+    {
+        Clock::time_point before = Clock::now();
+        loop();
+        Clock::time_point after = Clock::now();
+        loops++;
+        loopSeconds += seconds(before, after);
+        worstLoop = std::max(worstLoop, seconds(before, after));
+
+        int out = movesOut.load();
+        if (out > seen)
+        {
+            // The frame and the LEDs are out: the move is through
+            for (; seen < out && seen < (int)movedOut.size(); seen++)
+            {
+                movedOut[seen] = after;
+            }
+            for (Square sq = 0; sq < 64; sq++)
+            {
+                if (leds.stripSquare(sq) != paletteColor(board.getPosition(), sq))
+                {
+                    ledMismatches++;
+                    break;
+                }
+            }
+        }
+    }
+    double wall = seconds(started, Clock::now());
+    player.join();
+    running = false;
+    timer.join();
+    arduinoSerialTap() = nullptr;
+
+    std::vector<double> latencies;
+    for (int i = 0; i < seen; i++)
+    {
+        latencies.push_back(seconds(handDone[i], movedOut[i]) * 1000);
+    }
+    std::sort(latencies.begin(), latencies.end());
+    double mean = 0;
+    for (double ms : latencies)
+    {
+        mean += ms;
+    }
+    mean = latencies.empty() ? 0 : mean / latencies.size();
+    auto percentile = [&](double q)
+    { return latencies.empty() ? 0.0 : latencies[std::min(latencies.size() - 1, (size_t)(q * latencies.size()))]; };
+
+    bool passed = movesOut.load() == (int)expected.size() && !wrongMoves && !timeouts && !ledMismatches;
+    printf("%zu games, %zu moves: %d out on the serial port, %d wrong, %d timed out%s\n", games.size(),
+           expected.size(), movesOut.load(), wrongMoves, timeouts, passed ? "" : "  FAILED");
+    printf("hand %.0f ms per piece, up to %d bounces, %.2f blip chance per move; debounce %.0f ms\n", handMs, maxBounces,
+           blipsPerMove, 4 * scanMs);
+    printf("hand -> frame and LEDs out: mean %.1f ms, median %.1f, p95 %.1f, max %.1f\n", mean, percentile(0.5),
+           percentile(0.95), latencies.empty() ? 0.0 : latencies.back());
+    printf("loop(): %.0f passes/s, mean %.2f us, worst %.0f us (host)\n", loops / wall, loopSeconds * 1e6 / loops,
+           worstLoop * 1e6);
+    printf("serial: %llu frames, %llu text bytes between them, %llu frames lost; LEDs: %.0f us on the wire per "
+           "move, %llu times not matching the position\n",
+           (unsigned long long)decoder.getFrames(), (unsigned long long)decoder.getSkippedBytes(),
+           (unsigned long long)decoder.getMissedFrames(),
+           expected.empty() ? 0.0 : (double)leds.wireMicros() / expected.size(), (unsigned long long)ledMismatches);
+    return passed ? 0 : 1;
+}